@@ -0,0 +1,439 @@
+// generates large sgcll programs and times sgcllc on them, reporting lines/s, tokens/s and time and memory per phase
+// gcc -O2 -o bench/compile_speed bench/compile_speed.c, then from the root of the repo:
+//     bench/compile_speed [--sgcllc=command] [--runs=N] [small|medium|large ...]
+//     bench/compile_speed --generate [--functions=N] [--blueprints=N] [--overloads=N] [--depth=N] [--cases=N] [--seed=N] > file.sgcll
+// the generated code is only meant to be compiled, it goes through every kind of token, statement and operator sgcllc knows
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+    char* name;
+    int functions;
+    int blueprints;
+    int overloads;
+    int depth;
+    int cases;
+    unsigned long long seed;
+} shape_t;
+
+static shape_t presets[] = {
+    { "small", 50, 5, 5, 4, 16, 1 },
+    { "medium", 500, 20, 20, 6, 64, 2 },
+    { "large", 4000, 50, 50, 8, 256, 3 },
+};
+
+static char* phase_names[] = { "other", "lex", "parse", "import", "header", "emit", "assemble", "link" };
+
+#define PHASE_COUNT (sizeof(phase_names) / sizeof(char*))
+
+static FILE* out;
+static long lines;
+static unsigned long long state;
+
+static unsigned int next_random(void)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (unsigned int) (state >> 32);
+}
+
+static void put(char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(out, format, args);
+    va_end(args);
+    for (char* c = format; *c; c++)
+        lines += *c == '\n';
+}
+
+static char* int_leaves[] = { "x", "k", "12", "0x17", "0b1011", "0o17", "7L", "3s", "9B", "(y -> i64)", "#s", "arr[k & 7]", "p.a" };
+// no % on integers, importing math brings in operator(%) for f64 and that gets picked for i64 operands too
+static char* int_binary[] = { "+", "-", "*", "/", "&", "|", "^", "<<", ">>", ">>>" };
+static char* compare_binary[] = { "<", "<=", ">", ">=", "==", "!=" };
+static char* float_leaves[] = { "y", "z", "1.5", "0.25", "2.5f", "(x -> f64)", "p.b", "m[1][k & 3]" };
+static char* float_binary[] = { "+", "-", "*", "/", "%" };
+
+// every int expression has type i64 or narrower, so it can go anywhere an i64 can
+static void int_expr(int depth);
+
+// sgcllc computes the right operand first and holds it in one of its 9 temporary registers while it computes the left one,
+// it can't spill yet, so left operands turn into leaves once this many values are held
+#define MAX_HELD 6
+static int held;
+
+static void lhs_expr(void (*expr)(int), int depth, int holding)
+{
+    held += holding;
+    expr(held < MAX_HELD ? depth : 0);
+    held -= holding;
+}
+
+static void float_expr(int depth)
+{
+    if (depth <= 0)
+    {
+        put("%s", float_leaves[next_random() % (sizeof(float_leaves) / sizeof(char*))]);
+        return;
+    }
+    switch (next_random() % 6)
+    {
+        case 0:
+            put("math::sin(");
+            float_expr(depth - 1);
+            put(")");
+            break;
+        case 1:
+            put("-(");
+            float_expr(depth - 1);
+            put(")");
+            break;
+        case 2:
+            put("((");
+            int_expr(depth - 1);
+            put(") -> f64)");
+            break;
+        default:
+            put("(");
+            lhs_expr(float_expr, depth - 1, 1);
+            put(" %s ", float_binary[next_random() % (sizeof(float_binary) / sizeof(char*))]);
+            float_expr(depth - 1);
+            put(")");
+    }
+}
+
+static void int_expr(int depth)
+{
+    if (depth <= 0)
+    {
+        put("%s", int_leaves[next_random() % (sizeof(int_leaves) / sizeof(char*))]);
+        return;
+    }
+    switch (next_random() % 10)
+    {
+        case 0:
+            put("(");
+            lhs_expr(int_expr, depth - 1, 1);
+            put(" %s ", compare_binary[next_random() % (sizeof(compare_binary) / sizeof(char*))]);
+            int_expr(depth - 1);
+            put(" ? ");
+            int_expr(depth - 1);
+            put(" : ");
+            int_expr(depth - 1);
+            put(")");
+            break;
+        case 1:
+            put("~(");
+            int_expr(depth - 1);
+            put(")");
+            break;
+        case 2:
+            put("-(");
+            int_expr(depth - 1);
+            put(")");
+            break;
+        case 3:
+            put("((");
+            float_expr(depth - 1);
+            put(") -> i64)");
+            break;
+        case 4:
+            put("(");
+            lhs_expr(int_expr, depth - 1, 1);
+            put(" <=> ");
+            int_expr(depth - 1);
+            put(")");
+            break;
+        case 5:
+            put("(!(");
+            lhs_expr(int_expr, depth - 1, 4);
+            put(" > 3L && k < 9L || x == 2L) ? 1L : 0L)");
+            break;
+        default:
+            put("(");
+            lhs_expr(int_expr, depth - 1, 1);
+            put(" %s ", int_binary[next_random() % (sizeof(int_binary) / sizeof(char*))]);
+            int_expr(depth - 1);
+            put(")");
+    }
+}
+
+static void generate_blueprint(int index)
+{
+    put("blueprint bp%i\n{\n", index);
+    put("    public i64 a;\n    public f64 b;\n    public string s;\n\n");
+    put("    public constructor(i64 a, f64 b)\n    {\n        this.a = a;\n        this.b = b;\n        this.s = \"bp%i\";\n    }\n\n", index);
+    put("    public i64 mix(i64 x)\n    {\n        this.a ^= x << 3;\n        this.b *= 0.5;\n        return this.a + #this.s;\n    }\n}\n\n");
+}
+
+static char* overload_ops[] = { "+", "-", "*", "==" };
+static char* overload_names[] = { "add", "sub", "mul", "eq" };
+
+#define OVERLOAD_OPS (sizeof(overload_ops) / sizeof(char*))
+
+static void generate_overload(int index, int blueprints)
+{
+    int bp = index % blueprints, op = (index / blueprints) % OVERLOAD_OPS;
+    if (!strcmp(overload_ops[op], "=="))
+        put("public operator(==) bool eq(bp%i l, bp%i r)\n{\n    return l.a == r.a && l.b == r.b;\n}\n\n", bp, bp);
+    else
+        put("public operator(%s) bp%i %s(bp%i l, bp%i r)\n{\n    return bp%i(l.a %s r.a, l.b %s r.b);\n}\n\n",
+            overload_ops[op], bp, overload_names[op], bp, bp, bp, overload_ops[op], overload_ops[op]);
+}
+
+static void generate_switch(int cases)
+{
+    put("    switch (k & %i)\n    {\n", cases - 1);
+    for (int i = 0; i < cases; i++)
+    {
+        if (i % 5 == 4)
+        {
+            put("        case %i:\n        {\n            x -= %i;\n            z += %i.5;\n        }\n", i, i, i);
+            continue;
+        }
+        if (i % 7 == 6)
+            put("        case %i:\n", i++);
+        put("        case %i:\n            x += %i;\n", i, i * 3 + 1);
+    }
+    put("        default:\n            x = 0L;\n    }\n");
+}
+
+static void generate_function(int index, shape_t* shape)
+{
+    int bp = index % shape->blueprints;
+    put("// function %i\n", index);
+    put("i64 fn%i(i64 x, f64 y)\n{\n", index);
+    put("    i64 k = %iL;\n", index & 15);
+    put("    f64 z = y * %i.0;\n", index % 10);
+    put("    let w = z;\n");
+    put("    string s = \"fn%i\\t\\\"\\\\\" + x;\n", index);
+    put("    i64[] arr = make i64[8];\n");
+    put("    f64[][] m = make f64[4][4];\n");
+    put("    bp%i p = bp%i(x, y);\n", bp, bp);
+    put("    /* deep expressions */\n");
+    put("    i64 e = ");
+    int_expr(shape->depth);
+    put(";\n");
+    put("    z = ");
+    float_expr(shape->depth);
+    put(";\n");
+    switch (index % 4)
+    {
+        case 0:
+            put("    for (i64 i = 0L; i < 8L; ++i)\n    {\n        arr[i] = i * x;\n        if (i != 3L)\n            k += arr[i] >> 1;\n    }\n");
+            break;
+        case 1:
+            put("    while (k < 100L)\n    {\n        k <<= 1;\n        k |= 1L;\n        if (k > 50L)\n            k += 100L;\n        k--;\n    }\n");
+            break;
+        case 2:
+            put("    if (x < 0L)\n        x = -x;\n    elif (x == 0L)\n        x++;\n    else\n    {\n        x %%= 7L;\n        x >>= 1;\n        x >>>= 1;\n    }\n");
+            break;
+        case 3:
+            put("    bp%i q = p + bp%i(k, z);\n    if (q == p)\n        k &= 3L;\n    k += q.mix(e);\n", bp, bp);
+            break;
+    }
+    if (shape->cases && index % 8 == 0)
+        generate_switch(shape->cases);
+    put("    m[k & 3][1] = z / 3.0;\n");
+    put("    k += string::find(s, 'n') + string::find(s, \"fn\");\n");
+    put("    k -= total(e, k, 3L);\n");
+    put("    z -= w;\n");
+    put("    x -= ~k;\n");
+    put("    x /= 3L;\n");
+    put("    x *= 5L;\n");
+    put("    x += k > 3L ? e : e ^ 0x99L;\n");
+    if (index)
+        put("    x += fn%i(k, z);\n", index - 1);
+    put("    delete arr;\n");
+    put("    return x + e + p.a;\n}\n\n");
+}
+
+static long generate(shape_t* shape, FILE* file)
+{
+    out = file;
+    lines = 0;
+    state = 0x9E3779B97F4A7C15ULL ^ shape->seed;
+    put("import \"io\";\nimport \"string\";\nimport \"math\";\n\n");
+    put("// %i functions, %i blueprints, %i operator overloads, expressions %i deep, switches with %i cases\n\n",
+        shape->functions, shape->blueprints, shape->overloads, shape->depth, shape->cases);
+    for (int i = 0; i < shape->blueprints; i++)
+        generate_blueprint(i);
+    for (int i = 0; i < shape->overloads; i++)
+        generate_overload(i, shape->blueprints);
+    put("i64 total(i64 a, i64 b, i64 c)\n{\n    i64 sum = a;\n    for (i32 i = 0; i < 3; i++)\n        sum += i > 1 ? b : c;\n    return sum;\n}\n\n");
+    put("unsafe(48) i32 raw()\n{\n    i32 i = 0;\n    asm \"movl $5, -4(%%rbp)\";\n    return i;\n}\n\n");
+    for (int i = 0; i < shape->functions; i++)
+        generate_function(i, shape);
+    put("i32 main()\n{\n");
+    put("    io::println(fn%i(3L, 1.5));\n", shape->functions - 1);
+    put("    io::println(raw() -> i64);\n");
+    put("    return 0;\n}\n");
+    return lines;
+}
+
+static int option(char* arg, char* name, int* value)
+{
+    size_t length = strlen(name);
+    if (strncmp(arg, name, length) || arg[length] != '=')
+        return 0;
+    *value = atoi(arg + length + 1);
+    return 1;
+}
+
+typedef struct
+{
+    long long tokens;
+    long long peak_kb;
+    double total_ms;
+    double wall_ms[PHASE_COUNT];
+    long long peak_growth_kb[PHASE_COUNT];
+} report_t;
+
+// picks the numbers out of the line sgcllc --time-report=json writes
+static int parse_report(char* text, report_t* report)
+{
+    char* json = strstr(text, "{\"files\"");
+    if (!json)
+        return 0;
+    char* at;
+    if (!(at = strstr(json, "\"tokens\": ")) || sscanf(at, "\"tokens\": %lld", &report->tokens) != 1)
+        return 0;
+    if (!(at = strstr(json, "\"peak_kb\": ")) || sscanf(at, "\"peak_kb\": %lld", &report->peak_kb) != 1)
+        return 0;
+    if (!(at = strstr(json, "\"total\": ")) || sscanf(at, "\"total\": {\"wall_ms\": %lf", &report->total_ms) != 1)
+        return 0;
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        char key[32];
+        snprintf(key, sizeof(key), "\"%s\": {", phase_names[i]);
+        if (!(at = strstr(json, key)) ||
+            sscanf(at + strlen(key), "\"wall_ms\": %lf, \"cpu_ms\": %*f, \"peak_growth_kb\": %lld", &report->wall_ms[i], &report->peak_growth_kb[i]) != 2)
+            return 0;
+    }
+    return 1;
+}
+
+// the assembler and linker write to the same stream, so the report isn't necessarily the only thing in there
+static int read_report(char* path, report_t* report)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return 0;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = malloc(length + 1);
+    length = fread(text, 1, length, file);
+    fclose(file);
+    text[length] = '\0';
+    int ok = parse_report(text, report);
+    free(text);
+    return ok;
+}
+
+static int compare_reports(const void* a, const void* b)
+{
+    double x = ((const report_t*) a)->total_ms, y = ((const report_t*) b)->total_ms;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char** argv)
+{
+    shape_t custom = { "custom", 100, 10, 10, 5, 32, 1 };
+    int generate_only = 0, runs = 3, seed = 1;
+    char* sgcllc = "sgcllc";
+    char** names = calloc(argc, sizeof(char*));
+    int count = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--generate"))
+            generate_only = 1;
+        else if (!strncmp(argv[i], "--sgcllc=", 9))
+            sgcllc = argv[i] + 9;
+        else if (!option(argv[i], "--runs", &runs) &&
+            !option(argv[i], "--functions", &custom.functions) &&
+            !option(argv[i], "--blueprints", &custom.blueprints) &&
+            !option(argv[i], "--overloads", &custom.overloads) &&
+            !option(argv[i], "--depth", &custom.depth) &&
+            !option(argv[i], "--cases", &custom.cases) &&
+            !option(argv[i], "--seed", &seed))
+            names[count++] = argv[i];
+    }
+    custom.seed = seed;
+    // cases are picked with k & (cases - 1)
+    if (custom.functions < 1 || custom.blueprints < 1 || custom.depth < 0 || runs < 1 || (custom.cases & (custom.cases - 1)) ||
+        custom.overloads > custom.blueprints * (int) OVERLOAD_OPS)
+    {
+        fprintf(stderr, "compile_speed: needs at least 1 function, 1 blueprint and 1 run, cases has to be 0 or a power of 2 "
+            "and there can be %i overloads per blueprint\n", (int) OVERLOAD_OPS);
+        return EXIT_FAILURE;
+    }
+    if (generate_only)
+    {
+        generate(&custom, stdout);
+        return EXIT_SUCCESS;
+    }
+    int preset_count = sizeof(presets) / sizeof(shape_t);
+    if (!count)
+    {
+        for (int i = 0; i < preset_count; i++)
+            names[count++] = presets[i].name;
+    }
+    report_t* reports = calloc(runs, sizeof(report_t));
+    int failures = 0;
+    for (int i = 0; i < count; i++)
+    {
+        shape_t* shape = NULL;
+        for (int j = 0; j < preset_count; j++)
+        {
+            if (!strcmp(names[i], presets[j].name))
+                shape = &presets[j];
+        }
+        if (!shape)
+        {
+            fprintf(stderr, "compile_speed: no size called '%s', try small, medium or large\n", names[i]);
+            failures++;
+            continue;
+        }
+        char source[256], json[256], command[1024];
+        snprintf(source, sizeof(source), "bench/gen_%s.sgcll", shape->name);
+        snprintf(json, sizeof(json), "bench/gen_%s.json", shape->name);
+        snprintf(command, sizeof(command), "%s --time-report=json %s 2> %s", sgcllc, source, json);
+        FILE* file = fopen(source, "wb");
+        if (!file)
+        {
+            fprintf(stderr, "compile_speed: could not write '%s'\n", source);
+            return EXIT_FAILURE;
+        }
+        long source_lines = generate(shape, file);
+        fclose(file);
+        int ok = 1;
+        for (int run = 0; run < runs && ok; run++)
+        {
+            system(command);
+            ok = read_report(json, &reports[run]);
+        }
+        if (!ok)
+        {
+            printf("%s: sgcllc did not produce a time report, see %s\n", shape->name, json);
+            failures++;
+            continue;
+        }
+        qsort(reports, runs, sizeof(report_t), compare_reports);
+        report_t* median = &reports[runs / 2];
+        printf("%s: %li lines, %lli tokens in %.1f ms (median of %i), %.0f lines/s, %.0f tokens/s, peak %lli kb\n",
+            shape->name, source_lines, median->tokens, median->total_ms, runs,
+            source_lines / (median->total_ms / 1000), median->tokens / (median->total_ms / 1000), median->peak_kb);
+        printf("    %-10s %12s %18s\n", "phase", "wall (ms)", "peak growth (kb)");
+        for (int j = 0; j < PHASE_COUNT; j++)
+            printf("    %-10s %12.1f %18lli\n", phase_names[j], median->wall_ms[j], median->peak_growth_kb[j]);
+    }
+    free(reports);
+    free(names);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+// checks __libsgcllc_itos/__libsgcllc_ftos against the host libc and times them against snprintf
+// gcc -O2 -o format_sweep format_sweep.c ../libsgcllc/grisu.c ../libsgcllc/string.c ../libsgcllc/memory.c ../libsgcllc/simd.c ../libsgcllc/kernel.c ../libsgcllc/io.c
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// libsgcllc.h redefines stdout and friends, so only the prototypes are pulled in here
+int __libsgcllc_itos(long long n, char* buffer, unsigned long long radix);
+int __libsgcllc_ftos(double d, char* buffer);
+int __libsgcllc_ftos32(float f, char* buffer);
+
+static unsigned long long state = 0x9E3779B97F4A7C15ULL;
+
+static unsigned long long next_random(void)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// length of the shortest %.*g output that still reads back as d
+static int shortest_length(double d, int single)
+{
+    char buffer[64];
+    for (int precision = 1; precision <= 17; precision++)
+    {
+        snprintf(buffer, sizeof(buffer), "%.*g", precision, d);
+        if (single ? strtof(buffer, NULL) == (float) d : strtod(buffer, NULL) == d)
+            break;
+    }
+    int digits = 0;
+    for (char* c = buffer; *c && *c != 'e'; c++)
+        digits += *c >= '0' && *c <= '9';
+    return digits;
+}
+
+static int significant_digits(char* buffer)
+{
+    int digits = 0, leading = 1;
+    for (char* c = buffer; *c && *c != 'e'; c++)
+    {
+        if (*c < '0' || *c > '9')
+            continue;
+        if (*c == '0' && leading)
+            continue;
+        leading = 0;
+        digits++;
+    }
+    char* end = strchr(buffer, 'e');
+    if (!strchr(buffer, '.'))
+    {
+        // trailing zeros of integers aren't significant
+        for (char* c = (end ? end : buffer + strlen(buffer)) - 1; c >= buffer && *c == '0' && digits > 1; c--)
+            digits--;
+    }
+    return digits ? digits : 1;
+}
+
+int main(int argc, char** argv)
+{
+    long count = argc > 1 ? atol(argv[1]) : 1000000;
+    long failures = 0, longer = 0;
+    char ours[64], theirs[64];
+    for (long i = 0; i < count; i++)
+    {
+        long long n = (long long) next_random() >> (next_random() & 63);
+        __libsgcllc_itos(n, ours, 10);
+        snprintf(theirs, sizeof(theirs), "%lld", n);
+        if (strcmp(ours, theirs))
+        {
+            if (failures++ < 10)
+                printf("itos %s != %s\n", ours, theirs);
+        }
+
+        unsigned long long bits = next_random();
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        if (d != d || d - d != 0.0)
+            continue;
+        __libsgcllc_ftos(d, ours);
+        if (strtod(ours, NULL) != d)
+        {
+            if (failures++ < 10)
+                printf("ftos %s does not read back as %.17g\n", ours, d);
+        }
+        else if (significant_digits(ours) > shortest_length(d, 0))
+            longer++;
+
+        unsigned int fbits = (unsigned int) bits;
+        float f;
+        memcpy(&f, &fbits, sizeof(f));
+        if (f != f || f - f != 0.0f)
+            continue;
+        __libsgcllc_ftos32(f, ours);
+        if (strtof(ours, NULL) != f)
+        {
+            if (failures++ < 10)
+                printf("ftos32 %s does not read back as %.9g\n", ours, f);
+        }
+        else if (significant_digits(ours) > shortest_length(f, 1))
+            longer++;
+    }
+    printf("%ld values, %ld failures, %ld not shortest\n", count, failures, longer);
+
+    double values[1024];
+    for (int i = 0; i < 1024; i++)
+    {
+        unsigned long long bits = next_random() & ~(0x7FFULL << 52) | ((unsigned long long) (1023 + (int) (next_random() % 64) - 32) << 52);
+        memcpy(&values[i], &bits, sizeof(double));
+    }
+    size_t sink = 0;
+    clock_t start = clock();
+    for (int round = 0; round < 1000; round++)
+        for (int i = 0; i < 1024; i++)
+            sink += __libsgcllc_ftos(values[i], ours);
+    double grisu = (double) (clock() - start) / CLOCKS_PER_SEC;
+    start = clock();
+    for (int round = 0; round < 1000; round++)
+        for (int i = 0; i < 1024; i++)
+            sink += snprintf(theirs, sizeof(theirs), "%.17g", values[i]);
+    double libc = (double) (clock() - start) / CLOCKS_PER_SEC;
+    start = clock();
+    for (int round = 0; round < 1000; round++)
+        for (int i = 0; i < 1024; i++)
+            sink += __libsgcllc_itos((long long) values[i] * 1000, ours, 10);
+    double itos = (double) (clock() - start) / CLOCKS_PER_SEC;
+    start = clock();
+    for (int round = 0; round < 1000; round++)
+        for (int i = 0; i < 1024; i++)
+            sink += snprintf(theirs, sizeof(theirs), "%lld", (long long) values[i] * 1000);
+    double lld = (double) (clock() - start) / CLOCKS_PER_SEC;
+    printf("ftos %.3fs, %%.17g %.3fs, itos %.3fs, %%lld %.3fs (%zu)\n", grisu, libc, itos, lld, sink);
+    return failures != 0;
+}
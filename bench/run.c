@@ -0,0 +1,247 @@
+// compiles every benchmark with sgcllc, runs each a few times and reports the median wall time, peak memory and binary size,
+// checking the output against name.expected along the way
+// gcc -O2 -o bench/run bench/run.c (add -lpsapi on old mingw), then from the root of the repo:
+//     bench/run [--runs=N] [--sgcllc=command] [name ...]
+// the runtime's "[builtin debug]" lines are skipped when comparing, build libsgcllc with -D__libsgcllc_QUIET to not time them
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+static char* benches[] = { "nbody", "strings", "alloc", "matmul", "interp", "recursion", "concat", "format", "println", "soa", "aos", "saxpy", "dot", "parallel_sum", "parallel_matmul" };
+
+#define DEBUG_PREFIX "[builtin debug]"
+
+static double wall_now(void)
+{
+    #ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double) counter.QuadPart / frequency.QuadPart;
+    #else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+    #endif
+}
+
+// runs exe once with its stdout going to output, returns the exit status or -1 if it couldn't be started
+static int run_once(char* exe, char* output, double* wall, long long* peak_kb)
+{
+    #ifdef _WIN32
+    SECURITY_ATTRIBUTES sa = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+    HANDLE out = CreateFileA(output, GENERIC_WRITE, FILE_SHARE_READ, &sa, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (out == INVALID_HANDLE_VALUE)
+        return -1;
+    STARTUPINFOA si = { 0 };
+    si.cb = sizeof(STARTUPINFOA);
+    si.dwFlags = STARTF_USESTDHANDLES;
+    si.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+    si.hStdOutput = out;
+    si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+    PROCESS_INFORMATION pi;
+    double start = wall_now();
+    if (!CreateProcessA(exe, NULL, NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi))
+    {
+        CloseHandle(out);
+        return -1;
+    }
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    *wall = wall_now() - start;
+    PROCESS_MEMORY_COUNTERS pmc;
+    *peak_kb = GetProcessMemoryInfo(pi.hProcess, &pmc, sizeof(pmc)) ? (long long) (pmc.PeakWorkingSetSize / 1024) : 0;
+    DWORD status = 0;
+    GetExitCodeProcess(pi.hProcess, &status);
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+    CloseHandle(out);
+    return (int) status;
+    #else
+    double start = wall_now();
+    pid_t pid = fork();
+    if (pid < 0)
+        return -1;
+    if (!pid)
+    {
+        int fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            _exit(127);
+        dup2(fd, STDOUT_FILENO);
+        close(fd);
+        execl(exe, exe, (char*) NULL);
+        _exit(127);
+    }
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0)
+        return -1;
+    *wall = wall_now() - start;
+    *peak_kb = usage.ru_maxrss;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    #endif
+}
+
+static char* read_file(char* path, long* length)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* data = malloc(*length + 1);
+    *length = fread(data, 1, *length, file);
+    data[*length] = '\0';
+    fclose(file);
+    return data;
+}
+
+// drops the runtime's debug lines in place
+static long strip_debug(char* data, long length)
+{
+    long kept = 0;
+    for (long i = 0; i < length;)
+    {
+        char* newline = memchr(data + i, '\n', length - i);
+        long end = newline ? newline - data + 1 : length;
+        if (strncmp(data + i, DEBUG_PREFIX, strlen(DEBUG_PREFIX)))
+        {
+            memmove(data + kept, data + i, end - i);
+            kept += end - i;
+        }
+        i = end;
+    }
+    data[kept] = '\0';
+    return kept;
+}
+
+// fnv-1a, same as the string hash
+static unsigned long long hash_bytes(char* data, long length)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for (long i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char) data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// an expected file is either the whole output, or "fnv1a <hash> <length>" for benchmarks that print megabytes
+static char* check_output(char* output_path, char* expected_path)
+{
+    long expected_length, length;
+    char* expected = read_file(expected_path, &expected_length);
+    if (!expected)
+        return "no reference";
+    char* output = read_file(output_path, &length);
+    if (!output)
+    {
+        free(expected);
+        return "no output";
+    }
+    length = strip_debug(output, length);
+    unsigned long long hash;
+    long hashed_length;
+    int ok;
+    if (sscanf(expected, "fnv1a %llx %ld", &hash, &hashed_length) == 2)
+        ok = hashed_length == length && hash == hash_bytes(output, length);
+    else
+        ok = expected_length == length && !memcmp(expected, output, length);
+    free(expected);
+    free(output);
+    return ok ? "ok" : "WRONG OUTPUT";
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char** argv)
+{
+    int runs = 5;
+    char* sgcllc = "sgcllc";
+    int bench_count = sizeof(benches) / sizeof(char*);
+    char** names = calloc(argc + bench_count, sizeof(char*));
+    int count = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strncmp(argv[i], "--runs=", 7))
+            runs = atoi(argv[i] + 7);
+        else if (!strncmp(argv[i], "--sgcllc=", 9))
+            sgcllc = argv[i] + 9;
+        else
+            names[count++] = argv[i];
+    }
+    if (runs < 1)
+    {
+        fprintf(stderr, "run: --runs needs at least 1\n");
+        return EXIT_FAILURE;
+    }
+    if (!count)
+    {
+        count = bench_count;
+        for (int i = 0; i < count; i++)
+            names[i] = benches[i];
+    }
+    double* walls = calloc(runs, sizeof(double));
+    int failures = 0;
+    printf("%-10s %12s %12s %12s %12s  %s\n", "bench", "median (ms)", "min (ms)", "peak (kb)", "size (kb)", "output");
+    for (int i = 0; i < count; i++)
+    {
+        char* name = names[i];
+        char command[1024], exe[512], output[512], expected[512];
+        snprintf(command, sizeof(command), "%s bench/%s.sgcll", sgcllc, name);
+        snprintf(exe, sizeof(exe), "bench/%s.exe", name);
+        snprintf(output, sizeof(output), "bench/%s.out", name);
+        snprintf(expected, sizeof(expected), "bench/%s.expected", name);
+        remove("a.exe");
+        struct stat st;
+        if (system(command) || stat("a.exe", &st))
+        {
+            printf("%-10s did not compile\n", name);
+            failures++;
+            continue;
+        }
+        remove(exe);
+        rename("a.exe", exe);
+        long long peak_kb = 0;
+        int status = 0;
+        for (int run = 0; run < runs && !status; run++)
+        {
+            long long run_peak_kb = 0;
+            status = run_once(exe, output, &walls[run], &run_peak_kb);
+            if (run_peak_kb > peak_kb)
+                peak_kb = run_peak_kb;
+        }
+        if (status)
+        {
+            printf("%-10s exited with %i\n", name, status);
+            failures++;
+            continue;
+        }
+        qsort(walls, runs, sizeof(double), compare_doubles);
+        char* verdict = check_output(output, expected);
+        if (strcmp(verdict, "ok"))
+            failures++;
+        printf("%-10s %12.1f %12.1f %12lli %12lli  %s\n", name, walls[runs / 2] * 1000, walls[0] * 1000, peak_kb, (long long) st.st_size / 1024, verdict);
+    }
+    free(walls);
+    free(names);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
\ No newline at end of file
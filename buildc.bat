@@ -1 +1 @@
-gcc sgcllc/*.c -o sgcllc.exe
\ No newline at end of file
+gcc sgcllc/*.c -o sgcllc.exe -lpthread -lpsapi
\ No newline at end of file
@@ -3,5 +3,9 @@ gcc -c -o io.o io.c
 gcc -c -o kernel.o kernel.c
 gcc -c -o memory.o memory.c
 gcc -c -o string.o string.c
-ar rcs libsgcllc.a io.o kernel.o memory.o string.o
+gcc -c -o simd.o simd.c
+gcc -c -o grisu.o grisu.c
+gcc -c -o thread.o thread.c
+gcc -c -o pool.o pool.c
+ar rcs libsgcllc.a io.o kernel.o memory.o string.o simd.o grisu.o thread.o pool.o
 cd ..
\ No newline at end of file
@@ -7,4 +7,7 @@ sgcllc libsgcll/string.sgcll
 gcc -o libsgcll/math_lowlvl.o -c libsgcll/math.c
 sgcllc libsgcll/math.sgcll
 
-ar rcs libsgcll/libsgcll.a libsgcll/io.o libsgcll/io_lowlvl.o libsgcll/string.o libsgcll/string_lowlvl.o libsgcll/math.o libsgcll/math_lowlvl.o
\ No newline at end of file
+gcc -o libsgcll/thread_lowlvl.o -c libsgcll/thread.c
+sgcllc libsgcll/thread.sgcll
+
+ar rcs libsgcll/libsgcll.a libsgcll/io.o libsgcll/io_lowlvl.o libsgcll/string.o libsgcll/string_lowlvl.o libsgcll/math.o libsgcll/math_lowlvl.o libsgcll/thread.o libsgcll/thread_lowlvl.o
\ No newline at end of file
@@ -2,7 +2,20 @@
 
 void io_g_println_string(char* str)
 {
-    __libsgcllc_fprintf(__libsgcllc_stdstream(stdout), "%s\n", str);
+    void* out = __libsgcllc_stdstream(stdout);
+    __libsgcllc_lock_stream(out); // the line stays in one piece
+    __libsgcllc_fwrite(out, str, string_header(str)->length);
+    __libsgcllc_fputchar(out, '\n');
+    __libsgcllc_unlock_stream(out);
+}
+
+void io_g_println_slice$i8(char* str, sz_t length)
+{
+    void* out = __libsgcllc_stdstream(stdout);
+    __libsgcllc_lock_stream(out);
+    __libsgcllc_fwrite(out, str, length);
+    __libsgcllc_fputchar(out, '\n');
+    __libsgcllc_unlock_stream(out);
 }
 
 void io_g_println_i64(long long i)
@@ -13,4 +26,14 @@ void io_g_println_i64(long long i)
 void io_g_println_f64(double d)
 {
     __libsgcllc_fprintf(__libsgcllc_stdstream(stdout), "%d\n", d);
-}
\ No newline at end of file
+}
+
+void io_g_flush()
+{
+    __libsgcllc_fflush(__libsgcllc_stdstream(stdout));
+}
+
+void io_g_flush_all()
+{
+    __libsgcllc_flush_all();
+}
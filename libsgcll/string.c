@@ -1,27 +1,124 @@
 #include "../libsgcllc/libsgcllc.h"
 
-char* string_g_concat_string_string(char* lhs, char* rhs)
+static char* string_concat_bytes(char* lhs, sz_t lhs_length, char* rhs, sz_t rhs_length)
 {
-    int lhs_length = __libsgcllc_string_length(lhs),
-        rhs_length = __libsgcllc_string_length(rhs),
-        length = lhs_length + rhs_length + 1;
-    char* new = __libsgcllc_alloc_bytes(length);
+    char* new = __libsgcllc_alloc_string(lhs_length + rhs_length);
     __libsgcllc_copy_memory(new, lhs, lhs_length);
     __libsgcllc_copy_memory(new + lhs_length, rhs, rhs_length);
-    new[lhs_length + rhs_length] = '\0';
     return new;
 }
 
+char* string_g_concat_string_string(char* lhs, char* rhs)
+{
+    return string_concat_bytes(lhs, string_header(lhs)->length, rhs, string_header(rhs)->length);
+}
+
 char* string_g_concat_string_i64(char* lhs, long long rhs)
 {
     char buffer[34];
-    __libsgcllc_itos(rhs, buffer, 10);
-    return string_g_concat_string_string(lhs, buffer);
+    int length = __libsgcllc_itos(rhs, buffer, 10);
+    return string_concat_bytes(lhs, string_header(lhs)->length, buffer, length);
 }
 
 char* string_g_concat_i64_string(long long lhs, char* rhs)
 {
     char buffer[34];
-    __libsgcllc_itos(lhs, buffer, 10);
-    return string_g_concat_string_string(buffer, rhs);
+    int length = __libsgcllc_itos(lhs, buffer, 10);
+    return string_concat_bytes(buffer, length, rhs, string_header(rhs)->length);
+}
+
+char string_g_is_equal_string_string(char* lhs, char* rhs)
+{
+    string_header_t* lheader = string_header(lhs), * rheader = string_header(rhs);
+    if (lheader->length != rheader->length)
+        return 0;
+    if (lheader->hash && rheader->hash && lheader->hash != rheader->hash)
+        return 0;
+    return !__libsgcllc_compare_memory(lhs, rhs, lheader->length);
+}
+
+char string_g_is_equal_slice$i8_slice$i8(char* lhs, sz_t lhs_length, char* rhs, sz_t rhs_length)
+{
+    return lhs_length == rhs_length && !__libsgcllc_compare_memory(lhs, rhs, lhs_length);
+}
+
+long long string_g_hash_string(char* str)
+{
+    return __libsgcllc_string_hash(str);
+}
+
+long long string_g_hash_slice$i8(char* str, sz_t length)
+{
+    return __libsgcllc_hash_bytes(str, length);
+}
+
+long long string_g_find_string_string(char* haystack, char* needle)
+{
+    return __libsgcllc_find_substring(haystack, string_header(haystack)->length, needle, string_header(needle)->length);
+}
+
+long long string_g_find_string_i8(char* str, char c)
+{
+    return __libsgcllc_find_char(str, string_header(str)->length, c);
+}
+
+long long string_g_find_slice$i8_slice$i8(char* haystack, sz_t haystack_length, char* needle, sz_t needle_length)
+{
+    return __libsgcllc_find_substring(haystack, haystack_length, needle, needle_length);
+}
+
+long long string_g_find_slice$i8_i8(char* str, sz_t length, char c)
+{
+    return __libsgcllc_find_char(str, length, c);
+}
+
+char* string_g_copy_slice$i8(char* str, sz_t length)
+{
+    return string_concat_bytes(str, length, "", 0);
+}
+
+// the string a builder appends to, which is the only thing in it
+typedef struct
+{
+    char* text;
+} builder_t;
+
+char* string_g_reserve_i64(long long capacity)
+{
+    char* str = __libsgcllc_alloc_string(capacity);
+    string_header(str)->length = 0;
+    *str = '\0';
+    return str;
+}
+
+void string_g_append_builder_string(builder_t* builder, char* str)
+{
+    builder->text = __libsgcllc_append_string(builder->text, str, string_header(str)->length);
+}
+
+void string_g_append_builder_i64(builder_t* builder, long long i)
+{
+    char buffer[34];
+    int length = __libsgcllc_itos(i, buffer, 10);
+    builder->text = __libsgcllc_append_string(builder->text, buffer, length);
+}
+
+void string_g_append_builder_i8(builder_t* builder, char c)
+{
+    builder->text = __libsgcllc_append_string(builder->text, &c, 1);
+}
+
+void string_g_append_builder_slice$i8(builder_t* builder, char* str, sz_t length)
+{
+    builder->text = __libsgcllc_append_string(builder->text, str, length);
+}
+
+long long string_g_length_builder(builder_t* builder)
+{
+    return string_header(builder->text)->length;
+}
+
+char* string_g_to_string_builder(builder_t* builder)
+{
+    return __libsgcllc_make_string(builder->text, string_header(builder->text)->length);
 }
\ No newline at end of file
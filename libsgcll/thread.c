@@ -0,0 +1,87 @@
+#include "../libsgcllc/libsgcllc.h"
+
+long long thread_g_join_i64(long long thread)
+{
+    return __libsgcllc_thread_join(thread);
+}
+
+long long thread_g_cores()
+{
+    return __libsgcllc_core_count();
+}
+
+long long thread_g_mutex()
+{
+    return __libsgcllc_mutex();
+}
+
+void thread_g_lock_i64(long long mutex)
+{
+    __libsgcllc_mutex_lock(mutex);
+}
+
+void thread_g_unlock_i64(long long mutex)
+{
+    __libsgcllc_mutex_unlock(mutex);
+}
+
+long long thread_g_condition()
+{
+    return __libsgcllc_condition();
+}
+
+void thread_g_wait_i64_i64(long long condition, long long mutex)
+{
+    __libsgcllc_condition_wait(condition, mutex);
+}
+
+void thread_g_signal_i64(long long condition)
+{
+    __libsgcllc_condition_signal(condition);
+}
+
+void thread_g_broadcast_i64(long long condition)
+{
+    __libsgcllc_condition_broadcast(condition);
+}
+
+// the atomics are all sequentially consistent, the compiler can't reorder anything around them either
+int thread_g_load_i32$$1_i64(int* a, long long i)
+{
+    return __atomic_load_n(a + i, __ATOMIC_SEQ_CST);
+}
+
+long long thread_g_load_i64$$1_i64(long long* a, long long i)
+{
+    return __atomic_load_n(a + i, __ATOMIC_SEQ_CST);
+}
+
+void thread_g_store_i32$$1_i64_i32(int* a, long long i, int x)
+{
+    __atomic_store_n(a + i, x, __ATOMIC_SEQ_CST);
+}
+
+void thread_g_store_i64$$1_i64_i64(long long* a, long long i, long long x)
+{
+    __atomic_store_n(a + i, x, __ATOMIC_SEQ_CST);
+}
+
+char thread_g_cas_i32$$1_i64_i32_i32(int* a, long long i, int expected, int desired)
+{
+    return __atomic_compare_exchange_n(a + i, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+char thread_g_cas_i64$$1_i64_i64_i64(long long* a, long long i, long long expected, long long desired)
+{
+    return __atomic_compare_exchange_n(a + i, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+int thread_g_fetch_add_i32$$1_i64_i32(int* a, long long i, int delta)
+{
+    return __atomic_fetch_add(a + i, delta, __ATOMIC_SEQ_CST);
+}
+
+long long thread_g_fetch_add_i64$$1_i64_i64(long long* a, long long i, long long delta)
+{
+    return __atomic_fetch_add(a + i, delta, __ATOMIC_SEQ_CST);
+}
\ No newline at end of file
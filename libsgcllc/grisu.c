@@ -0,0 +1,237 @@
+#include "libsgcllc.h"
+
+// grisu2 (florian loitsch, "printing floating-point numbers quickly and accurately with integers").
+// prints the shortest digits that read back to the same value, almost always the shortest there is
+
+typedef struct diy_fp_t
+{
+    unsigned long long f;
+    int e;
+} diy_fp_t;
+
+// 10^-348, 10^-340, ..., 10^340 as normalized diy_fp_t's
+static const diy_fp_t cached_powers[] = {
+    { 0xFA8FD5A0081C0288ULL, -1220 }, { 0xBAAEE17FA23EBF76ULL, -1193 }, { 0x8B16FB203055AC76ULL, -1166 },
+    { 0xCF42894A5DCE35EAULL, -1140 }, { 0x9A6BB0AA55653B2DULL, -1113 }, { 0xE61ACF033D1A45DFULL, -1087 },
+    { 0xAB70FE17C79AC6CAULL, -1060 }, { 0xFF77B1FCBEBCDC4FULL, -1034 }, { 0xBE5691EF416BD60CULL, -1007 },
+    { 0x8DD01FAD907FFC3CULL, -980 }, { 0xD3515C2831559A83ULL, -954 }, { 0x9D71AC8FADA6C9B5ULL, -927 },
+    { 0xEA9C227723EE8BCBULL, -901 }, { 0xAECC49914078536DULL, -874 }, { 0x823C12795DB6CE57ULL, -847 },
+    { 0xC21094364DFB5637ULL, -821 }, { 0x9096EA6F3848984FULL, -794 }, { 0xD77485CB25823AC7ULL, -768 },
+    { 0xA086CFCD97BF97F4ULL, -741 }, { 0xEF340A98172AACE5ULL, -715 }, { 0xB23867FB2A35B28EULL, -688 },
+    { 0x84C8D4DFD2C63F3BULL, -661 }, { 0xC5DD44271AD3CDBAULL, -635 }, { 0x936B9FCEBB25C996ULL, -608 },
+    { 0xDBAC6C247D62A584ULL, -582 }, { 0xA3AB66580D5FDAF6ULL, -555 }, { 0xF3E2F893DEC3F126ULL, -529 },
+    { 0xB5B5ADA8AAFF80B8ULL, -502 }, { 0x87625F056C7C4A8BULL, -475 }, { 0xC9BCFF6034C13053ULL, -449 },
+    { 0x964E858C91BA2655ULL, -422 }, { 0xDFF9772470297EBDULL, -396 }, { 0xA6DFBD9FB8E5B88FULL, -369 },
+    { 0xF8A95FCF88747D94ULL, -343 }, { 0xB94470938FA89BCFULL, -316 }, { 0x8A08F0F8BF0F156BULL, -289 },
+    { 0xCDB02555653131B6ULL, -263 }, { 0x993FE2C6D07B7FACULL, -236 }, { 0xE45C10C42A2B3B06ULL, -210 },
+    { 0xAA242499697392D3ULL, -183 }, { 0xFD87B5F28300CA0EULL, -157 }, { 0xBCE5086492111AEBULL, -130 },
+    { 0x8CBCCC096F5088CCULL, -103 }, { 0xD1B71758E219652CULL, -77 }, { 0x9C40000000000000ULL, -50 },
+    { 0xE8D4A51000000000ULL, -24 }, { 0xAD78EBC5AC620000ULL, 3 }, { 0x813F3978F8940984ULL, 30 },
+    { 0xC097CE7BC90715B3ULL, 56 }, { 0x8F7E32CE7BEA5C70ULL, 83 }, { 0xD5D238A4ABE98068ULL, 109 },
+    { 0x9F4F2726179A2245ULL, 136 }, { 0xED63A231D4C4FB27ULL, 162 }, { 0xB0DE65388CC8ADA8ULL, 189 },
+    { 0x83C7088E1AAB65DBULL, 216 }, { 0xC45D1DF942711D9AULL, 242 }, { 0x924D692CA61BE758ULL, 269 },
+    { 0xDA01EE641A708DEAULL, 295 }, { 0xA26DA3999AEF774AULL, 322 }, { 0xF209787BB47D6B85ULL, 348 },
+    { 0xB454E4A179DD1877ULL, 375 }, { 0x865B86925B9BC5C2ULL, 402 }, { 0xC83553C5C8965D3DULL, 428 },
+    { 0x952AB45CFA97A0B3ULL, 455 }, { 0xDE469FBD99A05FE3ULL, 481 }, { 0xA59BC234DB398C25ULL, 508 },
+    { 0xF6C69A72A3989F5CULL, 534 }, { 0xB7DCBF5354E9BECEULL, 561 }, { 0x88FCF317F22241E2ULL, 588 },
+    { 0xCC20CE9BD35C78A5ULL, 614 }, { 0x98165AF37B2153DFULL, 641 }, { 0xE2A0B5DC971F303AULL, 667 },
+    { 0xA8D9D1535CE3B396ULL, 694 }, { 0xFB9B7CD9A4A7443CULL, 720 }, { 0xBB764C4CA7A44410ULL, 747 },
+    { 0x8BAB8EEFB6409C1AULL, 774 }, { 0xD01FEF10A657842CULL, 800 }, { 0x9B10A4E5E9913129ULL, 827 },
+    { 0xE7109BFBA19C0C9DULL, 853 }, { 0xAC2820D9623BF429ULL, 880 }, { 0x80444B5E7AA7CF85ULL, 907 },
+    { 0xBF21E44003ACDD2DULL, 933 }, { 0x8E679C2F5E44FF8FULL, 960 }, { 0xD433179D9C8CB841ULL, 986 },
+    { 0x9E19DB92B4E31BA9ULL, 1013 }, { 0xEB96BF6EBADF77D9ULL, 1039 }, { 0xAF87023B9BF0EE6BULL, 1066 }
+};
+
+static const unsigned int grisu_pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+static diy_fp_t diy_fp_multiply(diy_fp_t x, diy_fp_t y)
+{
+    unsigned __int128 product = (unsigned __int128) x.f * y.f;
+    unsigned long long high = product >> 64;
+    if ((unsigned long long) product & (1ULL << 63)) // round
+        high++;
+    return (diy_fp_t) { high, x.e + y.e + 64 };
+}
+
+static diy_fp_t diy_fp_normalize(diy_fp_t x)
+{
+    int shift = __builtin_clzll(x.f);
+    return (diy_fp_t) { x.f << shift, x.e - shift };
+}
+
+// the halfway points to the neighbouring values, anything between them reads back as v
+static void grisu_boundaries(diy_fp_t v, unsigned long long hidden, diy_fp_t* minus, diy_fp_t* plus)
+{
+    diy_fp_t pl = diy_fp_normalize((diy_fp_t) { (v.f << 1) + 1, v.e - 1 });
+    diy_fp_t mi = v.f == hidden ? (diy_fp_t) { (v.f << 2) - 1, v.e - 2 } : (diy_fp_t) { (v.f << 1) - 1, v.e - 1 };
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+    *minus = mi;
+    *plus = pl;
+}
+
+// picks 10^-K so that the binary exponent of the product lands in [-60, -32]
+static diy_fp_t grisu_cached_power(int e, int* K)
+{
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = (int) dk;
+    if (dk - k > 0.0)
+        k++;
+    int index = (k >> 3) + 1;
+    *K = -(-348 + (index << 3));
+    return cached_powers[index];
+}
+
+// nudges the last digit towards w while staying inside the boundaries
+static void grisu_round(char* buffer, int length, unsigned long long delta, unsigned long long rest,
+    unsigned long long ten_kappa, unsigned long long wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+        (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+        buffer[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static int grisu_digit_gen(diy_fp_t w, diy_fp_t mp, unsigned long long delta, char* buffer, int* K)
+{
+    diy_fp_t one = { 1ULL << -mp.e, mp.e };
+    unsigned long long wp_w = mp.f - w.f;
+    unsigned int p1 = mp.f >> -one.e;
+    unsigned long long p2 = mp.f & (one.f - 1);
+    int length = 0, kappa = 1;
+    while (kappa < 10 && p1 >= grisu_pow10[kappa])
+        kappa++;
+    while (kappa > 0)
+    {
+        unsigned int d = p1 / grisu_pow10[kappa - 1];
+        p1 %= grisu_pow10[kappa - 1];
+        if (d || length)
+            buffer[length++] = '0' + d;
+        kappa--;
+        unsigned long long rest = ((unsigned long long) p1 << -one.e) + p2;
+        if (rest <= delta)
+        {
+            *K += kappa;
+            grisu_round(buffer, length, delta, rest, (unsigned long long) grisu_pow10[kappa] << -one.e, wp_w);
+            return length;
+        }
+    }
+    for (unsigned long long unit = 1;;)
+    {
+        p2 *= 10;
+        delta *= 10;
+        unit *= 10;
+        char d = p2 >> -one.e;
+        if (d || length)
+            buffer[length++] = '0' + d;
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta)
+        {
+            *K += kappa;
+            grisu_round(buffer, length, delta, p2, one.f, wp_w * unit);
+            return length;
+        }
+    }
+}
+
+static int grisu2(diy_fp_t v, unsigned long long hidden, char* buffer, int* K)
+{
+    diy_fp_t minus, plus;
+    grisu_boundaries(v, hidden, &minus, &plus);
+    diy_fp_t c_mk = grisu_cached_power(plus.e, K);
+    diy_fp_t w = diy_fp_multiply(diy_fp_normalize(v), c_mk);
+    diy_fp_t wp = diy_fp_multiply(plus, c_mk);
+    diy_fp_t wm = diy_fp_multiply(minus, c_mk);
+    wm.f++;
+    wp.f--;
+    return grisu_digit_gen(w, wp, wp.f - wm.f, buffer, K);
+}
+
+// turns the digits (value = digits * 10^k) into 123, 1.23, 0.00123 or 1.23e-7
+static int grisu_prettify(char* buffer, int length, int k)
+{
+    int kk = length + k; // position of the decimal point
+    if (k >= 0 && kk <= 21)
+    {
+        for (int i = length; i < kk; i++)
+            buffer[i] = '0';
+        return kk;
+    }
+    if (kk > 0 && kk <= 21)
+    {
+        for (int i = length; i > kk; i--)
+            buffer[i] = buffer[i - 1];
+        buffer[kk] = '.';
+        return length + 1;
+    }
+    if (kk > -6 && kk <= 0)
+    {
+        int offset = 2 - kk;
+        for (int i = length - 1; i >= 0; i--)
+            buffer[i + offset] = buffer[i];
+        buffer[0] = '0';
+        buffer[1] = '.';
+        for (int i = 2; i < offset; i++)
+            buffer[i] = '0';
+        return length + offset;
+    }
+    if (length > 1)
+    {
+        for (int i = length; i > 1; i--)
+            buffer[i] = buffer[i - 1];
+        buffer[1] = '.';
+        length++;
+    }
+    buffer[length++] = 'e';
+    return length + __libsgcllc_itos(kk - 1, buffer + length, 10);
+}
+
+static int grisu_format(char* buffer, BOOL negative, BOOL special, BOOL zero, diy_fp_t v, unsigned long long hidden)
+{
+    char* start = buffer;
+    if (special)
+    {
+        char* text = v.f ? "NaN" : negative ? "-infinity" : "infinity";
+        int length = 0;
+        for (; text[length]; length++)
+            buffer[length] = text[length];
+        buffer[length] = '\0';
+        return length;
+    }
+    if (negative)
+        *buffer++ = '-';
+    int length = 1;
+    if (zero)
+        *buffer = '0';
+    else
+    {
+        int K;
+        length = grisu2(v, hidden, buffer, &K);
+        length = grisu_prettify(buffer, length, K);
+    }
+    buffer[length] = '\0';
+    return buffer - start + length;
+}
+
+int __libsgcllc_ftos(double d, char* buffer)
+{
+    union { double d; unsigned long long u; } bits = { d };
+    unsigned long long mantissa = bits.u & ((1ULL << 52) - 1);
+    int exponent = (bits.u >> 52) & 0x7FF;
+    diy_fp_t v = exponent ? (diy_fp_t) { mantissa | (1ULL << 52), exponent - 1075 } : (diy_fp_t) { mantissa, -1074 };
+    return grisu_format(buffer, bits.u >> 63, exponent == 0x7FF, !exponent && !mantissa,
+        exponent == 0x7FF ? (diy_fp_t) { mantissa, 0 } : v, 1ULL << 52);
+}
+
+int __libsgcllc_ftos32(float f, char* buffer)
+{
+    union { float f; unsigned int u; } bits = { f };
+    unsigned long long mantissa = bits.u & ((1U << 23) - 1);
+    int exponent = (bits.u >> 23) & 0xFF;
+    diy_fp_t v = exponent ? (diy_fp_t) { mantissa | (1ULL << 23), exponent - 150 } : (diy_fp_t) { mantissa, -149 };
+    return grisu_format(buffer, bits.u >> 31, exponent == 0xFF, !exponent && !mantissa,
+        exponent == 0xFF ? (diy_fp_t) { mantissa, 0 } : v, 1ULL << 23);
+}
\ No newline at end of file
@@ -2,37 +2,137 @@
 
 #include "libsgcllc.h"
 
-#define POSITIVE_INFINITY 1.0 / 0.0
-#define NEGATIVE_INFINITY -1.0 / 0.0
-#define NAN 0.0 / 0.0
+// one buffer per standard stream, indexed by -descriptor - 10 (stdin, stdout, stderr)
+static stream_buffer_t streams[STREAM_COUNT];
+// held while a stream's buffer changes, and across whole lines by the things printing them, see __libsgcllc_lock_stream
+static CRITICAL_SECTION stream_locks[STREAM_COUNT];
+
+void __libsgcllc_init_streams()
+{
+    for (int i = 0; i < STREAM_COUNT; i++)
+        InitializeCriticalSection(&stream_locks[i]);
+}
+
+// keeps other threads from writing to file in between, it can be locked again by the thread that holds it
+void __libsgcllc_lock_stream(void* file)
+{
+    if (!__libsgcllc_threaded)
+        return;
+    for (int i = 0; i < STREAM_COUNT; i++)
+    {
+        if (streams[i].handle == file)
+        {
+            EnterCriticalSection(&stream_locks[i]);
+            return;
+        }
+    }
+}
+
+void __libsgcllc_unlock_stream(void* file)
+{
+    if (!__libsgcllc_threaded)
+        return;
+    for (int i = 0; i < STREAM_COUNT; i++)
+    {
+        if (streams[i].handle == file)
+        {
+            LeaveCriticalSection(&stream_locks[i]);
+            return;
+        }
+    }
+}
+
+static stream_buffer_t* __libsgcllc_stream_buffer(void* file)
+{
+    for (int i = 0; i < STREAM_COUNT; i++)
+    {
+        if (streams[i].handle == file && streams[i].mode != STREAM_UNBUFFERED)
+            return &streams[i];
+    }
+    return NULL;
+}
+
+static void __libsgcllc_write_direct(void* file, char* data, sz_t count)
+{
+    DWORD written;
+    while (count)
+    {
+        if (!WriteFile(file, data, (DWORD) count, &written, NULL) || !written)
+            return;
+        data += written;
+        count -= written;
+    }
+}
+
+void __libsgcllc_fflush(void* file)
+{
+    stream_buffer_t* stream = __libsgcllc_stream_buffer(file);
+    if (!stream)
+        return;
+    __libsgcllc_lock_stream(file);
+    if (stream->size)
+        __libsgcllc_write_direct(stream->handle, stream->data, stream->size);
+    stream->size = 0;
+    __libsgcllc_unlock_stream(file);
+}
+
+void __libsgcllc_flush_all()
+{
+    for (int i = 0; i < STREAM_COUNT; i++)
+    {
+        if (streams[i].handle)
+            __libsgcllc_fflush(streams[i].handle);
+    }
+}
+
+void __libsgcllc_fwrite(void* file, char* data, sz_t count)
+{
+    stream_buffer_t* stream = __libsgcllc_stream_buffer(file);
+    if (!stream)
+    {
+        __libsgcllc_write_direct(file, data, count);
+        return;
+    }
+    __libsgcllc_lock_stream(file);
+    if (stream->size + count > STREAM_BUFFER_SIZE)
+    {
+        __libsgcllc_fflush(file);
+        if (count >= STREAM_BUFFER_SIZE) // would not fit anyway, skip the copy
+        {
+            __libsgcllc_write_direct(file, data, count);
+            __libsgcllc_unlock_stream(file);
+            return;
+        }
+    }
+    BOOL newline = 0;
+    for (char* dst = stream->data + stream->size; count--; stream->size++)
+    {
+        if ((*dst++ = *data++) == '\n')
+            newline = 1;
+    }
+    if (newline && stream->mode == STREAM_LINE_BUFFERED)
+        __libsgcllc_fflush(file);
+    __libsgcllc_unlock_stream(file);
+}
 
 void __libsgcllc_fputchar(void* file, char c)
 {
-    WriteFile(file, &c, 1, 0, NULL);
+    __libsgcllc_fwrite(file, &c, 1);
 }
 
 void __libsgcllc_fputs(void* file, char* str)
 {
-    WriteFile(file, str, __libsgcllc_string_length(str), 0, NULL);
+    __libsgcllc_fwrite(file, str, __libsgcllc_string_length(str));
 }
 
 void __libsgcllc_fprintf(void* file, char* fmt, ...)
 {
     unsigned long long* args = variadic(fmt);
     char miscbuffer[100];
-    #define fp_case(type, arg) \
+    __libsgcllc_lock_stream(file);
+    #define fp_case(type, arg, ftos) \
         type arg = *((type*) (args + i++)); \
-        if (arg == POSITIVE_INFINITY) \
-            __libsgcllc_fputs(file, "infinity"); \
-        else if (arg == NEGATIVE_INFINITY) \
-            __libsgcllc_fputs(file, "-infinity"); \
-        else if (arg == NAN) \
-            __libsgcllc_fputs(file, "NaN"); \
-        else \
-        { \
-            __libsgcllc_ftos(arg, miscbuffer, 30); \
-            __libsgcllc_fputs(file, miscbuffer); \
-        }
+        __libsgcllc_fwrite(file, miscbuffer, ftos(arg, miscbuffer));
     for (int i = 0; *fmt; ++fmt)
     {
         if (*fmt == '%')
@@ -43,21 +143,19 @@ void __libsgcllc_fprintf(void* file, char* fmt, ...)
                     __libsgcllc_fputs(file, (char*) args[i++]);
                     break;
                 case 'i':
-                    __libsgcllc_itos((int) args[i++], miscbuffer, 10);
-                    __libsgcllc_fputs(file, miscbuffer);
+                    __libsgcllc_fwrite(file, miscbuffer, __libsgcllc_itos((int) args[i++], miscbuffer, 10));
                     break;
                 case 'l':
-                    __libsgcllc_itos((long long) args[i++], miscbuffer, 10);
-                    __libsgcllc_fputs(file, miscbuffer);
+                    __libsgcllc_fwrite(file, miscbuffer, __libsgcllc_itos((long long) args[i++], miscbuffer, 10));
                     break;
                 case 'c':
                     __libsgcllc_fputchar(file, (char) args[i++]);
                     break;
                 case 'f':
-                    fp_case(float, arg0);
+                    fp_case(float, arg0, __libsgcllc_ftos32);
                     break;
                 case 'd':
-                    fp_case(double, arg1);
+                    fp_case(double, arg1, __libsgcllc_ftos);
                     break;
                 case 'p':
                     __libsgcllc_itos((uintptr_t) args[i++], miscbuffer, 16);
@@ -70,11 +168,31 @@ void __libsgcllc_fprintf(void* file, char* fmt, ...)
             }
             continue;
         }
-        __libsgcllc_fputchar(file, *fmt);
+        // hand runs of plain characters to the buffer in one go
+        char* run = fmt;
+        while (fmt[1] && fmt[1] != '%')
+            fmt++;
+        __libsgcllc_fwrite(file, run, fmt - run + 1);
     }
+    __libsgcllc_unlock_stream(file);
 }
 
 void* __libsgcllc_stdstream(int descriptor)
 {
-    return GetStdHandle((DWORD) descriptor);
-}
\ No newline at end of file
+    void* handle = GetStdHandle((DWORD) descriptor);
+    stream_buffer_t* stream = &streams[-descriptor - 10];
+    if (stream->handle != handle)
+    {
+        __libsgcllc_fflush(stream->handle);
+        stream->handle = handle;
+        stream->size = 0;
+        // stderr stays unbuffered, terminals flush per line, files and pipes fill the whole buffer
+        if (descriptor == stderr)
+            stream->mode = STREAM_UNBUFFERED;
+        else if (GetFileType(handle) == FILE_TYPE_CHAR)
+            stream->mode = STREAM_LINE_BUFFERED;
+        else
+            stream->mode = STREAM_FULLY_BUFFERED;
+    }
+    return handle;
+}
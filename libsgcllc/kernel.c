@@ -2,28 +2,93 @@
 
 #include "libsgcllc.h"
 
-gc_node_t* gc_root = NULL;
+gc_heap_t* gc_heaps = NULL;
+static SRWLOCK gc_heaps_lock = SRWLOCK_INIT;
 
 void __libsgcllc_init()
+{
+    __libsgcllc_init_thread();
+    __libsgcllc_init_streams();
+    __libsgcllc_simd_select();
+}
+
+// threads don't inherit the rounding mode, each one sets it up when it starts
+void __libsgcllc_init_thread()
 {
     _mm_setcsr((_mm_getcsr() & 0xF3FF) | 0x6000); // set rounding mode
 }
 
+// a thread's first allocation takes a heap left behind by a finished thread, or makes a new one
+gc_heap_t* __libsgcllc_gc_take_heap()
+{
+    AcquireSRWLockExclusive(&gc_heaps_lock);
+    gc_heap_t* heap = gc_heaps;
+    while (heap && heap->taken)
+        heap = heap->next;
+    if (!heap)
+    {
+        heap = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(gc_heap_t));
+        InitializeSRWLock((SRWLOCK*) &heap->lock);
+        heap->next = gc_heaps;
+        gc_heaps = heap;
+    }
+    heap->taken = 1;
+    ReleaseSRWLockExclusive(&gc_heaps_lock);
+    return heap;
+}
+
+// what the heap tracks stays tracked until finalizing, only the heap itself is up for grabs again
+void __libsgcllc_gc_release_heap(gc_heap_t* heap)
+{
+    AcquireSRWLockExclusive(&gc_heaps_lock);
+    heap->taken = 0;
+    ReleaseSRWLockExclusive(&gc_heaps_lock);
+}
+
+// every other thread should be joined by now
 void __libsgcllc_gc_finalize()
 {
-    for (gc_node_t* node = gc_root; node;)
+    for (gc_heap_t* heap = gc_heaps; heap;)
     {
-        gc_node_t* next = node->next;
-        void* mem = node->mem;
-        BOOL result = __libsgcllc_delete_bytes_no_gc(node->mem);
-        __libsgcllc_delete_bytes_no_gc(node);
-        #ifdef __libsgcllc_DEBUG
-        if (result)
-            __libsgcllc_fprintf(__libsgcllc_stdstream(stdout), "[builtin debug] deallocated memory at 0x");
-        else
-            __libsgcllc_fprintf(__libsgcllc_stdstream(stdout), "[builtin debug] failed to deallocate memory at 0x");
-        __libsgcllc_fprintf(__libsgcllc_stdstream(stdout), "%p\n", mem);
-        #endif
-        node = next;
+        for (gc_node_t* node = heap->root; node; node = node->next)
+        {
+            void* mem = node->mem;
+            BOOL result = __libsgcllc_delete_bytes_no_gc(node->mem);
+            #ifdef __libsgcllc_DEBUG
+            if (result)
+                __libsgcllc_fprintf(__libsgcllc_stdstream(stdout), "[builtin debug] deallocated memory at 0x");
+            else
+                __libsgcllc_fprintf(__libsgcllc_stdstream(stdout), "[builtin debug] failed to deallocate memory at 0x");
+            __libsgcllc_fprintf(__libsgcllc_stdstream(stdout), "%p\n", mem);
+            #endif
+        }
+        for (gc_buffer_t* buffer = heap->buffer; buffer;)
+        {
+            gc_buffer_t* next = buffer->next;
+            HeapFree(GetProcessHeap(), 0, buffer);
+            buffer = next;
+        }
+        gc_heap_t* next = heap->next;
+        HeapFree(GetProcessHeap(), 0, heap);
+        heap = next;
     }
+    gc_heaps = NULL;
+    __libsgcllc_flush_all();
+}
+
+// compiled in by --bounds-check, neither returns
+void __libsgcllc_bounds_fail(long long index, long long length)
+{
+    __libsgcllc_fflush(__libsgcllc_stdstream(stdout)); // what was printed before comes first
+    __libsgcllc_fprintf(__libsgcllc_stdstream(stderr), "index %l out of bounds for length %l\n", index, length);
+    __libsgcllc_flush_all();
+    ExitProcess(1);
+}
+
+void __libsgcllc_slice_fail(long long lo, long long hi, long long length)
+{
+    __libsgcllc_fflush(__libsgcllc_stdstream(stdout));
+    __libsgcllc_fprintf(__libsgcllc_stdstream(stderr), "slice [%l:%l] out of bounds for length %l\n", lo, hi, length);
+    __libsgcllc_flush_all();
+    ExitProcess(1);
 }
\ No newline at end of file
@@ -5,31 +5,118 @@ typedef unsigned long long sz_t;
 typedef unsigned long long uintptr_t;
 typedef int BOOL;
 
+// -D__libsgcllc_QUIET leaves out the deallocation messages, for timing things
+#ifndef __libsgcllc_QUIET
 #define __libsgcllc_DEBUG
+#endif
 
 #define stdin -10
 #define stdout -11
 #define stderr -12
 
+#define STREAM_COUNT 3
+#define STREAM_BUFFER_SIZE 4096
+
+#define STREAM_UNBUFFERED 0
+#define STREAM_LINE_BUFFERED 1
+#define STREAM_FULLY_BUFFERED 2
+
 #define abs(x) ((x) < 0 ? -(x) : (x))
 #define fmod(x, y) (x - y * (int) (x / y))
 #define variadic(arg) (unsigned long long*) (&(arg)) + 1
+#define string_header(str) ((string_header_t*) (str) - 1)
     
+#define GC_BUFFER_NODES 256
+
+#define POOL_DEQUE_RANGES 64
+#define POOL_CHUNKS_PER_WORKER 8
+
 typedef struct gc_node_t
 {
     struct gc_node_t* next;
     void* mem;
 } gc_node_t;
 
+// the nodes of a heap's list are carved out of these, so tracking an allocation doesn't take one of its own
+typedef struct gc_buffer_t
+{
+    struct gc_buffer_t* next;
+    sz_t used;
+    gc_node_t nodes[GC_BUFFER_NODES];
+} gc_buffer_t;
+
+// every thread tracks what it allocates in a heap of its own, a heap outlives its thread until the next one takes it
+typedef struct gc_heap_t
+{
+    struct gc_heap_t* next;
+    void* lock; // an SRWLOCK, only contended by other threads deleting what this heap tracks
+    BOOL taken;
+    gc_node_t* root;
+    gc_node_t* free; // nodes of deleted allocations, handed out again before the buffer's
+    gc_buffer_t* buffer;
+} gc_heap_t;
+
+// what spawn gives back, the spawned call's arguments are copied in after it
+typedef struct thread_t
+{
+    void* handle;
+    long long (*entry)(void* args);
+    long long result;
+    char args[];
+} thread_t;
+
+// iterations [lo, hi) of a parallel for that haven't been run yet
+typedef struct pool_range_t
+{
+    long long lo;
+    long long hi;
+} pool_range_t;
+
+// a worker takes from the bottom of its own deque and the others steal from the top
+typedef struct pool_deque_t
+{
+    void* lock; // an SRWLOCK
+    sz_t top;
+    sz_t bottom;
+    pool_range_t ranges[POOL_DEQUE_RANGES];
+} pool_deque_t;
+
+typedef struct stream_buffer_t
+{
+    void* handle;
+    int mode;
+    sz_t size;
+    char data[STREAM_BUFFER_SIZE];
+} stream_buffer_t;
+
+// sits right before the characters of every sgcll string, the string itself still points at nul-terminated data
+typedef struct string_header_t
+{
+    sz_t capacity; // 0 for literals, which can't be appended to in place
+    sz_t hash; // 0 until computed
+    sz_t length;
+} string_header_t;
+
 /* kernel.c */
 
-extern gc_node_t* gc_root;
+extern gc_heap_t* gc_heaps;
 
 void __libsgcllc_init();
+void __libsgcllc_init_thread();
+gc_heap_t* __libsgcllc_gc_take_heap();
+void __libsgcllc_gc_release_heap(gc_heap_t* heap);
 void __libsgcllc_gc_finalize();
+void __libsgcllc_bounds_fail(long long index, long long length);
+void __libsgcllc_slice_fail(long long lo, long long hi, long long length);
 
 /* io.c */
 
+void __libsgcllc_init_streams();
+void __libsgcllc_lock_stream(void* file);
+void __libsgcllc_unlock_stream(void* file);
+void __libsgcllc_fwrite(void* file, char* data, sz_t count);
+void __libsgcllc_fflush(void* file);
+void __libsgcllc_flush_all();
 void __libsgcllc_fputchar(void* file, char c);
 void __libsgcllc_fputs(void* file, char* str);
 void __libsgcllc_fprintf(void* file, char* fmt, ...);
@@ -38,19 +125,65 @@ void* __libsgcllc_stdstream(int descriptor);
 /* string.c */
 
 int __libsgcllc_itos(long long n, char* buffer, sz_t radix);
-int __libsgcllc_ftos(double d, char* buffer, int precision);
-int __libsgcllc_string_length(char* str);
+sz_t __libsgcllc_string_length(char* str);
+char* __libsgcllc_alloc_string(sz_t length);
+char* __libsgcllc_make_string(char* data, sz_t length);
+char* __libsgcllc_reserve_string(char* str, sz_t extra);
+char* __libsgcllc_append_string(char* str, char* data, sz_t length);
+sz_t __libsgcllc_hash_bytes(char* data, sz_t length);
+sz_t __libsgcllc_string_hash(char* str);
+long long __libsgcllc_find_char(char* str, sz_t length, char c);
+long long __libsgcllc_find_substring(char* haystack, sz_t hlength, char* needle, sz_t nlength);
+
+/* grisu.c */
+
+int __libsgcllc_ftos(double d, char* buffer);
+int __libsgcllc_ftos32(float f, char* buffer);
 
 /* memory.c */
 
+void __libsgcllc_leave_heap();
 void* __libsgcllc_alloc_bytes(sz_t amount);
 BOOL __libsgcllc_delete_bytes_no_gc(void* mem);
+BOOL __libsgcllc_delete_bytes(void* mem);
 void* __libsgcllc_dynamic_array(sz_t length, sz_t element_width);
 void* __libsgcllc_dynamic_ndim_array(sz_t element_width, sz_t dc, ...);
 static void __libsgcllc_delete_array_recur(void* array, sz_t dc, unsigned long long* dimensions);
 void __libsgcllc_delete_array(void* array, sz_t dc, ...);
+void* __libsgcllc_soa_array(sz_t length, sz_t blueprint_size);
+void __libsgcllc_delete_soa_array(void* array);
 sz_t __libsgcllc_array_size(void* array);
 void __libsgcllc_copy_memory(void* dest, const void* src, sz_t count);
+int __libsgcllc_compare_memory(const void* lhs, const void* rhs, sz_t count);
 sz_t __libsgcllc_blueprint_size(void* obj);
 
+/* thread.c */
+
+extern volatile BOOL __libsgcllc_threaded;
+
+long long __libsgcllc_thread_spawn(void* entry, void* args, sz_t size);
+long long __libsgcllc_thread_join(long long thread);
+sz_t __libsgcllc_core_count();
+long long __libsgcllc_mutex();
+void __libsgcllc_mutex_lock(long long mutex);
+void __libsgcllc_mutex_unlock(long long mutex);
+long long __libsgcllc_condition();
+void __libsgcllc_condition_wait(long long condition, long long mutex);
+void __libsgcllc_condition_signal(long long condition);
+void __libsgcllc_condition_broadcast(long long condition);
+
+/* pool.c */
+
+void __libsgcllc_parallel_for(void* task, void* merge, void* frame, long long lo, long long hi, sz_t reductions);
+
+/* simd.c */
+
+extern sz_t (*__libsgcllc_simd_string_length)(const char* str);
+extern void (*__libsgcllc_simd_copy_memory)(void* dest, const void* src, sz_t count);
+extern int (*__libsgcllc_simd_compare_memory)(const void* lhs, const void* rhs, sz_t count);
+extern long long (*__libsgcllc_simd_find_char)(const char* str, sz_t length, char c);
+extern long long (*__libsgcllc_simd_find_substring)(const char* haystack, sz_t hlength, const char* needle, sz_t nlength);
+
+void __libsgcllc_simd_select();
+
 #endif
\ No newline at end of file
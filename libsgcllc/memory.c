@@ -2,13 +2,55 @@
 
 #include "libsgcllc.h"
 
+// the heap this thread's allocations are tracked in, see gc_heap_t
+static _Thread_local gc_heap_t* local_heap = NULL;
+
+// heaps are only locked once a second thread exists
+static void __libsgcllc_lock_heap(gc_heap_t* heap)
+{
+    if (__libsgcllc_threaded)
+        AcquireSRWLockExclusive((SRWLOCK*) &heap->lock);
+}
+
+static void __libsgcllc_unlock_heap(gc_heap_t* heap)
+{
+    if (__libsgcllc_threaded)
+        ReleaseSRWLockExclusive((SRWLOCK*) &heap->lock);
+}
+
+// called by a thread that's finishing, so the next thread to start can take its heap over
+void __libsgcllc_leave_heap()
+{
+    if (local_heap)
+        __libsgcllc_gc_release_heap(local_heap);
+    local_heap = NULL;
+}
+
 void* __libsgcllc_alloc_bytes(sz_t amount)
 {
     void* mem = HeapAlloc(GetProcessHeap(), 0, amount);
-    gc_node_t* node = HeapAlloc(GetProcessHeap(), 0, sizeof(gc_node_t));
+    gc_heap_t* heap = local_heap;
+    if (!heap)
+        heap = local_heap = __libsgcllc_gc_take_heap();
+    __libsgcllc_lock_heap(heap);
+    gc_node_t* node = heap->free;
+    if (node)
+        heap->free = node->next;
+    else
+    {
+        if (!heap->buffer || heap->buffer->used == GC_BUFFER_NODES)
+        {
+            gc_buffer_t* buffer = HeapAlloc(GetProcessHeap(), 0, sizeof(gc_buffer_t));
+            buffer->next = heap->buffer;
+            buffer->used = 0;
+            heap->buffer = buffer;
+        }
+        node = &heap->buffer->nodes[heap->buffer->used++];
+    }
     node->mem = mem;
-    node->next = gc_root;
-    gc_root = node;
+    node->next = heap->root;
+    heap->root = node;
+    __libsgcllc_unlock_heap(heap);
     return mem;
 }
 
@@ -17,10 +59,46 @@ BOOL __libsgcllc_delete_bytes_no_gc(void* mem)
     return HeapFree(GetProcessHeap(), 0, mem);
 }
 
+static BOOL __libsgcllc_gc_forget(gc_heap_t* heap, void* mem)
+{
+    BOOL found = 0;
+    __libsgcllc_lock_heap(heap);
+    for (gc_node_t** link = &heap->root; *link; link = &(*link)->next)
+    {
+        if ((*link)->mem == mem)
+        {
+            gc_node_t* node = *link;
+            *link = node->next;
+            node->next = heap->free;
+            heap->free = node;
+            found = 1;
+            break;
+        }
+    }
+    __libsgcllc_unlock_heap(heap);
+    return found;
+}
+
+// also drops mem from the gc list so finalizing doesn't free it a second time, this thread's recent allocations are
+// found first and the other threads' heaps are only searched when it isn't one of them
+BOOL __libsgcllc_delete_bytes(void* mem)
+{
+    if (!local_heap || !__libsgcllc_gc_forget(local_heap, mem))
+    {
+        for (gc_heap_t* heap = gc_heaps; heap; heap = heap->next)
+        {
+            if (heap != local_heap && __libsgcllc_gc_forget(heap, mem))
+                break;
+        }
+    }
+    return __libsgcllc_delete_bytes_no_gc(mem);
+}
+
+// every array keeps its length right in front of its elements, so # and bounds checks are one load
 void* __libsgcllc_dynamic_array(sz_t length, sz_t element_width)
 {
-    char* array = __libsgcllc_alloc_bytes(length * element_width + 1);
-    array[0] = element_width;
+    sz_t* array = __libsgcllc_alloc_bytes(sizeof(sz_t) + length * element_width);
+    array[0] = length;
     return array + 1;
 }
 
@@ -48,7 +126,7 @@ static void __libsgcllc_delete_array_recur(void* array, sz_t dc, unsigned long l
         for (int i = 0; i < *dimensions; i++)
             __libsgcllc_delete_array_recur(((void**) array)[i], dc - 1, dimensions + 1);
     }
-    BOOL result = __libsgcllc_delete_bytes_no_gc((char*) array - 1);
+    BOOL result = __libsgcllc_delete_bytes((sz_t*) array - 1);
     #ifdef __libsgcllc_DEBUG
     if (result)
         __libsgcllc_fprintf(__libsgcllc_stdstream(stdout), "[builtin debug] deallocated array\n");
@@ -63,9 +141,22 @@ void __libsgcllc_delete_array(void* array, sz_t dc, ...)
     __libsgcllc_delete_array_recur(array, dc, args);
 }
 
+// soa arrays have the same length in front, each instance variable gets a column after it
+void* __libsgcllc_soa_array(sz_t length, sz_t blueprint_size)
+{
+    sz_t* array = __libsgcllc_alloc_bytes(sizeof(sz_t) + length * blueprint_size);
+    array[0] = length;
+    return array + 1;
+}
+
+void __libsgcllc_delete_soa_array(void* array)
+{
+    __libsgcllc_delete_bytes((sz_t*) array - 1);
+}
+
 sz_t __libsgcllc_array_size(void* array)
 {
-    return HeapSize(GetProcessHeap(), 0, array - 1) / *((char*) array - 1);
+    return ((sz_t*) array)[-1];
 }
 
 sz_t __libsgcllc_blueprint_size(void* obj)
@@ -75,6 +166,10 @@ sz_t __libsgcllc_blueprint_size(void* obj)
 
 void __libsgcllc_copy_memory(void* dest, const void* src, sz_t count)
 {
-    for (char* dst8 = (char*) dest - 1, * src8 = (char*) src - 1; count--;)
-        *++dst8 = *++src8;
+    __libsgcllc_simd_copy_memory(dest, src, count);
+}
+
+int __libsgcllc_compare_memory(const void* lhs, const void* rhs, sz_t count)
+{
+    return __libsgcllc_simd_compare_memory(lhs, rhs, count);
 }
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include <windows.h>
+
+#include "libsgcllc.h"
+
+// parallel for runs on a pool with a worker per core, the thread running the loop being worker 0 and the rest starting
+// with the first loop. every worker has a deque of ranges of iterations, it takes from its own and steals from the
+// others' when it runs out. whatever it takes it halves until it's down to a chunk, leaving the upper halves in its
+// deque for the idle ones to steal
+
+typedef void (*pool_task_t)(void* frame, long long lo, long long hi, long long* row);
+typedef void (*pool_merge_t)(void* frame, long long* row);
+
+static SRWLOCK pool_loop_lock = SRWLOCK_INIT; // one loop runs on the pool at a time
+static SRWLOCK pool_lock = SRWLOCK_INIT;
+static CONDITION_VARIABLE pool_wake; // a loop started
+static CONDITION_VARIABLE pool_idle; // the last worker finished with it
+static sz_t pool_workers = 0;
+static pool_deque_t* pool_deques;
+static sz_t pool_generation = 0; // loops started so far
+static sz_t pool_busy = 0; // workers that haven't finished with the loop yet
+
+// the loop that's running
+static pool_task_t pool_task;
+static void* pool_frame;
+static long long* pool_rows;
+static sz_t pool_row_size;
+static long long pool_grain;
+static volatile long long pool_remaining; // iterations not run yet
+
+// which worker this thread is, a parallel for started from inside a task just runs on it
+static _Thread_local sz_t pool_worker = -1;
+
+static BOOL __libsgcllc_pool_push(pool_deque_t* deque, long long lo, long long hi)
+{
+    BOOL pushed = 0;
+    AcquireSRWLockExclusive((SRWLOCK*) &deque->lock);
+    if (deque->bottom < POOL_DEQUE_RANGES)
+    {
+        deque->ranges[deque->bottom++] = (pool_range_t) { lo, hi };
+        pushed = 1;
+    }
+    ReleaseSRWLockExclusive((SRWLOCK*) &deque->lock);
+    return pushed;
+}
+
+static BOOL __libsgcllc_pool_take(pool_deque_t* deque, pool_range_t* range, BOOL steal)
+{
+    BOOL taken = 0;
+    AcquireSRWLockExclusive((SRWLOCK*) &deque->lock);
+    if (deque->top < deque->bottom)
+    {
+        *range = steal ? deque->ranges[deque->top++] : deque->ranges[--deque->bottom];
+        if (deque->top == deque->bottom)
+            deque->top = deque->bottom = 0;
+        taken = 1;
+    }
+    ReleaseSRWLockExclusive((SRWLOCK*) &deque->lock);
+    return taken;
+}
+
+static void __libsgcllc_pool_work(sz_t worker)
+{
+    pool_deque_t* own = &pool_deques[worker];
+    long long* row = pool_rows + worker * pool_row_size;
+    while (pool_remaining > 0)
+    {
+        pool_range_t range;
+        BOOL found = __libsgcllc_pool_take(own, &range, 0);
+        for (sz_t i = 1; i < pool_workers && !found; i++)
+            found = __libsgcllc_pool_take(&pool_deques[(worker + i) % pool_workers], &range, 1);
+        if (!found)
+        {
+            SwitchToThread();
+            continue;
+        }
+        while (range.hi - range.lo > pool_grain)
+        {
+            long long half = range.lo + (range.hi - range.lo) / 2;
+            if (!__libsgcllc_pool_push(own, half, range.hi))
+                break;
+            range.hi = half;
+        }
+        pool_task(pool_frame, range.lo, range.hi, row);
+        InterlockedExchangeAdd64(&pool_remaining, range.lo - range.hi);
+    }
+}
+
+static DWORD WINAPI __libsgcllc_pool_start_worker(LPVOID param)
+{
+    sz_t seen = 0;
+    __libsgcllc_init_thread();
+    pool_worker = (sz_t) param;
+    for (;;)
+    {
+        AcquireSRWLockExclusive(&pool_lock);
+        while (pool_generation == seen)
+            SleepConditionVariableSRW(&pool_wake, &pool_lock, INFINITE, 0);
+        seen = pool_generation;
+        ReleaseSRWLockExclusive(&pool_lock);
+        __libsgcllc_pool_work(pool_worker);
+        AcquireSRWLockExclusive(&pool_lock);
+        if (!--pool_busy)
+            WakeConditionVariable(&pool_idle);
+        ReleaseSRWLockExclusive(&pool_lock);
+    }
+    return 0;
+}
+
+static void __libsgcllc_pool_start()
+{
+    pool_workers = __libsgcllc_core_count();
+    if (!pool_workers)
+        pool_workers = 1;
+    pool_deques = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, pool_workers * sizeof(pool_deque_t));
+    for (sz_t i = 0; i < pool_workers; i++)
+        InitializeSRWLock((SRWLOCK*) &pool_deques[i].lock);
+    InitializeConditionVariable(&pool_wake);
+    InitializeConditionVariable(&pool_idle);
+    if (pool_workers > 1)
+        __libsgcllc_threaded = 1;
+    for (sz_t i = 1; i < pool_workers; i++)
+    {
+        HANDLE handle = CreateThread(NULL, 0, __libsgcllc_pool_start_worker, (LPVOID) i, 0, NULL);
+        if (!handle)
+        {
+            __libsgcllc_fflush(__libsgcllc_stdstream(stdout));
+            __libsgcllc_fprintf(__libsgcllc_stdstream(stderr), "could not start the thread pool\n");
+            __libsgcllc_flush_all();
+            ExitProcess(1);
+        }
+        CloseHandle(handle);
+    }
+}
+
+// task runs [lo, hi) on a copy of frame and adds to the row it's given, merge adds a row to the variables in frame.
+// rows are a cache line apart so workers adding to their own don't fight over one
+void __libsgcllc_parallel_for(void* task, void* merge, void* frame, long long lo, long long hi, sz_t reductions)
+{
+    if (lo >= hi)
+        return;
+    sz_t row_size = (reductions + 7) & ~7;
+    if (pool_worker != (sz_t) -1)
+    {
+        long long* row = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, row_size * sizeof(long long) + 8);
+        ((pool_task_t) task)(frame, lo, hi, row);
+        ((pool_merge_t) merge)(frame, row);
+        HeapFree(GetProcessHeap(), 0, row);
+        return;
+    }
+    AcquireSRWLockExclusive(&pool_loop_lock);
+    if (!pool_workers)
+        __libsgcllc_pool_start();
+    pool_worker = 0;
+    pool_task = task;
+    pool_frame = frame;
+    pool_row_size = row_size;
+    pool_rows = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, pool_workers * row_size * sizeof(long long) + 8);
+    pool_grain = (hi - lo) / (pool_workers * POOL_CHUNKS_PER_WORKER);
+    if (pool_grain < 1)
+        pool_grain = 1;
+    pool_remaining = hi - lo;
+    __libsgcllc_pool_push(&pool_deques[0], lo, hi);
+    AcquireSRWLockExclusive(&pool_lock);
+    pool_busy = pool_workers - 1;
+    pool_generation++;
+    WakeAllConditionVariable(&pool_wake);
+    ReleaseSRWLockExclusive(&pool_lock);
+    __libsgcllc_pool_work(0);
+    // the others might still be looking for something to steal
+    AcquireSRWLockExclusive(&pool_lock);
+    while (pool_busy)
+        SleepConditionVariableSRW(&pool_idle, &pool_lock, INFINITE, 0);
+    ReleaseSRWLockExclusive(&pool_lock);
+    pool_worker = -1;
+    for (sz_t i = 0; i < pool_workers; i++)
+        ((pool_merge_t) merge)(frame, pool_rows + i * row_size);
+    HeapFree(GetProcessHeap(), 0, pool_rows);
+    ReleaseSRWLockExclusive(&pool_loop_lock);
+}
\ No newline at end of file
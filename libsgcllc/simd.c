@@ -0,0 +1,230 @@
+#include <windows.h>
+#include <immintrin.h>
+#include <cpuid.h>
+
+#include "libsgcllc.h"
+
+#define AVX2 __attribute__((target("avx2")))
+
+// sse2 is part of the x64 baseline, so those versions are safe to use before __libsgcllc_init runs
+
+static sz_t __libsgcllc_string_length_sse2(const char* str)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uintptr_t misalign = (uintptr_t) str & 15;
+    const __m128i* block = (const __m128i*) (str - misalign); // aligned loads never cross a page
+    unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), zero)) >> misalign;
+    if (mask)
+        return __builtin_ctz(mask);
+    for (;;)
+    {
+        mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(++block), zero));
+        if (mask)
+            return (const char*) block - str + __builtin_ctz(mask);
+    }
+}
+
+static AVX2 sz_t __libsgcllc_string_length_avx2(const char* str)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    uintptr_t misalign = (uintptr_t) str & 31;
+    const __m256i* block = (const __m256i*) (str - misalign);
+    unsigned int mask = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(block), zero)) >> misalign;
+    if (mask)
+        return __builtin_ctz(mask);
+    for (;;)
+    {
+        mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(++block), zero));
+        if (mask)
+            return (const char*) block - str + __builtin_ctz(mask);
+    }
+}
+
+static void __libsgcllc_copy_memory_sse2(void* dest, const void* src, sz_t count)
+{
+    char* dst8 = dest;
+    const char* src8 = src;
+    for (; count >= 16; count -= 16, dst8 += 16, src8 += 16)
+        _mm_storeu_si128((__m128i*) dst8, _mm_loadu_si128((const __m128i*) src8));
+    while (count--)
+        *dst8++ = *src8++;
+}
+
+static AVX2 void __libsgcllc_copy_memory_avx2(void* dest, const void* src, sz_t count)
+{
+    char* dst8 = dest;
+    const char* src8 = src;
+    for (; count >= 64; count -= 64, dst8 += 64, src8 += 64)
+    {
+        __m256i lo = _mm256_loadu_si256((const __m256i*) src8);
+        __m256i hi = _mm256_loadu_si256((const __m256i*) (src8 + 32));
+        _mm256_storeu_si256((__m256i*) dst8, lo);
+        _mm256_storeu_si256((__m256i*) (dst8 + 32), hi);
+    }
+    for (; count >= 16; count -= 16, dst8 += 16, src8 += 16)
+        _mm_storeu_si128((__m128i*) dst8, _mm_loadu_si128((const __m128i*) src8));
+    while (count--)
+        *dst8++ = *src8++;
+}
+
+static int __libsgcllc_compare_memory_sse2(const void* lhs, const void* rhs, sz_t count)
+{
+    const unsigned char* a = lhs, * b = rhs;
+    for (; count >= 16; count -= 16, a += 16, b += 16)
+    {
+        unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) a),
+            _mm_loadu_si128((const __m128i*) b))) ^ 0xFFFF;
+        if (mask)
+        {
+            int i = __builtin_ctz(mask);
+            return a[i] - b[i];
+        }
+    }
+    for (; count--; a++, b++)
+    {
+        if (*a != *b)
+            return *a - *b;
+    }
+    return 0;
+}
+
+static AVX2 int __libsgcllc_compare_memory_avx2(const void* lhs, const void* rhs, sz_t count)
+{
+    const unsigned char* a = lhs, * b = rhs;
+    for (; count >= 32; count -= 32, a += 32, b += 32)
+    {
+        unsigned int mask = ~(unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) a),
+            _mm256_loadu_si256((const __m256i*) b)));
+        if (mask)
+        {
+            int i = __builtin_ctz(mask);
+            return a[i] - b[i];
+        }
+    }
+    return __libsgcllc_compare_memory_sse2(a, b, count);
+}
+
+static long long __libsgcllc_find_char_sse2(const char* str, sz_t length, char c)
+{
+    const __m128i needle = _mm_set1_epi8(c);
+    sz_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        unsigned int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (str + i)), needle));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    for (; i < length; i++)
+    {
+        if (str[i] == c)
+            return i;
+    }
+    return -1;
+}
+
+static AVX2 long long __libsgcllc_find_char_avx2(const char* str, sz_t length, char c)
+{
+    const __m256i needle = _mm256_set1_epi8(c);
+    sz_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        unsigned int mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (str + i)), needle));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    long long found = __libsgcllc_find_char_sse2(str + i, length - i, c);
+    return found < 0 ? found : (long long) i + found;
+}
+
+// candidate positions are those where both the first and the last byte of the needle match,
+// only those get a full comparison
+static long long __libsgcllc_find_substring_sse2(const char* haystack, sz_t hlength, const char* needle, sz_t nlength)
+{
+    if (!nlength)
+        return 0;
+    if (nlength > hlength)
+        return -1;
+    if (nlength == 1)
+        return __libsgcllc_find_char_sse2(haystack, hlength, *needle);
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[nlength - 1]);
+    sz_t i = 0;
+    for (; i + nlength - 1 + 16 <= hlength; i += 16)
+    {
+        __m128i block_first = _mm_loadu_si128((const __m128i*) (haystack + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i*) (haystack + i + nlength - 1));
+        unsigned int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        for (; mask; mask &= mask - 1)
+        {
+            int bit = __builtin_ctz(mask);
+            if (!__libsgcllc_compare_memory(haystack + i + bit + 1, needle + 1, nlength - 2))
+                return i + bit;
+        }
+    }
+    for (; i + nlength <= hlength; i++)
+    {
+        if (haystack[i] == needle[0] && !__libsgcllc_compare_memory(haystack + i, needle, nlength))
+            return i;
+    }
+    return -1;
+}
+
+static AVX2 long long __libsgcllc_find_substring_avx2(const char* haystack, sz_t hlength, const char* needle, sz_t nlength)
+{
+    if (!nlength)
+        return 0;
+    if (nlength > hlength)
+        return -1;
+    if (nlength == 1)
+        return __libsgcllc_find_char_avx2(haystack, hlength, *needle);
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[nlength - 1]);
+    sz_t i = 0;
+    for (; i + nlength - 1 + 32 <= hlength; i += 32)
+    {
+        __m256i block_first = _mm256_loadu_si256((const __m256i*) (haystack + i));
+        __m256i block_last = _mm256_loadu_si256((const __m256i*) (haystack + i + nlength - 1));
+        unsigned int mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last)));
+        for (; mask; mask &= mask - 1)
+        {
+            int bit = __builtin_ctz(mask);
+            if (!__libsgcllc_compare_memory(haystack + i + bit + 1, needle + 1, nlength - 2))
+                return i + bit;
+        }
+    }
+    long long found = __libsgcllc_find_substring_sse2(haystack + i, hlength - i, needle, nlength);
+    return found < 0 ? found : (long long) i + found;
+}
+
+sz_t (*__libsgcllc_simd_string_length)(const char* str) = __libsgcllc_string_length_sse2;
+void (*__libsgcllc_simd_copy_memory)(void* dest, const void* src, sz_t count) = __libsgcllc_copy_memory_sse2;
+int (*__libsgcllc_simd_compare_memory)(const void* lhs, const void* rhs, sz_t count) = __libsgcllc_compare_memory_sse2;
+long long (*__libsgcllc_simd_find_char)(const char* str, sz_t length, char c) = __libsgcllc_find_char_sse2;
+long long (*__libsgcllc_simd_find_substring)(const char* haystack, sz_t hlength, const char* needle, sz_t nlength) = __libsgcllc_find_substring_sse2;
+
+static BOOL __libsgcllc_has_avx2()
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+        return 0;
+    unsigned int xcr0_lo, xcr0_hi;
+    __asm__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+    if ((xcr0_lo & 6) != 6) // os has to save xmm and ymm state
+        return 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return 0;
+    return (ebx & bit_AVX2) != 0;
+}
+
+void __libsgcllc_simd_select()
+{
+    if (!__libsgcllc_has_avx2())
+        return;
+    __libsgcllc_simd_string_length = __libsgcllc_string_length_avx2;
+    __libsgcllc_simd_copy_memory = __libsgcllc_copy_memory_avx2;
+    __libsgcllc_simd_compare_memory = __libsgcllc_compare_memory_avx2;
+    __libsgcllc_simd_find_char = __libsgcllc_find_char_avx2;
+    __libsgcllc_simd_find_substring = __libsgcllc_find_substring_avx2;
+}
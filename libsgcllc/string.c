@@ -2,54 +2,137 @@
 
 #include "libsgcllc.h"
 
+static const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// base 10 goes two digits per division
 int __libsgcllc_itos(long long n, char* buffer, sz_t radix)
 {
-    int i, sign;
-
-    if ((sign = n) < 0)
-        n = -n;
-    i = 0;
-    do
+    unsigned long long u = n < 0 ? 0 - (unsigned long long) n : n;
+    char digits[64];
+    char* p = digits + sizeof(digits);
+    if (radix == 10)
     {
-        int a = abs(n % radix);
-        if (a > 9)
-            a += '7';
+        for (; u >= 100; u /= 100)
+        {
+            int pair = (u % 100) * 2;
+            *--p = digit_pairs[pair + 1];
+            *--p = digit_pairs[pair];
+        }
+        if (u >= 10)
+        {
+            *--p = digit_pairs[u * 2 + 1];
+            *--p = digit_pairs[u * 2];
+        }
         else
-            a += '0';
-        buffer[i++] = a;
+            *--p = '0' + u;
     }
-    while (n /= radix);
-    if (sign < 0)
-        buffer[i++] = '-';
-    buffer[i] = '\0';
-    for (int j = 0; j < i / 2; j++)
+    else
     {
-        char temp = buffer[j];
-        buffer[j] = buffer[i - j - 1];
-        buffer[i - j - 1] = temp;
+        do
+        {
+            int a = u % radix;
+            *--p = a > 9 ? a + '7' : a + '0';
+        }
+        while (u /= radix);
     }
+    int i = 0;
+    if (n < 0)
+        buffer[i++] = '-';
+    while (p < digits + sizeof(digits))
+        buffer[i++] = *p++;
+    buffer[i] = '\0';
     return i;
 }
 
-int __libsgcllc_ftos(double d, char* buffer, int precision)
+sz_t __libsgcllc_string_length(char* str)
+{
+    return __libsgcllc_simd_string_length(str);
+}
+
+char* __libsgcllc_alloc_string(sz_t length)
+{
+    string_header_t* header = __libsgcllc_alloc_bytes(sizeof(string_header_t) + length + 1);
+    header->capacity = length;
+    header->hash = 0;
+    header->length = length;
+    char* str = (char*) (header + 1);
+    str[length] = '\0';
+    return str;
+}
+
+char* __libsgcllc_make_string(char* data, sz_t length)
+{
+    char* str = __libsgcllc_alloc_string(length);
+    __libsgcllc_copy_memory(str, data, length);
+    return str;
+}
+
+// returns str if it has room for extra more bytes, otherwise a copy of it with double the room
+char* __libsgcllc_reserve_string(char* str, sz_t extra)
 {
-    int ipart = (int) d;
-    double fpart = d - ipart;
-    int i = __libsgcllc_itos(ipart, buffer, 10);
-    if (fpart != (int) fpart)
-        buffer[i++] = '.';
-    for (; fpart != (int) fpart && precision > 0; fpart -= (int) fpart, precision--)
+    string_header_t* header = string_header(str);
+    sz_t length = header->length;
+    // literals have no capacity and live in read-only memory, so they're always copied
+    if (header->capacity && length + extra <= header->capacity)
+        return str;
+    sz_t capacity = header->capacity * 2;
+    if (capacity < length + extra)
+        capacity = length + extra;
+    char* new = __libsgcllc_alloc_string(capacity);
+    __libsgcllc_copy_memory(new, str, length);
+    new[length] = '\0';
+    string_header(new)->length = length;
+    return new;
+}
+
+char* __libsgcllc_append_string(char* str, char* data, sz_t length)
+{
+    str = __libsgcllc_reserve_string(str, length);
+    string_header_t* header = string_header(str);
+    __libsgcllc_copy_memory(str + header->length, data, length);
+    header->length += length;
+    header->hash = 0;
+    str[header->length] = '\0';
+    return str;
+}
+
+// fnv-1a, has to match the hash sgcllc puts in the headers of string literals
+// never 0 so a string header can use 0 for not computed yet
+sz_t __libsgcllc_hash_bytes(char* data, sz_t length)
+{
+    sz_t hash = 14695981039346656037ULL;
+    for (sz_t i = 0; i < length; i++)
     {
-        fpart *= 10.0;
-        buffer[i++] = abs((int) fpart) + '0';
+        hash ^= (unsigned char) data[i];
+        hash *= 1099511628211ULL;
     }
-    buffer[i] = '\0';
-    return i;
+    return hash ? hash : 1;
 }
 
-int __libsgcllc_string_length(char* str)
+sz_t __libsgcllc_string_hash(char* str)
 {
-    int i = 0;
-    for (; str[i]; i++);
-    return i;
+    string_header_t* header = string_header(str);
+    if (header->hash)
+        return header->hash;
+    return header->hash = __libsgcllc_hash_bytes(str, header->length);
+}
+
+long long __libsgcllc_find_char(char* str, sz_t length, char c)
+{
+    return __libsgcllc_simd_find_char(str, length, c);
+}
+
+long long __libsgcllc_find_substring(char* haystack, sz_t hlength, char* needle, sz_t nlength)
+{
+    return __libsgcllc_simd_find_substring(haystack, hlength, needle, nlength);
 }
\ No newline at end of file
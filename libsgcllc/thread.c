@@ -0,0 +1,94 @@
+#include <windows.h>
+
+#include "libsgcllc.h"
+
+// set when the first thread is spawned, until then the heaps and streams don't bother locking
+volatile BOOL __libsgcllc_threaded = 0;
+
+static DWORD WINAPI __libsgcllc_thread_start(LPVOID param)
+{
+    thread_t* thread = param;
+    __libsgcllc_init_thread();
+    thread->result = thread->entry(thread->args);
+    __libsgcllc_leave_heap();
+    return 0;
+}
+
+// entry is a stub the compiler writes for every spawn, it moves the arguments it's given back into the registers the
+// spawned function takes them in. args is in the spawning function's frame, so it gets copied
+long long __libsgcllc_thread_spawn(void* entry, void* args, sz_t size)
+{
+    thread_t* thread = HeapAlloc(GetProcessHeap(), 0, sizeof(thread_t) + size);
+    thread->entry = entry;
+    thread->result = 0;
+    __libsgcllc_copy_memory(thread->args, args, size);
+    __libsgcllc_threaded = 1;
+    thread->handle = CreateThread(NULL, 0, __libsgcllc_thread_start, thread, 0, NULL);
+    if (!thread->handle)
+    {
+        __libsgcllc_fflush(__libsgcllc_stdstream(stdout));
+        __libsgcllc_fprintf(__libsgcllc_stdstream(stderr), "could not start a thread\n");
+        __libsgcllc_flush_all();
+        ExitProcess(1);
+    }
+    return (long long) thread;
+}
+
+// a thread can only be joined once
+long long __libsgcllc_thread_join(long long handle)
+{
+    thread_t* thread = (thread_t*) handle;
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    long long result = thread->result;
+    HeapFree(GetProcessHeap(), 0, thread);
+    return result;
+}
+
+sz_t __libsgcllc_core_count()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+}
+
+// mutexes and condition variables are tracked like any other allocation, and never need destroying
+long long __libsgcllc_mutex()
+{
+    SRWLOCK* mutex = __libsgcllc_alloc_bytes(sizeof(SRWLOCK));
+    InitializeSRWLock(mutex);
+    return (long long) mutex;
+}
+
+void __libsgcllc_mutex_lock(long long mutex)
+{
+    AcquireSRWLockExclusive((SRWLOCK*) mutex);
+}
+
+void __libsgcllc_mutex_unlock(long long mutex)
+{
+    ReleaseSRWLockExclusive((SRWLOCK*) mutex);
+}
+
+long long __libsgcllc_condition()
+{
+    CONDITION_VARIABLE* condition = __libsgcllc_alloc_bytes(sizeof(CONDITION_VARIABLE));
+    InitializeConditionVariable(condition);
+    return (long long) condition;
+}
+
+// mutex has to be locked, it's unlocked while waiting and locked again before returning
+void __libsgcllc_condition_wait(long long condition, long long mutex)
+{
+    SleepConditionVariableSRW((CONDITION_VARIABLE*) condition, (SRWLOCK*) mutex, INFINITE, 0);
+}
+
+void __libsgcllc_condition_signal(long long condition)
+{
+    WakeConditionVariable((CONDITION_VARIABLE*) condition);
+}
+
+void __libsgcllc_condition_broadcast(long long condition)
+{
+    WakeAllConditionVariable((CONDITION_VARIABLE*) condition);
+}
\ No newline at end of file
@@ -5,9 +5,16 @@
 
 static void ast_print_recur(ast_node_t* node, int indent);
 
+unsigned long long ast_node_count = 0;
+
+static __thread vector_t* tracked = NULL;
+
 static ast_node_t* ast_init(ast_node_type type, datatype_t* datatype, location_t* loc, ast_node_t* base)
 {
     ast_node_t* node = calloc(1, sizeof(ast_node_t));
+    __atomic_add_fetch(&ast_node_count, 1, __ATOMIC_RELAXED); // the emitter makes nodes from worker threads
+    if (tracked)
+        vector_push(tracked, node);
     *node = *base;
     node->type = type;
     node->datatype = datatype;
@@ -15,6 +22,43 @@ static ast_node_t* ast_init(ast_node_type type, datatype_t* datatype, location_t
     return node;
 }
 
+// every node made while nodes is being tracked gets pushed to it, returns what was tracked before
+vector_t* ast_track(vector_t* nodes)
+{
+    vector_t* previous = tracked;
+    tracked = nodes;
+    return previous;
+}
+
+// frees the tracked nodes and the vectors they own, functions are skipped since the environment still points at them
+void ast_release(vector_t* nodes)
+{
+    for (int i = 0; i < nodes->size; i++)
+    {
+        ast_node_t* node = vector_get(nodes, i);
+        switch (node->type)
+        {
+            case AST_FUNC_DEFINITION:
+                continue;
+            case AST_BLOCK:
+                vector_delete(node->statements);
+                break;
+            case AST_FUNC_CALL:
+                vector_delete(node->args);
+                break;
+            case AST_SWITCH:
+                vector_delete(node->cases);
+                break;
+            case AST_CASE:
+                if (node->case_conditions)
+                    vector_delete(node->case_conditions);
+                break;
+        }
+        free(node);
+    }
+    nodes->size = 0;
+}
+
 ast_node_t* ast_file_init(location_t* loc)
 {
     return ast_init(AST_FILE, NULL, loc, &(ast_node_t){
@@ -206,6 +250,15 @@ ast_node_t* ast_ternary_init(datatype_t* dt, location_t* loc, ast_node_t* cond,
     });
 }
 
+ast_node_t* ast_slice_init(datatype_t* dt, location_t* loc, ast_node_t* base, ast_node_t* lo, ast_node_t* hi)
+{
+    return ast_init(OP_SLICE, dt, loc, &(ast_node_t){
+        .slice_base = base,
+        .slice_lo = lo,
+        .slice_hi = hi
+    });
+}
+
 ast_node_t* ast_switch_init(location_t* loc, ast_node_t* cmp)
 {
     return ast_init(AST_SWITCH, cmp->datatype, loc, &(ast_node_t){
@@ -237,6 +290,7 @@ static void ast_print_datatype(datatype_t* dt, int indent)
             break;
         }
         case DTT_ARRAY:
+        case DTT_SLICE:
         {
             indprintf(indent, "array_type: {\n");
             indent++;
@@ -576,6 +630,33 @@ static void ast_print_recur(ast_node_t* node, int indent)
             indprintf(indent, "}\n");
             break;
         }
+        case OP_SLICE:
+        {
+            indprintf(indent, "OP_SLICE {\n");
+            indent++;
+            std_ast_print(node, indent);
+            indprintf(indent, "base: {\n");
+            indent++;
+            ast_print_recur(node->slice_base, indent);
+            indent--;
+            indprintf(indent, "}\n");
+            indprintf(indent, "lo: {\n");
+            indent++;
+            ast_print_recur(node->slice_lo, indent);
+            indent--;
+            indprintf(indent, "}\n");
+            if (node->slice_hi)
+            {
+                indprintf(indent, "hi: {\n");
+                indent++;
+                ast_print_recur(node->slice_hi, indent);
+                indent--;
+                indprintf(indent, "}\n");
+            }
+            indent--;
+            indprintf(indent, "}\n");
+            break;
+        }
         case AST_CAST:
         {
             indprintf(indent, "AST_CAST {\n");
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "sgcllc.h"
+
+// shared by every file built in this process, so a library gets probed for and opened once no matter how many files import it
+
+typedef struct
+{
+    char* object_path;
+    char* header_path;
+    long long mtime;
+    long long size;
+    header_t* header;
+} import_entry_t;
+
+static map_t* import_cache = NULL; // import name -> import_entry_t
+
+static char* import_path(char* search_path, char* name, char* extension)
+{
+    buffer_t* buffer = buffer_init(256, 128);
+    buffer_string(buffer, search_path);
+    buffer_append(buffer, '/');
+    buffer_string(buffer, name);
+    buffer_string(buffer, extension);
+    buffer_append(buffer, '\0');
+    char* path = buffer_export(buffer);
+    buffer_delete(buffer);
+    return path;
+}
+
+static bool import_stat(char* path, long long* mtime, long long* size)
+{
+    struct stat st;
+    if (stat(path, &st))
+        return false;
+    *mtime = st.st_mtime;
+    *size = st.st_size;
+    return true;
+}
+
+static import_entry_t* import_resolve(char* name)
+{
+    for (int i = 0; i < options->import_search_paths->size; i++)
+    {
+        char* search_path = vector_get(options->import_search_paths, i);
+        char* object_path = import_path(search_path, name, ".o");
+        char* header_path = import_path(search_path, name, ".sgcllh");
+        if (fexists(object_path) && fexists(header_path))
+        {
+            import_entry_t* entry = calloc(1, sizeof(import_entry_t));
+            entry->object_path = object_path;
+            entry->header_path = header_path;
+            entry->mtime = -1;
+            return entry;
+        }
+        free(object_path);
+        free(header_path);
+    }
+    return NULL;
+}
+
+// the header is reopened whenever the file changed since it was last opened, NULL if there's no library called name
+header_t* import_cache_get(char* name, char** object_path)
+{
+    if (!import_cache)
+        import_cache = map_init(NULL, 20);
+    import_entry_t* entry = map_get(import_cache, name);
+    long long mtime, size;
+    if (!entry || !import_stat(entry->header_path, &mtime, &size))
+    {
+        if (!(entry = import_resolve(name)))
+            return NULL;
+        map_put(import_cache, name, entry);
+        if (!import_stat(entry->header_path, &mtime, &size))
+            return NULL;
+    }
+    if (!entry->header || entry->mtime != mtime || entry->size != size)
+    {
+        tracef(TRACE_DRIVER, TRACE_INFO, "opening header %s\n", entry->header_path);
+        int phase = report_switch(PHASE_IMPORT);
+        entry->header = open_header(entry->header_path, name);
+        report_switch(phase);
+        entry->mtime = mtime;
+        entry->size = size;
+    }
+    *object_path = entry->object_path;
+    return entry->header;
+}
+
+// for when sgcllc itself is about to rewrite a header, the mtime might not move if it happens within the same second
+void import_cache_invalidate(char* header_path)
+{
+    if (!import_cache)
+        return;
+    for (int i = 0; i < import_cache->capacity; i++)
+    {
+        import_entry_t* entry = import_cache->key[i] ? import_cache->value[i] : NULL;
+        if (entry && entry->header && !strcmp(entry->header_path, header_path))
+        {
+            close_header(entry->header);
+            entry->header = NULL;
+        }
+    }
+}
+
+// everything in the cache is relative to the working directory, so it's thrown out when that changes
+void import_cache_reset(void)
+{
+    import_cache = NULL;
+}
\ No newline at end of file
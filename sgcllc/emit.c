@@ -3,6 +3,7 @@
 #include <stdarg.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
 
 #include "sgcllc.h"
 
@@ -22,6 +23,9 @@ static void emit_gvar_decl(emitter_t* e, ast_node_t* gvar);
 static void emit_func_definition(emitter_t* e, ast_node_t* func_definition, ast_node_t* blueprint);
 static void emit_subscript(emitter_t* e, ast_node_t* op, bool deref);
 static void emit_selection(emitter_t* e, ast_node_t* op, bool deref);
+static void emit_slice(emitter_t* e, ast_node_t* slice);
+static void emit_bounds_check(emitter_t* e, char* index, char* length);
+static void emit_simd_op(emitter_t* e, ast_node_t* op);
 static void emit_stmt(emitter_t* e, ast_node_t* stmt);
 static void emit_expr(emitter_t* e, ast_node_t* expr);
 static void emit_lvar_decl(emitter_t* e, ast_node_t* lvar);
@@ -38,13 +42,23 @@ int operand_priority(ast_node_t* op)
     }
 }
 
-int find_stackalloc(vector_t* lvars)
+int find_stackalloc(ast_node_t* func_definition)
 {
     int stackalloc = 32;
-    for (int i = 0; i < lvars->size; i++)
+    for (int i = 0; i < func_definition->local_variables->size; i++)
     {
-        ast_node_t* node = vector_get(lvars, i);
+        ast_node_t* node = vector_get(func_definition->local_variables, i);
         stackalloc += node->datatype->size;
+        if (isvaluetype(node->datatype)) // lined up to 8 bytes
+            stackalloc += 7;
+    }
+    for (int i = 0; i < func_definition->params->size; i++)
+    {
+        ast_node_t* node = vector_get(func_definition->params, i);
+        if (isvaluetype(node->datatype) && node->datatype->size > 8) // copied in by the prologue
+            stackalloc += node->datatype->size + 7;
+        else if (node->datatype->type == DTT_SIMD)
+            stackalloc += node->datatype->size;
     }
     return stackalloc + 16 - (stackalloc % 16);
 }
@@ -71,14 +85,31 @@ char float_reg_size(int size)
     return '\0';
 }
 
-char* find_register(register_type rt, int size)
+static char* register_names[128][9]; // [register type][size]
+static char* xmm_names[16];
+
+// filled in once by the first emitter, which is always made before any workers start
+static void registers_init(void)
 {
+    static bool done = false;
+    if (done)
+        return;
+    int xmm = 0;
     #define reg(n, t, s, isfloat) \
-    if (rt == t && size == s) \
-        return n;
+    if (isfloat) \
+        xmm_names[xmm++] = n; \
+    if (!register_names[t][s]) \
+        register_names[t][s] = n;
     #include "registers.inc"
     #undef reg
-    return NULL;
+    done = true;
+}
+
+char* find_register(register_type rt, int size)
+{
+    if (rt < 0 || rt >= 128 || size < 0 || size > 8)
+        return NULL;
+    return register_names[rt][size];
 }
 
 int deduce_register_size(char* reg)
@@ -91,13 +122,128 @@ int deduce_register_size(char* reg)
     return -1;
 }
 
+#define EMIT_FLUSH_SIZE 65536
+
+static void emitter_flush(emitter_t* e)
+{
+    if (!e->out || !e->code->size)
+        return;
+    fwrite(e->code->data, 1, e->code->size, e->out);
+    e->code->size = 0;
+}
+
+static inline char* emitter_reserve(emitter_t* e, int size)
+{
+    buffer_t* code = e->code;
+    if (code->size + size > code->capacity)
+    {
+        while (code->size + size > code->capacity)
+            code->capacity *= 2;
+        code->data = realloc(code->data, code->capacity);
+    }
+    return code->data + code->size;
+}
+
+static void emitter_write(emitter_t* e, const char* str, int length)
+{
+    memcpy(emitter_reserve(e, length), str, length);
+    e->code->size += length;
+}
+
+static void emitter_write_int(emitter_t* e, unsigned long long magnitude, bool negative, int base, int width, char pad)
+{
+    char digits[24];
+    int count = 0;
+    do
+    {
+        digits[count++] = "0123456789abcdef"[magnitude % base];
+        magnitude /= base;
+    }
+    while (magnitude);
+    char* out = emitter_reserve(e, max(count, width) + 1);
+    int written = 0;
+    if (negative)
+        out[written++] = '-';
+    for (int i = count + negative; i < width; i++)
+        out[written++] = pad;
+    while (count)
+        out[written++] = digits[--count];
+    e->code->size += written;
+}
+
+// a printf that only knows what the emitter uses: %s %c %i %d %u %x, a 0 flag, a width, ll, and %%
 void emitf(emitter_t* e, const char* fmt, ...)
 {
     va_list args;
     va_start(args, fmt);
-    vfprintf(e->out, fmt, args);
+    for (const char* c = fmt; *c;)
+    {
+        const char* start = c;
+        while (*c && *c != '%')
+            c++;
+        if (c != start)
+            emitter_write(e, start, c - start);
+        if (!*c)
+            break;
+        c++;
+        char pad = ' ';
+        int width = 0;
+        bool wide = false;
+        if (*c == '0')
+        {
+            pad = '0';
+            c++;
+        }
+        while (*c >= '0' && *c <= '9')
+            width = width * 10 + *c++ - '0';
+        while (*c == 'l')
+        {
+            wide = true;
+            c++;
+        }
+        switch (*c++)
+        {
+            case 's':
+            {
+                char* str = va_arg(args, char*);
+                emitter_write(e, str, strlen(str));
+                break;
+            }
+            case 'c':
+            {
+                *emitter_reserve(e, 1) = (char) va_arg(args, int);
+                e->code->size++;
+                break;
+            }
+            case 'i':
+            case 'd':
+            {
+                long long value = wide ? va_arg(args, long long) : va_arg(args, int);
+                emitter_write_int(e, value < 0 ? -(unsigned long long) value : value, value < 0, 10, width, pad);
+                break;
+            }
+            case 'u':
+            case 'x':
+            {
+                unsigned long long value = wide ? va_arg(args, unsigned long long) : va_arg(args, unsigned int);
+                emitter_write_int(e, value, false, c[-1] == 'x' ? 16 : 10, width, pad);
+                break;
+            }
+            case '%':
+            {
+                *emitter_reserve(e, 1) = '%';
+                e->code->size++;
+                break;
+            }
+            default:
+                errore(0, 0, "dev error: emitf doesn't know the format '%s'", fmt);
+        }
+    }
     va_end(args);
-    fprintf(e->out, "\n");
+    *emitter_reserve(e, 1) = '\n';
+    e->code->size++;
+    if (e->code->size >= EMIT_FLUSH_SIZE)
+        emitter_flush(e);
 }
 
 emitter_t* emitter_init(parser_t* p, FILE* out, bool control)
@@ -109,9 +255,32 @@ emitter_t* emitter_init(parser_t* p, FILE* out, bool control)
     e->ftmp = 4;
     e->stackmax = 0;
     e->control = control;
+    // the file's emitter flushes to out as it fills up, a function's emitter keeps everything until it's stitched in
+    e->code = buffer_init(out ? EMIT_FLUSH_SIZE * 2 : 1024, 0);
+    e->bounds_fails = vector_init(8, 8);
+    registers_init();
     return e;
 }
 
+// labels made while emitting a function belong to it, so they come out the same no matter which thread got it
+static char* emitter_make_label(emitter_t* e)
+{
+    char* label = malloc(32);
+    sprintf(label, ".L%i_%i", e->func_index, e->labels++);
+    return label;
+}
+
+// constants are kept by the function that needs them and go into the file's pool once every function is done
+static char* emitter_constant(emitter_t* e, constant_t* constant)
+{
+    constant_t* pooled = pool_put(e->constants, constant);
+    if (pooled != constant)
+        constant_delete(constant);
+    else
+        constant->label = emitter_make_label(e);
+    return pooled->label;
+}
+
 static char* emitter_stash_int_reg(emitter_t* e, char* reg)
 {
     int size = deduce_register_size(reg);
@@ -131,34 +300,196 @@ static char* emitter_stash_float_reg(emitter_t* e, char* reg, int size)
 {
     if (e->ftmp >= 16)
         errore(0, 0, "tell dev to add float stack pushing lol");
-    char* name = malloc(6);
-    name[0] = 'x';
-    name[1] = name[2] = 'm';
-    itos(e->ftmp++, name + 3);
+    char* name = xmm_names[e->ftmp++];
     emit("movs%c %%%s, %%%s", floatsize(size), reg, name);
     return name;
 }
 
 static char* emitter_restore_float_reg(emitter_t* e, int size)
 {
-    char* name = malloc(6);
-    name[0] = 'x';
-    name[1] = name[2] = 'm';
-    itos(--e->ftmp, name + 3);
-    return name;
+    return xmm_names[--e->ftmp];
 }
 
-static void emit_blueprint(emitter_t* e, ast_node_t* blueprint)
+// simd values are worked on in xmm0 (ymm0 when they're 32 bytes) and stashed where floats are
+static char simd_reg(emitter_t* e, datatype_t* dt)
 {
-    for (int i = 0; i < blueprint->methods->size; i++)
-        emit_func_definition(e, vector_get(blueprint->methods, i), blueprint);
+    e->ymm |= dt->size == 32;
+    return dt->size == 32 ? 'y' : 'x';
 }
 
-static void emit_file(emitter_t* e, ast_node_t* file)
+static void emit_simd_load(emitter_t* e, datatype_t* dt, char* from, int reg)
+{
+    emit("%smovups %s, %%%cmm%i", options->avx2 ? "v" : "", from, simd_reg(e, dt), reg);
+}
+
+static void emit_simd_store(emitter_t* e, datatype_t* dt, int reg, char* to)
+{
+    emit("%smovups %%%cmm%i, %s", options->avx2 ? "v" : "", simd_reg(e, dt), reg, to);
+}
+
+static void emit_simd_copy(emitter_t* e, datatype_t* dt, int from, int to)
+{
+    char r = simd_reg(e, dt);
+    emit("%smovaps %%%cmm%i, %%%cmm%i", options->avx2 ? "v" : "", r, from, r, to);
+}
+
+static int emitter_stash_simd_reg(emitter_t* e, datatype_t* dt)
+{
+    if (e->ftmp >= 16)
+        errore(0, 0, "tell dev to add float stack pushing lol");
+    emit_simd_copy(e, dt, 0, e->ftmp);
+    return e->ftmp++;
+}
+
+static int emitter_restore_simd_reg(emitter_t* e)
+{
+    return --e->ftmp;
+}
+
+// a register above every stashed one, free until something else gets stashed
+static int emitter_simd_scratch(emitter_t* e, int n)
+{
+    if (e->ftmp + n >= 16)
+        errore(0, 0, "tell dev to add float stack pushing lol");
+    return e->ftmp + n;
+}
+
+static int hex_digit(int c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// decodes the literal the same way gas does for .string and writes the string header (capacity, hash, length) in front of it
+static void emit_string_header(emitter_t* e, char* literal)
+{
+    unsigned long long hash = 14695981039346656037ULL, length = 0;
+    char* end = literal + strlen(literal) - 1;
+    for (char* c = literal + 1; c < end; length++)
+    {
+        int value = *c++;
+        if (value == '\\' && c < end)
+        {
+            value = *c++;
+            switch (value)
+            {
+                case 'b': value = '\b'; break;
+                case 'f': value = '\f'; break;
+                case 'n': value = '\n'; break;
+                case 'r': value = '\r'; break;
+                case 't': value = '\t'; break;
+                case '0' ... '7':
+                {
+                    value -= '0';
+                    for (int i = 1; i < 3 && c < end && *c >= '0' && *c <= '7'; i++)
+                        value = value * 8 + *c++ - '0';
+                    break;
+                }
+                case 'x':
+                {
+                    value = 0;
+                    while (c < end && hex_digit(*c) >= 0)
+                        value = value * 16 + hex_digit(*c++);
+                    break;
+                }
+            }
+        }
+        hash ^= (unsigned char) value;
+        hash *= 1099511628211ULL;
+    }
+    emit(".balign 8");
+    emit(".quad 0");
+    emit(".quad %llu", hash ? hash : 1);
+    emit(".quad %llu", length);
+}
+
+static void emit_constant(emitter_t* e, constant_t* constant)
+{
+    switch (constant->kind)
+    {
+        case CONSTANT_F32:
+            emit(".balign 4");
+            emit_noindent("%s:", constant->label);
+            emit(".long 0x%08llx", constant->bits[0]);
+            break;
+        case CONSTANT_F64:
+            emit(".balign 8");
+            emit_noindent("%s:", constant->label);
+            emit(".quad 0x%016llx", constant->bits[0]);
+            break;
+        case CONSTANT_XMM:
+            emit(".balign 16");
+            emit_noindent("%s:", constant->label);
+            emit(".quad 0x%016llx", constant->bits[0]);
+            emit(".quad 0x%016llx", constant->bits[1]);
+            break;
+        case CONSTANT_STRING:
+            emit_string_header(e, constant->text);
+            emit_noindent("%s:", constant->label);
+            emit(".string %s", constant->text);
+            break;
+    }
+}
+
+typedef struct
+{
+    ast_node_t* func_definition;
+    ast_node_t* blueprint;
+    emitter_t* e;
+} emit_job_t;
+
+typedef struct
+{
+    vector_t* jobs;
+    int next;
+    bool failed;
+} emit_work_t;
+
+// functions don't depend on each other once parsing is done, so workers just grab the next one
+static void* emit_worker(void* arg)
+{
+    emit_work_t* work = arg;
+    jmp_buf env;
+    jmp_buf* previous = error_recover(&env);
+    if (setjmp(env))
+        __atomic_store_n(&work->failed, true, __ATOMIC_RELAXED);
+    while (!__atomic_load_n(&work->failed, __ATOMIC_RELAXED))
+    {
+        int i = __atomic_fetch_add(&work->next, 1, __ATOMIC_RELAXED);
+        if (i >= work->jobs->size)
+            break;
+        emit_job_t* job = vector_get(work->jobs, i);
+        emit_func_definition(job->e, job->func_definition, job->blueprint);
+    }
+    error_recover(previous);
+    return NULL;
+}
+
+static void emit_job(emitter_t* e, vector_t* jobs, ast_node_t* func_definition, ast_node_t* blueprint)
+{
+    if (func_definition->lowlvl_label)
+        return;
+    if (!strcmp(func_definition->func_name, "main"))
+    {
+        parser_ensure_cextern(e->p, "__libsgcllc_init", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+        parser_ensure_cextern(e->p, "__libsgcllc_gc_finalize", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+    }
+    emit_job_t* job = calloc(1, sizeof(emit_job_t));
+    job->func_definition = func_definition;
+    job->blueprint = blueprint;
+    job->e = emitter_init(e->p, NULL, e->control);
+    job->e->func_index = e->functions++;
+    job->e->constants = pool_init();
+    vector_push(jobs, job);
+}
+
+static void emit_entry(emitter_t* e)
 {
     ast_node_t* defaul_main = ast_func_definition_init(t_i32, NULL, 'g', e->p->entry, e->p->lex->filename);
     char* defaul_label = make_func_label(e->p->lex->filename, defaul_main, NULL);
-    debugf("entry label: %s\n", defaul_label);
+    tracef(TRACE_EMITTER, TRACE_INFO, "entry label: %s\n", defaul_label);
     if (map_get(e->p->genv, defaul_label))
     {
         emit_noindent("main:");
@@ -166,101 +497,287 @@ static void emit_file(emitter_t* e, ast_node_t* file)
         emit(".global main");
     }
     free(defaul_label);
-    for (int i = 0; i < file->decls->size; i++)
+}
+
+static void emit_decls(emitter_t* e, vector_t* decls)
+{
+    vector_t* jobs = vector_init(max(decls->size, 1), 10);
+    for (int i = 0; i < decls->size; i++)
     {
-        ast_node_t* node = (ast_node_t*) vector_get(file->decls, i);
+        ast_node_t* node = (ast_node_t*) vector_get(decls, i);
         if (node->type == AST_GVAR)
             emit_gvar_decl(e, node);
         else if (node->type == AST_FUNC_DEFINITION)
-            emit_func_definition(e, node, NULL);
+            emit_job(e, jobs, node, NULL);
         else if (node->type == AST_BLUEPRINT)
-            emit_blueprint(e, node);
+        {
+            for (int j = 0; j < node->methods->size; j++)
+                emit_job(e, jobs, vector_get(node->methods, j), node);
+        }
     }
-    for (int i = 0; i < e->p->labels->capacity; i++)
+    emit_work_t work = { jobs, 0, false };
+    int threads = min(options ? options->jobs : 1, jobs->size) - 1;
+    pthread_t* workers = calloc(max(threads, 1), sizeof(pthread_t));
+    for (int i = 0; i < threads; i++)
     {
-        char* key = e->p->labels->key[i];
-        char* value = e->p->labels->value[i];
-        if (key == NULL || value == NULL)
-            continue;
-        int valuelen = strlen(value);
-        char* lastchar = &(value[valuelen - 1]);
-        emit_noindent("%s:", key);
-        if (value[0] == '"')
-            emit(".string %s", value);
-        else if (*lastchar == 'f' || *lastchar == 'F')
+        if (pthread_create(workers + i, NULL, emit_worker, &work))
+            threads = i;
+    }
+    emit_worker(&work);
+    for (int i = 0; i < threads; i++)
+        pthread_join(workers[i], NULL);
+    free(workers);
+    if (work.failed)
+        error_exit();
+    // stitched back together in declaration order, the output doesn't depend on how many threads there were
+    pool_t* pool = e->p->constants;
+    for (int i = 0; i < jobs->size; i++)
+    {
+        emit_job_t* job = vector_get(jobs, i);
+        emitter_flush(e);
+        fwrite(job->e->code->data, 1, job->e->code->size, e->out);
+        for (int j = 0; j < job->e->constants->constants->size; j++)
         {
-            *lastchar = '\0';
-            emit(".single %s", value);
-            *lastchar = 'f';
+            constant_t* constant = vector_get(job->e->constants->constants, j);
+            constant_t* pooled = pool_put(pool, constant);
+            if (pooled != constant)
+                emit(".set %s, %s", constant->label, pooled->label);
         }
-        else
+        pool_delete(job->e->constants);
+        emitter_delete(job->e);
+        free(job);
+    }
+    vector_delete(jobs);
+}
+
+static void emit_constants(emitter_t* e)
+{
+    // read-only so the linker can put them with everything else that's constant, biggest alignment first to skip padding
+    pool_t* pool = e->p->constants;
+    if (!pool->constants->size)
+        return;
+    emit(".section .rdata, \"dr\"");
+    int kinds[] = { CONSTANT_XMM, CONSTANT_F64, CONSTANT_F32, CONSTANT_STRING };
+    for (int i = 0; i < sizeof(kinds) / sizeof(int); i++)
+    {
+        for (int j = 0; j < pool->constants->size; j++)
         {
-            if (*lastchar == 'd' || *lastchar == 'D') *lastchar = '\0';
-            emit(".double %s", value);
-            if (*lastchar == '\0') *lastchar = 'd';
+            constant_t* constant = vector_get(pool->constants, j);
+            if (constant->kind == kinds[i])
+                emit_constant(e, constant);
         }
     }
 }
 
+static void emit_file(emitter_t* e, ast_node_t* file)
+{
+    emit_entry(e);
+    emit_decls(e, file->decls);
+    emit_constants(e);
+}
+
 static void emit_gvar_decl(emitter_t* e, ast_node_t* gvar)
 {
     errore(gvar->loc->row, gvar->loc->col, "global variable decls are not implemented yet");
 }
 
+// value blueprints are always a multiple of 8 bytes
+static void emit_value_copy(emitter_t* e, char* src, char* dest, int size)
+{
+    for (int i = 0; i < size; i += 8)
+    {
+        emit("movq %i(%%%s), %%rcx", i, src);
+        emit("movq %%rcx, %i(%%%s)", i, dest);
+    }
+}
+
+// where a constructor is called when the caller already has room for the object, see doc/function_label_format.txt
+static char* stack_constructor_label(char* label)
+{
+    char* stack_label = strdup(label);
+    strchr(stack_label, '@')[1] = 's';
+    return stack_label;
+}
+
 static void emit_func_definition(emitter_t* e, ast_node_t* func_definition, ast_node_t* blueprint)
 {
     if (func_definition->lowlvl_label)
         return;
     emit_noindent("%s:", func_definition->func_label);
+    bool heap_constructor = func_definition->func_type == 'c' && !isvaluetype(func_definition->datatype);
+    char* stack_label = NULL;
+    if (heap_constructor)
+    {
+        // rax is the object's room through the stack entry, and 0 (make one) through the usual one
+        stack_label = stack_constructor_label(func_definition->func_label);
+        emit("xorl %%eax, %%eax");
+        emit_noindent("%s:", stack_label);
+    }
     emit("pushq %%rbp");
     emit("movq %%rsp, %%rbp");
-    int stackalloc = find_stackalloc(func_definition->local_variables);
-    emit("subq $%i, %%rsp", func_definition->unsafe < 0 ? stackalloc : func_definition->unsafe);
-    for (int i = 0; i < min(func_definition->params->size, 4); i++)
+    e->checked = options && options->bounds_check && func_definition->unsafe == -2;
+    e->bounds_fails->size = 0;
+    e->ymm = false;
+    int stackalloc = find_stackalloc(func_definition);
+    e->frame_size = func_definition->unsafe < 0 ? stackalloc : func_definition->unsafe;
+    emit("subq $%i, %%rsp", e->frame_size);
+    bool result_arg = isvaluetype(func_definition->datatype);
+    if (result_arg)
+        emit("movq %%rcx, 16(%%rbp)");
+    for (int i = 0; i < func_definition->params->size; i++)
     {
         ast_node_t* param = (ast_node_t*) vector_get(func_definition->params, i);
-        if (isfloattype(param->datatype->type))
-            emit("movs%c %%xmm%i, %i(%%rbp)", floatsize(param->datatype->size), i, 16 + (i * 8));
+        int reg = (param->voffset - 16) / 8;
+        if (reg >= 4)
+            break;
+        if (param->datatype->type == DTT_SLICE)
+        {
+            emit("movq %%%s, %i(%%rbp)", find_register(x64cc[reg], 8), param->voffset);
+            emit("movq %%%s, %i(%%rbp)", find_register(x64cc[reg + 1], 8), param->voffset + 8);
+        }
+        else if (param->datatype->type == DTT_SIMD) // too big for its shadow space, the frame keeps it instead
+        {
+            char at[32];
+            param->voffset = -(e->stackoffset = round_up(e->stackoffset + param->datatype->size, 8));
+            sprintf(at, "%i(%%rbp)", param->voffset);
+            emit_simd_store(e, param->datatype, reg, at);
+        }
+        else if (isfloattype(param->datatype->type))
+            emit("movs%c %%xmm%i, %i(%%rbp)", floatsize(param->datatype->size), reg, param->voffset);
         else
-            emit("mov%c %%%s, %i(%%rbp)", int_reg_size(param->datatype->size), find_register(x64cc[i], param->datatype->size), 16 + (i * 8));
+            emit("mov%c %%%s, %i(%%rbp)", int_reg_size(min(param->datatype->size, 8)), find_register(x64cc[reg], min(param->datatype->size, 8)), param->voffset);
     }
     if (!strcmp(func_definition->func_name, "main"))
-    {
-        parser_ensure_cextern(e->p, "__libsgcllc_init", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
         emit("call __libsgcllc_init");
-    }
     if (func_definition->func_type == 'c')
     {
-        emit("movl $%i, %%ecx", blueprint->bp_size);
-        emit("call __libsgcllc_alloc_bytes");
+        if (result_arg)
+            emit("movq 16(%%rbp), %%rax"); // value blueprints are constructed where the caller wants them
+        else
+        {
+            char* has_room = emitter_make_label(e);
+            emit("testq %%rax, %%rax");
+            emit("jnz %s", has_room);
+            emit("movl $%i, %%ecx", blueprint->bp_size);
+            emit("call __libsgcllc_alloc_bytes");
+            emit_noindent("%s:", has_room);
+        }
         emit("movq %%rax, -8(%%rbp)");
         emit_lvar_decl(e, vector_get(func_definition->local_variables, 0)); // move forward stackalloc
     }
+    for (int i = 0; i < func_definition->params->size; i++)
+    {
+        // bigger value blueprints come in by address, the callee keeps its own copy
+        ast_node_t* param = (ast_node_t*) vector_get(func_definition->params, i);
+        if (!isvaluetype(param->datatype) || param->datatype->size <= 8)
+            continue;
+        emit("movq %i(%%rbp), %%rax", param->voffset);
+        param->voffset = -(e->stackoffset = round_up(e->stackoffset + param->datatype->size, 8));
+        emit("leaq %i(%%rbp), %%rdx", param->voffset);
+        emit_value_copy(e, "rax", "rdx", param->datatype->size);
+    }
+    for (int i = 0; i < func_definition->local_variables->size; i++)
+    {
+        // results of calls get their slots up front, so they never land on a stashed operand
+        ast_node_t* lvar = vector_get(func_definition->local_variables, i);
+        if (!*lvar->var_name)
+            emit_lvar_decl(e, lvar);
+    }
     for (int i = 0; i < func_definition->body->statements->size; i++)
         emit_stmt(e, vector_get(func_definition->body->statements, i));
     if (func_definition->end_label)
         emit_noindent("%s:", func_definition->end_label);
     if (!strcmp(func_definition->func_name, "main"))
     {
-        parser_ensure_cextern(e->p, "__libsgcllc_gc_finalize", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+        // the exit code has to survive the collector
+        emit("movq %%rax, %%rbx");
         emit("call __libsgcllc_gc_finalize");
+        emit("movq %%rbx, %%rax");
     }
+    // legacy sse instructions after dirty upper halves are slow, unless what's in ymm0 is being returned
+    if (e->ymm && !(func_definition->datatype->type == DTT_SIMD && func_definition->datatype->size == 32))
+        emit("vzeroupper");
     emit("addq $%i, %%rsp", func_definition->unsafe < 0 ? stackalloc : func_definition->unsafe);
     e->stackoffset = 0;
     emit("popq %%rbp");
     emit("ret");
+    // out of the way of the checks, which only fall through
+    for (int i = 0; i < e->bounds_fails->size; i += 3)
+    {
+        char* length = vector_get(e->bounds_fails, i + 2);
+        emit_noindent("%s:", (char*) vector_get(e->bounds_fails, i));
+        if (strcmp(length, "%rdx"))
+            emit("movq %s, %%rdx", length);
+        emit("movq %%%s, %%rcx", (char*) vector_get(e->bounds_fails, i + 1));
+        emit("call __libsgcllc_bounds_fail");
+    }
     emit(".global %s", func_definition->func_label);
+    if (stack_label)
+    {
+        emit(".global %s", stack_label);
+        free(stack_label);
+    }
+}
+
+// a value blueprint variable, and any value blueprint fields of it, sit at a fixed offset from rbp
+static bool value_frame_offset(ast_node_t* node, int* offset)
+{
+    if (node->type == AST_LVAR && isvaluetype(node->datatype))
+    {
+        *offset = node->voffset;
+        return true;
+    }
+    if (node->type == OP_SELECTION && isvaluetype(node->datatype) && value_frame_offset(node->lhs, offset))
+    {
+        *offset += node->rhs->voffset;
+        return true;
+    }
+    return false;
+}
+
+// rax has the address of the value blueprint being assigned, and is left with the address it was copied to
+static void emit_value_assign(emitter_t* e, ast_node_t* op)
+{
+    emitter_stash_int_reg(e, "rax");
+    switch (op->lhs->type)
+    {
+        case AST_LVAR:
+        {
+            emit("leaq %i(%%rbp), %%rax", op->lhs->voffset);
+            break;
+        }
+        case OP_SUBSCRIPT:
+        {
+            emit_subscript(e, op->lhs, false);
+            break;
+        }
+        case OP_SELECTION:
+        {
+            emit_selection(e, op->lhs, false);
+            break;
+        }
+        default:
+            errore(op->loc->row, op->loc->col, "assignment operator cannot be applied to left side of this expression");
+    }
+    emit_value_copy(e, emitter_restore_int_reg(e, 8), "rax", op->lhs->datatype->size);
 }
 
 static bool chk_type_mismatch(datatype_t* lhs, datatype_t* rhs)
 {
     if ((lhs->type == DTT_STRING && rhs->type != DTT_STRING) || (lhs->type != DTT_STRING && rhs->type == DTT_STRING))
         return true;
+    if ((lhs->type == DTT_SLICE) != (rhs->type == DTT_SLICE))
+        return true;
     return false;
 }
 
 static void emit_assign(emitter_t* e, ast_node_t* op)
 {
+    if (isvaluetype(op->lhs->datatype))
+    {
+        emit_value_assign(e, op);
+        return;
+    }
     switch (op->lhs->type)
     {
         case AST_LVAR:
@@ -269,6 +786,17 @@ static void emit_assign(emitter_t* e, ast_node_t* op)
                 errore(op->loc->row, op->loc->col, "type '%i' cannot be assigned to '%i'", op->rhs->datatype->type, op->lhs->datatype->type);
             if (op->lhs->datatype->type == DTT_STRING)
                 emit("movq %%rax, %i(%%rbp)", op->lhs->voffset);
+            else if (op->lhs->datatype->type == DTT_SLICE)
+            {
+                emit("movq %%rax, %i(%%rbp)", op->lhs->voffset);
+                emit("movq %%rdx, %i(%%rbp)", op->lhs->voffset + 8);
+            }
+            else if (op->lhs->datatype->type == DTT_SIMD)
+            {
+                char at[32];
+                sprintf(at, "%i(%%rbp)", op->lhs->voffset);
+                emit_simd_store(e, op->lhs->datatype, 0, at);
+            }
             else if (isfloattype(op->lhs->datatype->type))
                 emit("movs%c %%xmm0, %i(%%rbp)", floatsize(op->lhs->datatype->size), op->lhs->voffset);
             else
@@ -294,6 +822,16 @@ static void emit_assign(emitter_t* e, ast_node_t* op)
         {
             if (chk_type_mismatch(op->lhs->datatype, op->rhs->datatype))
                 errore(op->loc->row, op->loc->col, "type '%i' cannot be assigned to '%i'", op->rhs->datatype->type, op->lhs->datatype->type);
+            int offset;
+            if (value_frame_offset(op->lhs->lhs, &offset))
+            {
+                offset += op->lhs->rhs->voffset;
+                if (isfloattype(op->lhs->datatype->type))
+                    emit("movs%c %%xmm0, %i(%%rbp)", floatsize(op->lhs->datatype->size), offset);
+                else
+                    emit("mov%c %%%s, %i(%%rbp)", int_reg_size(op->lhs->datatype->size), find_register(REG_A, op->lhs->datatype->size), offset);
+                break;
+            }
             if (isfloattype(op->lhs->datatype->type))
                 emitter_stash_float_reg(e, find_register(REG_FLOAT, 8), op->lhs->datatype->size);
             else
@@ -305,6 +843,20 @@ static void emit_assign(emitter_t* e, ast_node_t* op)
                 emit("mov%c %%%s, (%%rax)", int_reg_size(op->lhs->datatype->size), emitter_restore_int_reg(e, op->lhs->datatype->size));
             break;
         }
+        // a[i:] = v writes over as many elements as v has lanes
+        case OP_SLICE:
+        {
+            datatype_t* dt = op->rhs->datatype;
+            emitter_stash_simd_reg(e, dt);
+            emit_slice(e, op->lhs);
+            if (e->checked)
+            {
+                emit("movq $%i, %%rcx", dt->size / dt->array_type->size - 1);
+                emit_bounds_check(e, "rcx", "%rdx");
+            }
+            emit_simd_store(e, dt, emitter_restore_simd_reg(e), "(%rax)");
+            break;
+        }
         default:
             errore(op->loc->row, op->loc->col, "assignment operator cannot be applied to left side of this expression");
     }
@@ -312,13 +864,20 @@ static void emit_assign(emitter_t* e, ast_node_t* op)
 
 static void emit_lvar_decl(emitter_t* e, ast_node_t* lvar)
 {
-    lvar->voffset = -(e->stackoffset = round_up(e->stackoffset + lvar->datatype->size, lvar->datatype->size));
+    int align = min(lvar->datatype->size, 8);
+    lvar->voffset = -(e->stackoffset = round_up(e->stackoffset + lvar->datatype->size, align));
     if (lvar->vinit)
         emit_expr(e, lvar->vinit);
 }
 
 static void emit_conv(emitter_t* e, datatype_t* src, datatype_t* dest)
 {
+    if (src->type == DTT_OBJECT || dest->type == DTT_OBJECT) // value blueprints are addressed, not converted
+        return;
+    if (src->type == DTT_SLICE || dest->type == DTT_SLICE)
+        return;
+    if (src->type == DTT_SIMD || dest->type == DTT_SIMD) // see emit_simd_cast
+        return;
     int src_size = src->size, dest_size = dest->size;
     bool src_float = isfloattype(src->type), dest_float = isfloattype(dest->type);
     if (dest_size <= src_size && !src_float && !dest_float)
@@ -341,17 +900,32 @@ static void emit_conv(emitter_t* e, datatype_t* src, datatype_t* dest)
 static void emit_make(emitter_t* e, ast_node_t* make)
 {
     datatype_t* dt = make->datatype;
+    if (make->make_storage) // laid out like __libsgcllc_dynamic_array, the length and then the elements
+    {
+        emit("leaq %i(%%rbp), %%rax", make->make_storage->voffset);
+        emit("movq $%lli, (%%rax)", dt->length->ivalue);
+        emit("addq $8, %%rax");
+        return;
+    }
+    if (make->make_soa_blueprint)
+    {
+        emit_expr(e, dt->length);
+        emit_conv(e, dt->length->datatype, t_i64);
+        emit("movq %%rax, %%rcx");
+        emit("movl $%i, %%edx", make->make_soa_blueprint->bp_size);
+        emit("call __libsgcllc_soa_array");
+        return;
+    }
     emit("movl $%i, %%edx", dt->depth);
     datatype_t* current = dt;
     for (int i = 0; i < dt->depth; i++, current = current->array_type)
     {
         emit_expr(e, current->length);
+        emit_conv(e, current->length->datatype, t_i64); // the runtime reads every length as 64 bits
         if (i >= 2)
-            emit("mov%c %%%s, %i(%%rsp)", int_reg_size(current->length->datatype->size),
-                find_register(REG_A, current->length->datatype->type), 32 + 8 * (i - 2));
+            emit("movq %%rax, %i(%%rsp)", 32 + 8 * (i - 2));
         else
-            emit("mov%c %%%s, %%%s", int_reg_size(current->length->datatype->size),
-                find_register(REG_A, current->length->datatype->type), find_register(x64cc[i + 2], current->length->datatype->type));
+            emit("movq %%rax, %%%s", find_register(x64cc[i + 2], 8));
     }
     emit("movl $%i, %%ecx", current->size);
     emit("call __libsgcllc_dynamic_ndim_array");
@@ -359,7 +933,7 @@ static void emit_make(emitter_t* e, ast_node_t* make)
 
 static void emit_binary_op(emitter_t* e, ast_node_t* lhs, ast_node_t* rhs, datatype_t* agreed_type)
 {
-    if (lhs->type == AST_FUNC_CALL) // bandaid patch
+    if (lhs->type == AST_FUNC_CALL || lhs->type == OP_SPAWN) // bandaid patch
     {
         emit_expr(e, lhs);
         emit_conv(e, lhs->datatype, agreed_type);
@@ -426,14 +1000,14 @@ static void emit_float_add_sub_mul_div(emitter_t* e, ast_node_t* op)
             errore(op->loc->row, op->loc->col, "operator %i does not exist or cannot be applied to a floating type", op->type);
     }
     emit_binary_op(e, lhs, rhs, op->datatype);
-    char* restored = emitter_restore_float_reg(e, op->datatype->size);
-    emit("%ss%c %%%s, %%%s", operation, floatsize(op->datatype->size), restored, find_register(REG_FLOAT, 8));
-    free(restored);
+    emit("%ss%c %%%s, %%%s", operation, floatsize(op->datatype->size), emitter_restore_float_reg(e, op->datatype->size), find_register(REG_FLOAT, 8));
 }
 
 static void emit_add_sub(emitter_t* e, ast_node_t* op)
 {
-    if (!isfloattype(op->datatype->type))
+    if (op->datatype->type == DTT_SIMD)
+        emit_simd_op(e, op);
+    else if (!isfloattype(op->datatype->type))
         emit_int_add_sub(e, op);
     else
         emit_float_add_sub_mul_div(e, op);
@@ -465,7 +1039,9 @@ static void emit_int_mul_div(emitter_t* e, ast_node_t* op)
 
 static void emit_mul_div(emitter_t* e, ast_node_t* op)
 {
-    if (!isfloattype(op->datatype->type))
+    if (op->datatype->type == DTT_SIMD)
+        emit_simd_op(e, op);
+    else if (!isfloattype(op->datatype->type))
         emit_int_mul_div(e, op);
     else
         emit_float_add_sub_mul_div(e, op);
@@ -473,6 +1049,11 @@ static void emit_mul_div(emitter_t* e, ast_node_t* op)
 
 static void emit_conditional(emitter_t* e, ast_node_t* op)
 {
+    if (op->lhs->datatype->type == DTT_SIMD)
+    {
+        emit_simd_op(e, op);
+        return;
+    }
     ast_node_t* lhs = op->lhs, * rhs = op->rhs;
     datatype_t* agreed_type = arith_conv(lhs->datatype, rhs->datatype);
     char* operation = NULL;
@@ -496,7 +1077,9 @@ static void emit_conditional(emitter_t* e, ast_node_t* op)
     else
         emit("comis%c %%%s, %%xmm0", floatsize(agreed_type->size), emitter_restore_float_reg(e, agreed_type->size));
     emit("%s %%%s", operation, regAb);
-    emit("movzb%c %%%s, %%%s", int_reg_size(agreed_type->size), regAb, regA);
+    // comparing bytes (bools) already leaves the result in the right register
+    if (agreed_type->size != 1)
+        emit("movzb%c %%%s, %%%s", int_reg_size(agreed_type->size), regAb, regA);
 }
 
 static void emit_logical_and(emitter_t* e, ast_node_t* op)
@@ -504,13 +1087,13 @@ static void emit_logical_and(emitter_t* e, ast_node_t* op)
     ast_node_t* lhs = op->lhs, * rhs = op->rhs;
     char* regA = find_register(REG_A, 1);
     emit_binary_op(e, lhs, rhs, t_bool);
-    char* fail = make_label(e->p, NULL);
+    char* fail = emitter_make_label(e);
     emit("cmpb $0, %%al");
     emit("je %s", fail);
     emit("cmpb $0, %%%s", emitter_restore_int_reg(e, 1));
     emit("je %s", fail);
     emit("movb $1, %%al");
-    char* success = make_label(e->p, NULL);
+    char* success = emitter_make_label(e);
     emit("jmp %s", success);
     emit_noindent("%s:", fail);
     emit("movb $0, %%al");
@@ -522,15 +1105,15 @@ static void emit_logical_or(emitter_t* e, ast_node_t* op)
     ast_node_t* lhs = op->lhs, * rhs = op->rhs;
     char* regA = find_register(REG_A, 1);
     emit_binary_op(e, lhs, rhs, t_bool);
-    char* success = make_label(e->p, NULL);
+    char* success = emitter_make_label(e);
     emit("cmpb $0, %%al");
     emit("jne %s", success);
     emit("cmpb $0, %%%s", emitter_restore_int_reg(e, 1));
-    char* fail = make_label(e->p, NULL);
+    char* fail = emitter_make_label(e);
     emit("je %s", fail);
     emit_noindent("%s:", success);
     emit("movb $1, %%al");
-    char* skip = make_label(e->p, NULL);
+    char* skip = emitter_make_label(e);
     emit("jmp %s", skip);
     emit_noindent("%s:", fail);
     emit("movb $0, %%al");
@@ -547,24 +1130,29 @@ static void emit_logical_not(emitter_t* e, ast_node_t* op)
 
 static void emit_minus(emitter_t* e, ast_node_t* op)
 {
-    if (!isfloattype(op->operand->datatype->type))
+    if (op->datatype->type == DTT_SIMD)
+        emit_simd_op(e, op);
+    else if (!isfloattype(op->operand->datatype->type))
     {
         emit_expr(e, op->operand);
         emit("not%c %%%s", int_reg_size(op->datatype->size), find_register(REG_A, op->datatype->size));
     }
     else
     {
-        if (!e->fp_negate_label) e->fp_negate_label = make_label(e->p, "-0.0");
-        emit("movsd %s(%%rip), %%xmm0", e->fp_negate_label);
-        emit_conv(e, t_f64, op->operand->datatype);
-        emit("movs%c %%xmm0, %%xmm1", floatsize(op->operand->datatype->size));
+        // flips the sign bit of every lane
+        unsigned long long mask = op->operand->datatype->size == 4 ? 0x8000000080000000ULL : 0x8000000000000000ULL;
         emit_expr(e, op->operand);
-        emit("xorp%c %%xmm1, %%xmm0", floatsize(op->operand->datatype->size));
+        emit("xorp%c %s(%%rip), %%xmm0", floatsize(op->operand->datatype->size), emitter_constant(e, constant_init(CONSTANT_XMM, NULL, mask, mask)));
     }
 }
 
 static void emit_complement(emitter_t* e, ast_node_t* op)
 {
+    if (op->datatype->type == DTT_SIMD)
+    {
+        emit_simd_op(e, op);
+        return;
+    }
     emit_expr(e, op->operand);
     emit("not%c %%%s", int_reg_size(op->datatype->size), find_register(REG_A, op->datatype->size));
 }
@@ -592,25 +1180,72 @@ static void emit_shift(emitter_t* e, ast_node_t* op)
     emit("movq %%%s, %%rcx", emitter_restore_int_reg(e, 8));
 }
 
+// unless the function is unsafe, or range.c proved it in bounds for the copy of the loop being emitted
+static bool emitter_checks(emitter_t* e, ast_node_t* subscript)
+{
+    return e->checked && !(subscript->subscript_guard && subscript->subscript_guard->for_fast);
+}
+
+// unsigned, so a negative index is out of bounds too
+static void emit_bounds_check(emitter_t* e, char* index, char* length)
+{
+    char* fail = emitter_make_label(e);
+    emit("cmpq %s, %%%s", length, index);
+    emit("jae %s", fail);
+    vector_push(e->bounds_fails, fail);
+    vector_push(e->bounds_fails, index);
+    vector_push(e->bounds_fails, length);
+}
+
 static void emit_subscript(emitter_t* e, ast_node_t* op, bool deref)
 {
+    if (op->lhs->datatype->type == DTT_ARRAY && op->lhs->datatype->soa)
+        errore(op->loc->row, op->loc->col, "soa arrays have no blueprints to subscript, only their instance variables");
     char* regA = "rax";
+    bool slice = op->lhs->datatype->type == DTT_SLICE;
+    bool check = emitter_checks(e, op);
     emit_expr(e, op->rhs);
     emit_conv(e, op->rhs->datatype, t_i64);
+    if (op->lhs->datatype->type == DTT_SIMD) // a lane of a variable in the frame
+    {
+        datatype_t* dt = op->lhs->datatype;
+        if (check)
+        {
+            char* lanes = malloc(16);
+            sprintf(lanes, "$%i", dt->size / dt->array_type->size);
+            emit_bounds_check(e, regA, lanes);
+        }
+        emit("leaq %i(%%rbp,%%rax,%i), %%rax", op->lhs->voffset, dt->array_type->size);
+        if (deref)
+        {
+            if (!isfloattype(op->datatype->type))
+                emit("mov%c (%%rax), %%%s", int_reg_size(op->datatype->size), find_register(REG_A, op->datatype->size));
+            else
+                emit("movs%c (%%rax), %%xmm0", floatsize(op->datatype->size));
+        }
+        return;
+    }
     emitter_stash_int_reg(e, regA);
     switch (op->lhs->type)
     {
         case AST_LVAR:
         {
             emit("movq %i(%%rbp), %%%s", op->lhs->voffset, regA);
+            if (check && slice)
+                emit("movq %i(%%rbp), %%rdx", op->lhs->voffset + 8);
             break;
         }
+        // a[i][j] subscripts whatever a[i] loaded
+        default:
+            emit_expr(e, op->lhs);
     }
     char* regIndex = emitter_restore_int_reg(e, 8);
-    if (op->lhs->datatype->type == DTT_ARRAY)
+    if (check) // slices have their length in rdx, arrays and strings in front of their elements
+        emit_bounds_check(e, regIndex, slice ? "%rdx" : "-8(%rax)");
+    if (op->lhs->datatype->type == DTT_ARRAY || slice)
         emit("imulq $%i, %%%s, %%%s", op->lhs->datatype->array_type->size, regIndex, regIndex);
     emit("addq %%%s, %%%s", regIndex, regA);
-    if (deref)
+    if (deref && !isvaluetype(op->datatype)) // value blueprints stay where they are in the array
     {
         if (!isfloattype(op->datatype->type))
             emit("mov%c (%%%s), %%%s", int_reg_size(op->datatype->size), regA, find_register(REG_A, op->datatype->size));
@@ -619,19 +1254,130 @@ static void emit_subscript(emitter_t* e, ast_node_t* op, bool deref)
     }
 }
 
-static void emit_selection(emitter_t* e, ast_node_t* op, bool deref)
+// a slice is its pointer in rax and its length in rdx
+static void emit_slice(emitter_t* e, ast_node_t* slice)
 {
+    bool check = e->checked;
+    if (slice->slice_hi)
+    {
+        emit_expr(e, slice->slice_hi);
+        emit_conv(e, slice->slice_hi->datatype, t_i64);
+        emitter_stash_int_reg(e, "rax");
+    }
+    emit_expr(e, slice->slice_lo);
+    emit_conv(e, slice->slice_lo->datatype, t_i64);
+    emitter_stash_int_reg(e, "rax");
+    emit_expr(e, slice->slice_base);
+    if (!slice->slice_hi || check)
+    {
+        switch (slice->slice_base->datatype->type)
+        {
+            // arrays and strings both keep their length right in front
+            case DTT_ARRAY:
+            case DTT_STRING:
+            {
+                emit("movq -8(%%rax), %%rdx");
+                break;
+            }
+        }
+    }
+    char* lo = emitter_restore_int_reg(e, 8);
+    char* hi = slice->slice_hi ? emitter_restore_int_reg(e, 8) : "rdx";
+    if (check) // 0 <= lo <= hi <= length, compared unsigned so negative bounds fail too
+    {
+        char* fail = emitter_make_label(e);
+        char* in_bounds = emitter_make_label(e);
+        emit("cmpq %%rdx, %%%s", hi);
+        emit("ja %s", fail);
+        emit("cmpq %%%s, %%%s", hi, lo);
+        emit("jbe %s", in_bounds);
+        emit_noindent("%s:", fail);
+        emit("movq %%rdx, %%r8");
+        emit("movq %%%s, %%rdx", hi);
+        emit("movq %%%s, %%rcx", lo);
+        emit("call __libsgcllc_slice_fail");
+        emit_noindent("%s:", in_bounds);
+    }
+    if (slice->slice_hi)
+        emit("movq %%%s, %%rdx", hi);
+    emit("subq %%%s, %%rdx", lo);
+    int width = slice->datatype->array_type->size;
+    if (width == 1 || width == 2 || width == 4 || width == 8)
+        emit("leaq (%%rax,%%%s,%i), %%rax", lo, width);
+    else
+    {
+        emit("imulq $%i, %%%s, %%%s", width, lo, lo);
+        emit("addq %%%s, %%rax", lo);
+    }
+}
+
+// ps[i].x in a soa array is element i of column x, columns are length elements apart from each other
+static void emit_soa_selection(emitter_t* e, ast_node_t* op, bool deref)
+{
+    ast_node_t* subscript = op->lhs;
+    emit_expr(e, subscript->rhs);
+    emit_conv(e, subscript->rhs->datatype, t_i64);
+    emitter_stash_int_reg(e, "rax");
+    emit_expr(e, subscript->lhs);
+    char* regIndex = emitter_restore_int_reg(e, 8);
+    if (emitter_checks(e, subscript))
+        emit_bounds_check(e, regIndex, "-8(%rax)");
+    if (op->rhs->voffset)
+    {
+        emit("imulq $%i, -8(%%rax), %%rcx", op->rhs->voffset);
+        emit("addq %%rcx, %%rax");
+    }
+    int width = op->datatype->size;
+    if (width != 1 && width != 2 && width != 4 && width != 8)
+    {
+        emit("imulq $%i, %%%s, %%%s", width, regIndex, regIndex);
+        width = 1;
+    }
+    if (!deref || isvaluetype(op->datatype))
+        emit("leaq (%%rax,%%%s,%i), %%rax", regIndex, width);
+    else if (!isfloattype(op->datatype->type))
+        emit("mov%c (%%rax,%%%s,%i), %%%s", int_reg_size(op->datatype->size), regIndex, width, find_register(REG_A, op->datatype->size));
+    else
+        emit("movs%c (%%rax,%%%s,%i), %%xmm0", floatsize(op->datatype->size), regIndex, width);
+}
+
+static void emit_selection(emitter_t* e, ast_node_t* op, bool deref)
+{
+    if (op->lhs->type == OP_SUBSCRIPT && op->lhs->lhs->datatype->type == DTT_ARRAY && op->lhs->lhs->datatype->soa)
+    {
+        emit_soa_selection(e, op, deref);
+        return;
+    }
+    int offset;
+    if (value_frame_offset(op->lhs, &offset))
+    {
+        offset += op->rhs->voffset;
+        if (!deref || isvaluetype(op->datatype))
+            emit("leaq %i(%%rbp), %%rax", offset);
+        else if (!isfloattype(op->datatype->type))
+            emit("mov%c %i(%%rbp), %%%s", int_reg_size(op->datatype->size), offset, find_register(REG_A, op->datatype->size));
+        else
+            emit("movs%c %i(%%rbp), %%xmm0", floatsize(op->datatype->size), offset);
+        return;
+    }
     switch (op->lhs->type)
     {
         case AST_LVAR:
         {
             emit("movq %i(%%rbp), %%rax", op->lhs->voffset);
+            if (op->rhs->voffset)
+                emit("leaq %i(%%rax), %%rax", op->rhs->voffset);
             break;
         }
+        // a.b.c selects from whatever a.b left in rax
+        default:
+        {
+            emit_expr(e, op->lhs);
+            if (op->rhs->voffset)
+                emit("leaq %i(%%rax), %%rax", op->rhs->voffset);
+        }
     }
-    if (op->rhs->voffset)
-        emit("leaq %i(%%rax), %%rax", op->rhs->voffset);
-    if (deref)
+    if (deref && !isvaluetype(op->datatype))
     {
         if (!isfloattype(op->datatype->type))
             emit("mov%c (%%rax), %%%s", int_reg_size(op->datatype->size), find_register(REG_A, op->datatype->size));
@@ -640,42 +1386,147 @@ static void emit_selection(emitter_t* e, ast_node_t* op, bool deref)
     }
 }
 
+// slices take two registers, so where an argument goes depends on the ones before it
+static int arg_register(ast_node_t* func, int index)
+{
+    int reg = 0;
+    for (int i = 0; i < index; i++)
+        reg += ((ast_node_t*) vector_get(func->params, i))->datatype->type == DTT_SLICE ? 2 : 1;
+    return reg;
+}
+
 static void emit_func_call(emitter_t* e, ast_node_t* call)
 {
+    bool result_arg = call->call_result != NULL; // takes the first register
     for (int i = call->args->size - 1; i >= 0; i--)
     {
         ast_node_t* arg = vector_get(call->args, i);
-        if (i >= 4)
+        datatype_t* param_dt = ((ast_node_t*) vector_get(call->func->params, i))->datatype;
+        int reg = arg_register(call->func, i) + result_arg;
+        if (reg + (param_dt->type == DTT_SLICE) >= 4)
             errore(call->loc->row, call->loc->col, "function calls with 4+ arguments are not supported yet");
         else
         {
             emit_expr(e, arg);
-            if (arg->datatype->type == DTT_STRING || arg->datatype->type == DTT_OBJECT)
-                emit("movq %%rax, %%%s", find_register(x64cc[i], 8));
+            if (param_dt->type == DTT_SLICE) // the length first, the pointer's register might be rdx
+            {
+                emit("movq %%rdx, %%%s", find_register(x64cc[reg + 1], 8));
+                emit("movq %%rax, %%%s", find_register(x64cc[reg], 8));
+            }
+            else if (isvaluetype(param_dt) && param_dt->size <= 8) // small enough to go in the register itself
+                emit("movq (%%rax), %%%s", find_register(x64cc[reg], 8));
+            else if (arg->datatype->type == DTT_STRING || arg->datatype->type == DTT_OBJECT)
+                emit("movq %%rax, %%%s", find_register(x64cc[reg], 8));
+            else if (arg->datatype->type == DTT_SIMD)
+            {
+                if (reg)
+                    emit_simd_copy(e, arg->datatype, 0, reg);
+            }
             else if (isfloattype(arg->datatype->type))
             {
-                if (i)
-                    emit("movs%c %%xmm0, %%xmm%i", floatsize(arg->datatype->size), i);
+                if (reg)
+                    emit("movs%c %%xmm0, %%xmm%i", floatsize(arg->datatype->size), reg);
             }
             else
-                emit("mov%c %%%s, %%%s", int_reg_size(arg->datatype->size), find_register(REG_A, arg->datatype->size), find_register(x64cc[i], arg->datatype->size));
+                emit("mov%c %%%s, %%%s", int_reg_size(arg->datatype->size), find_register(REG_A, arg->datatype->size), find_register(x64cc[reg], arg->datatype->size));
         }
     }
+    if (result_arg)
+        emit("leaq %i(%%rbp), %%rcx", call->call_result->voffset);
+    if (call->call_storage) // the object doesn't escape, so it's built in the frame
+    {
+        char* stack_label = stack_constructor_label(call->func->func_label);
+        emit("leaq %i(%%rbp), %%rax", call->call_storage->voffset);
+        emit("call %s", stack_label);
+        free(stack_label);
+        return;
+    }
     emit("call %s", call->func->lowlvl_label != NULL ? call->func->lowlvl_label : call->func->func_label);
 }
 
+static char* spawn_kept[] = { "rbx", "rsi", "rdi", "r12", "r13", "r14", "r15" };
+
+// the arguments are gathered in the frame, the runtime hands a copy of them to a stub that puts them back in registers
+// and makes the call on the new thread. integers come back out of it for join
+static void emit_spawn(emitter_t* e, ast_node_t* spawn)
+{
+    ast_node_t* call = spawn->operand;
+    ast_node_t* func = call->func;
+    int block = spawn->spawn_block->voffset;
+    for (int i = 0; i < call->args->size; i++)
+    {
+        ast_node_t* arg = vector_get(call->args, i);
+        datatype_t* param_dt = ((ast_node_t*) vector_get(func->params, i))->datatype;
+        int at = block + arg_register(func, i) * 8;
+        emit_expr(e, arg);
+        if (param_dt->type == DTT_SLICE)
+        {
+            emit("movq %%rax, %i(%%rbp)", at);
+            emit("movq %%rdx, %i(%%rbp)", at + 8);
+        }
+        else if (isfloattype(arg->datatype->type))
+            emit("movs%c %%xmm0, %i(%%rbp)", floatsize(arg->datatype->size), at);
+        else
+            emit("mov%c %%%s, %i(%%rbp)", int_reg_size(arg->datatype->size), find_register(REG_A, arg->datatype->size), at);
+    }
+    char* entry = emitter_make_label(e);
+    char* skip = emitter_make_label(e);
+    emit("jmp %s", skip);
+    emit_noindent("%s:", entry);
+    emit("pushq %%rbp");
+    emit("movq %%rsp, %%rbp");
+    // functions here use the registers windows has callees keep as they like, the runtime calling in expects them back
+    for (int i = 0; i < sizeof(spawn_kept) / sizeof(char*); i++)
+        emit("pushq %%%s", spawn_kept[i]);
+    emit("subq $200, %%rsp");
+    for (int i = 6; i < 16; i++)
+        emit("movdqu %%xmm%i, %i(%%rsp)", i, 32 + (i - 6) * 16);
+    emit("movq %%rcx, %%rax");
+    for (int i = 0; i < func->params->size; i++)
+    {
+        datatype_t* param_dt = ((ast_node_t*) vector_get(func->params, i))->datatype;
+        int reg = arg_register(func, i);
+        if (param_dt->type == DTT_SLICE)
+        {
+            emit("movq %i(%%rax), %%%s", reg * 8, find_register(x64cc[reg], 8));
+            emit("movq %i(%%rax), %%%s", reg * 8 + 8, find_register(x64cc[reg + 1], 8));
+        }
+        else if (isfloattype(param_dt->type))
+            emit("movs%c %i(%%rax), %%xmm%i", floatsize(param_dt->size), reg * 8, reg);
+        else
+            emit("mov%c %i(%%rax), %%%s", int_reg_size(param_dt->size), reg * 8, find_register(x64cc[reg], param_dt->size));
+    }
+    emit("call %s", func->lowlvl_label != NULL ? func->lowlvl_label : func->func_label);
+    if (func->datatype->type == DTT_VOID || isfloattype(func->datatype->type))
+        emit("xorl %%eax, %%eax");
+    else
+        emit_conv(e, func->datatype, t_i64);
+    for (int i = 6; i < 16; i++)
+        emit("movdqu %i(%%rsp), %%xmm%i", 32 + (i - 6) * 16, i);
+    emit("leaq -%i(%%rbp), %%rsp", (int) sizeof(spawn_kept) / (int) sizeof(char*) * 8);
+    for (int i = sizeof(spawn_kept) / sizeof(char*) - 1; i >= 0; i--)
+        emit("popq %%%s", spawn_kept[i]);
+    emit("popq %%rbp");
+    emit("ret");
+    emit_noindent("%s:", skip);
+    emit("leaq %s(%%rip), %%rcx", entry);
+    emit("leaq %i(%%rbp), %%rdx", block);
+    emit("movl $%i, %%r8d", spawn->spawn_block->datatype->size);
+    emit("call __libsgcllc_thread_spawn");
+}
+
 static void emit_if_statement(emitter_t* e, ast_node_t* stmt)
 {
     emit_expr(e, stmt->if_cond);
     emit("cmp%c $0, %%%s", int_reg_size(stmt->if_cond->datatype->size), find_register(REG_A, stmt->if_cond->datatype->size));
-    char* skip = make_label(e->p, NULL);
+    char* skip = emitter_make_label(e);
     emit("je %s", skip);
     for (int i = 0; i < stmt->if_then->statements->size; i++)
         emit_stmt(e, vector_get(stmt->if_then->statements, i));
     bool els_exists = stmt->if_els->statements->size;
     if (els_exists)
     {
-        char* skip_els = make_label(e->p, NULL);
+        char* skip_els = emitter_make_label(e);
         emit("jmp %s", skip_els);
         emit_noindent("%s:", skip);
         for (int i = 0; i < stmt->if_els->statements->size; i++)
@@ -688,9 +1539,9 @@ static void emit_if_statement(emitter_t* e, ast_node_t* stmt)
 
 static void emit_while_statement(emitter_t* e, ast_node_t* stmt)
 {
-    char* check_cond = make_label(e->p, NULL);
+    char* check_cond = emitter_make_label(e);
     emit("jmp %s", check_cond);
-    char* loop = make_label(e->p, NULL);
+    char* loop = emitter_make_label(e);
     emit_noindent("%s:", loop);
     for (int i = 0; i < stmt->while_then->statements->size; i++)
         emit_stmt(e, vector_get(stmt->while_then->statements, i));
@@ -700,12 +1551,611 @@ static void emit_while_statement(emitter_t* e, ast_node_t* stmt)
     emit("jne %s", loop);
 }
 
-static void emit_for_statement(emitter_t* e, ast_node_t* stmt)
+// emits op on the vector registers src and dst into dst, the avx forms take both and leave dst's old value alone
+static void emit_vector_op(emitter_t* e, char* mnemonic, int src, int dst, bool wide)
 {
-    emit_stmt(e, stmt->for_init);
-    char* check_cond = make_label(e->p, NULL);
+    char r = wide ? 'y' : 'x';
+    if (options->avx2)
+        emit("v%s %%%cmm%i, %%%cmm%i, %%%cmm%i", mnemonic, r, src, r, dst, r, dst);
+    else
+        emit("%s %%xmm%i, %%xmm%i", mnemonic, src, dst);
+}
+
+// puts the element at offset off(%rbp) in the bottom lane of reg, or rax's when there's no offset
+static void emit_vector_scalar(emitter_t* e, datatype_type element, char* from, int reg)
+{
+    bool size4 = element == DTT_F32 || element == DTT_I32;
+    char* mnemonic = *from == '%' ? (size4 ? "movd" : "movq") : element == DTT_F64 ? "movsd" : element == DTT_F32 ? "movss" : size4 ? "movd" : "movq";
+    emit("%s%s %s, %%xmm%i", options->avx2 ? "v" : "", mnemonic, from, reg);
+}
+
+// copies the bottom lane of reg into every other one
+static void emit_vector_broadcast(emitter_t* e, datatype_type element, int reg)
+{
+    if (options->avx2)
+    {
+        char* mnemonic = element == DTT_F64 ? "vbroadcastsd" : element == DTT_F32 ? "vbroadcastss" : element == DTT_I32 ? "vpbroadcastd" : "vpbroadcastq";
+        emit("%s %%xmm%i, %%ymm%i", mnemonic, reg, reg);
+    }
+    else if (element == DTT_F64)
+        emit("unpcklpd %%xmm%i, %%xmm%i", reg, reg);
+    else if (element == DTT_F32)
+        emit("shufps $0, %%xmm%i, %%xmm%i", reg, reg);
+    else if (element == DTT_I32)
+        emit("pshufd $0, %%xmm%i, %%xmm%i", reg, reg);
+    else
+        emit("punpcklqdq %%xmm%i, %%xmm%i", reg, reg);
+}
+
+// spreads a variable or literal out of vectorize.c's invariants across reg
+static void emit_vector_invariant(emitter_t* e, datatype_t* element, ast_node_t* leaf, int reg)
+{
+    char from[32];
+    if (leaf->type == AST_LVAR)
+        sprintf(from, "%i(%%rbp)", leaf->voffset);
+    else
+    {
+        long long bits = leaf->type == AST_ILITERAL ? leaf->ivalue : 0;
+        if (element->type == DTT_F64)
+        {
+            double value = leaf->type == AST_ILITERAL ? (double) leaf->ivalue : leaf->fvalue;
+            memcpy(&bits, &value, 8);
+        }
+        else if (element->type == DTT_F32)
+        {
+            float value = leaf->type == AST_ILITERAL ? (float) leaf->ivalue : (float) leaf->fvalue;
+            int word;
+            memcpy(&word, &value, 4);
+            bits = (unsigned) word;
+        }
+        emit("movabsq $%lli, %%rax", bits);
+        sprintf(from, "%%%s", find_register(REG_A, max(element->size, 4)));
+    }
+    emit_vector_scalar(e, element->type, from, reg);
+    emit_vector_broadcast(e, element->type, reg);
+}
+
+static void emit_vector_value(emitter_t* e, vector_loop_t* vl, int* registers, ast_node_t* value, int reg)
+{
+    char r = options->avx2 ? 'y' : 'x';
+    char* move = vector_mnemonic(vl->element->type, OP_ASSIGN);
+    if (value->type == OP_SUBSCRIPT)
+    {
+        int array = 0;
+        while (vector_get(vl->arrays, array) != value->lhs)
+            array++;
+        emit("%s%s (%%r%i,%%rcx,%i), %%%cmm%i", options->avx2 ? "v" : "", move, array + 8, vl->element->size, r, reg);
+        return;
+    }
+    if (value->type == AST_LVAR || value->type == AST_ILITERAL || value->type == AST_FLITERAL)
+    {
+        int invariant = 0;
+        while (!vector_same(vector_get(vl->invariants, invariant), value))
+            invariant++;
+        if (registers[invariant] >= 0)
+            emit("%smovaps %%%cmm%i, %%%cmm%i", options->avx2 ? "v" : "", r, registers[invariant], r, reg);
+        else
+            emit_vector_invariant(e, vl->element, value, reg);
+        return;
+    }
+    emit_vector_value(e, vl, registers, value->lhs, reg);
+    emit_vector_value(e, vl, registers, value->rhs, reg + 1);
+    emit_vector_op(e, vector_mnemonic(vl->element->type, value->type), reg + 1, reg, true);
+}
+
+// the iterations of a loop from vectorize.c that fill a register go first, the loop after it finishes the rest off.
+// i counts in rcx against the bound minus a register's worth of lanes in rdx, the arrays' elements start at r8-r11,
+// sums, mins and maxes are kept in xmm0 up, values are worked out above them, and invariants get what's left
+static void emit_vector_loop(emitter_t* e, ast_node_t* stmt)
+{
+    vector_loop_t* vl = stmt->for_vector;
+    datatype_type element = vl->element->type;
+    ast_node_t* var = stmt->for_cond->lhs;
+    int lanes = vector_lanes(vl->element), reductions = 0;
+    bool wide = options->avx2;
+    char r = wide ? 'y' : 'x';
+    for (int i = 0; i < vl->stmts->size; i++)
+        reductions += ((vector_stmt_t*) vector_get(vl->stmts, i))->kind != OP_ASSIGN;
+    int* registers = malloc(max(vl->invariants->size, 1) * sizeof(int));
+    int next = reductions + vl->depth;
+    for (int i = 0; i < vl->invariants->size; i++)
+    {
+        registers[i] = next < VECTOR_REGISTERS ? next++ : -1;
+        if (registers[i] >= 0)
+            emit_vector_invariant(e, vl->element, vector_get(vl->invariants, i), registers[i]);
+    }
+    emit_expr(e, stmt->for_cond->rhs);
+    emit_conv(e, stmt->for_cond->rhs->datatype, t_i64);
+    emit("leaq -%i(%%rax), %%rdx", lanes - 1);
+    emit_expr(e, var);
+    emit_conv(e, var->datatype, t_i64);
+    emit("movq %%rax, %%rcx");
+    for (int i = 0; i < vl->arrays->size; i++)
+        emit("movq %i(%%rbp), %%r%i", ((ast_node_t*) vector_get(vl->arrays, i))->voffset, i + 8);
+    for (int i = 0, acc = 0; i < vl->stmts->size; i++)
+    {
+        vector_stmt_t* vs = vector_get(vl->stmts, i);
+        if (vs->kind == OP_ASSIGN)
+            continue;
+        // a sum starts from nothing, a min or max from what the variable already is
+        if (vs->kind == OP_ADD)
+            emit_vector_op(e, "pxor", acc, acc, wide);
+        else
+        {
+            char from[32];
+            sprintf(from, "%i(%%rbp)", vs->target->voffset);
+            emit_vector_scalar(e, element, from, acc);
+            emit_vector_broadcast(e, element, acc);
+        }
+        acc++;
+    }
+    char* check = emitter_make_label(e);
+    char* loop = emitter_make_label(e);
+    emit("jmp %s", check);
+    emit_noindent("%s:", loop);
+    for (int i = 0, acc = 0; i < vl->stmts->size; i++)
+    {
+        vector_stmt_t* vs = vector_get(vl->stmts, i);
+        emit_vector_value(e, vl, registers, vs->value, reductions);
+        if (vs->kind != OP_ASSIGN)
+        {
+            emit_vector_op(e, vector_mnemonic(element, vs->kind), reductions, acc++, true);
+            continue;
+        }
+        int array = 0;
+        while (vector_get(vl->arrays, array) != vs->target->lhs)
+            array++;
+        emit("%s%s %%%cmm%i, (%%r%i,%%rcx,%i)", wide ? "v" : "", vector_mnemonic(element, OP_ASSIGN), r, reductions, array + 8, vl->element->size);
+    }
+    emit("addq $%i, %%rcx", lanes);
+    emit_noindent("%s:", check);
+    emit("cmpq %%rdx, %%rcx");
+    emit("jl %s", loop);
+    emit("mov%c %%%s, %i(%%rbp)", int_reg_size(var->datatype->size), find_register(REG_C, var->datatype->size), var->voffset);
+    // each register's lanes get folded into the bottom one, and that into the variable
+    int tmp = reductions;
+    for (int i = 0, acc = 0; i < vl->stmts->size; i++)
+    {
+        vector_stmt_t* vs = vector_get(vl->stmts, i);
+        if (vs->kind == OP_ASSIGN)
+            continue;
+        char* op = vector_mnemonic(element, vs->kind);
+        if (wide)
+        {
+            emit("vextractf128 $1, %%ymm%i, %%xmm%i", acc, tmp);
+            emit_vector_op(e, op, tmp, acc, false);
+        }
+        emit("%spshufd $0x4e, %%xmm%i, %%xmm%i", wide ? "v" : "", acc, tmp);
+        emit_vector_op(e, op, tmp, acc, false);
+        if (vl->element->size == 4)
+        {
+            emit("%spshufd $0xb1, %%xmm%i, %%xmm%i", wide ? "v" : "", acc, tmp);
+            emit_vector_op(e, op, tmp, acc, false);
+        }
+        char at[32];
+        sprintf(at, "%i(%%rbp)", vs->target->voffset);
+        if (vs->kind == OP_ADD)
+        {
+            emit_vector_scalar(e, element, at, tmp);
+            emit_vector_op(e, op, tmp, acc, false);
+        }
+        char* store = element == DTT_F64 ? "movsd" : element == DTT_F32 ? "movss" : element == DTT_I32 ? "movd" : "movq";
+        emit("%s%s %%xmm%i, %s", wide ? "v" : "", store, acc, at);
+        acc++;
+    }
+    if (wide)
+        emit("vzeroupper");
+    free(registers);
+}
+
+// the instruction for op on dt's lanes, NULL for i32 multiplies, mins and maxes without --avx2 since those are sse4.1
+static char* simd_mnemonic(datatype_t* dt, int op)
+{
+    datatype_type lane = dt->array_type->type;
+    bool f64 = lane == DTT_F64, f32 = lane == DTT_F32;
+    switch (op)
+    {
+        case OP_AND: return f64 ? "andpd" : f32 ? "andps" : "pand";
+        case OP_OR: return f64 ? "orpd" : f32 ? "orps" : "por";
+        case OP_XOR: return f64 ? "xorpd" : f32 ? "xorps" : "pxor";
+    }
+    return vector_mnemonic(lane, op);
+}
+
+static int simd_base_op(int op)
+{
+    switch (op)
+    {
+        case OP_ASSIGN_ADD: return OP_ADD;
+        case OP_ASSIGN_SUB: return OP_SUB;
+        case OP_ASSIGN_MUL: return OP_MUL;
+        case OP_ASSIGN_DIV: return OP_DIV;
+        case OP_ASSIGN_AND: return OP_AND;
+        case OP_ASSIGN_OR: return OP_OR;
+        case OP_ASSIGN_XOR: return OP_XOR;
+    }
+    return op;
+}
+
+// every bit of reg set
+static void emit_simd_ones(emitter_t* e, datatype_t* dt, int reg)
+{
+    emit_vector_op(e, "pcmpeqd", reg, reg, dt->size == 32);
+}
+
+// dst gets a mask of where its lanes are bigger than src's. sse2 only compares dwords (pcmpgtq is sse4.2), so an i64
+// lane is bigger where its high dword is, or where those match and taking its low dword from src's borrows
+static void emit_simd_greater(emitter_t* e, datatype_t* dt, int src, int dst, int scratch)
+{
+    bool wide = dt->size == 32, i64 = dt->array_type->type == DTT_I64;
+    if (!i64 || options->avx2)
+    {
+        emit_vector_op(e, i64 ? "pcmpgtq" : "pcmpgtd", src, dst, wide);
+        return;
+    }
+    int borrow = emitter_simd_scratch(e, scratch), same = emitter_simd_scratch(e, scratch + 1);
+    emit_simd_copy(e, dt, src, borrow);
+    emit_vector_op(e, "psubq", dst, borrow, false);
+    emit_simd_copy(e, dt, dst, same);
+    emit_vector_op(e, "pcmpeqd", src, same, false);
+    emit_vector_op(e, "pand", same, borrow, false);
+    emit_vector_op(e, "pcmpgtd", src, dst, false);
+    emit_vector_op(e, "por", borrow, dst, false);
+    emit("pshufd $0xf5, %%xmm%i, %%xmm%i", dst, dst); // the high dwords' answer goes over both halves
+}
+
+// dst gets a mask of where its lanes match src's, i64 lanes match where both their dwords do without pcmpeqq (sse4.1)
+static void emit_simd_equal(emitter_t* e, datatype_t* dt, int src, int dst)
+{
+    bool wide = dt->size == 32, i64 = dt->array_type->type == DTT_I64;
+    if (!i64 || options->avx2)
+    {
+        emit_vector_op(e, i64 ? "pcmpeqq" : "pcmpeqd", src, dst, wide);
+        return;
+    }
+    int swapped = emitter_simd_scratch(e, 0);
+    emit_vector_op(e, "pcmpeqd", src, dst, false);
+    emit("pshufd $0xb1, %%xmm%i, %%xmm%i", dst, swapped);
+    emit_vector_op(e, "pand", swapped, dst, false);
+}
+
+// xmm0 gets the smaller (or bigger) of itself and reg lane by lane. sse and avx2 have no instruction for i64 lanes, and
+// sse2 none for i32 ones either
+static void emit_simd_min_max(emitter_t* e, datatype_t* dt, int op, int reg)
+{
+    bool wide = dt->size == 32;
+    char* mnemonic = simd_mnemonic(dt, op);
+    if (mnemonic)
+    {
+        emit_vector_op(e, mnemonic, reg, 0, wide);
+        return;
+    }
+    int mask = emitter_simd_scratch(e, 0), other = emitter_simd_scratch(e, 1);
+    emit_simd_copy(e, dt, 0, mask);
+    emit_simd_greater(e, dt, reg, mask, 2); // set where xmm0 is bigger
+    if (op == OP_GREATER)
+    {
+        emit_simd_copy(e, dt, mask, other);
+        emit_vector_op(e, "pand", 0, mask, wide);
+        emit_vector_op(e, "pandn", reg, other, wide);
+    }
+    else
+    {
+        emit_simd_copy(e, dt, mask, other);
+        emit_vector_op(e, "pand", reg, mask, wide);
+        emit_vector_op(e, "pandn", 0, other, wide);
+    }
+    emit_vector_op(e, "por", mask, other, wide);
+    emit_simd_copy(e, dt, other, 0);
+}
+
+// xmm0 times reg with i32 lanes and no pmulld (sse4.1), pmuludq multiplies the even lanes into qwords so the odd ones
+// get moved down for a second one and the low halves are put back together
+static void emit_simd_mul(emitter_t* e, int reg)
+{
+    int odd = emitter_simd_scratch(e, 0), other = emitter_simd_scratch(e, 1);
+    emit("pshufd $0xf5, %%xmm0, %%xmm%i", odd);
+    emit("pshufd $0xf5, %%xmm%i, %%xmm%i", reg, other);
+    emit_vector_op(e, "pmuludq", reg, 0, false);
+    emit_vector_op(e, "pmuludq", other, odd, false);
+    emit("pshufd $0x08, %%xmm0, %%xmm0");
+    emit("pshufd $0x08, %%xmm%i, %%xmm%i", odd, odd);
+    emit_vector_op(e, "punpckldq", odd, 0, false);
+}
+
+static void emit_simd_compare(emitter_t* e, datatype_t* dt, int op, int reg)
+{
+    bool wide = dt->size == 32, swap = false, negate = false, equal = false;
+    char mnemonic[16];
+    bool floats = isfloattype(dt->array_type->type);
+    if (floats)
+    {
+        char* cmp = NULL;
+        switch (op)
+        {
+            case OP_EQUAL: cmp = "cmpeq"; break;
+            case OP_NOT_EQUAL: cmp = "cmpneq"; break;
+            case OP_LESS: cmp = "cmplt"; break;
+            case OP_LESS_EQUAL: cmp = "cmple"; break;
+            case OP_GREATER: cmp = "cmplt"; swap = true; break;
+            case OP_GREATER_EQUAL: cmp = "cmple"; swap = true; break;
+        }
+        sprintf(mnemonic, "%sp%c", cmp, dt->array_type->type == DTT_F64 ? 'd' : 's');
+    }
+    else
+    {
+        // only equal and greater exist, the rest swap sides or flip the result
+        switch (op)
+        {
+            case OP_EQUAL: equal = true; break;
+            case OP_NOT_EQUAL: equal = negate = true; break;
+            case OP_GREATER: break;
+            case OP_LESS: swap = true; break;
+            case OP_LESS_EQUAL: negate = true; break;
+            case OP_GREATER_EQUAL: swap = negate = true; break;
+        }
+    }
+    int src = swap ? 0 : reg, dst = swap ? reg : 0;
+    if (floats)
+        emit_vector_op(e, mnemonic, src, dst, wide);
+    else if (equal)
+        emit_simd_equal(e, dt, src, dst);
+    else
+        emit_simd_greater(e, dt, src, dst, 0);
+    if (swap)
+        emit_simd_copy(e, dt, reg, 0);
+    if (negate)
+    {
+        int ones = emitter_simd_scratch(e, 0);
+        emit_simd_ones(e, dt, ones);
+        emit_vector_op(e, "pxor", ones, 0, wide);
+    }
+}
+
+// operators on simd values, the result is left in xmm0 (ymm0)
+static void emit_simd_op(emitter_t* e, ast_node_t* op)
+{
+    datatype_t* dt = op->datatype;
+    if (op->type == OP_MINUS || op->type == OP_COMPLEMENT)
+    {
+        bool wide = dt->size == 32;
+        emit_expr(e, op->operand);
+        int tmp = emitter_simd_scratch(e, 0);
+        if (op->type == OP_COMPLEMENT)
+            emit_simd_ones(e, dt, tmp);
+        else if (isfloattype(dt->array_type->type)) // flips the sign bit of every lane
+        {
+            emit_simd_ones(e, dt, tmp);
+            if (options->avx2)
+                emit("vps%s $%i, %%%cmm%i, %%%cmm%i", dt->array_type->size == 8 ? "llq" : "lld", dt->array_type->size * 8 - 1, simd_reg(e, dt), tmp, simd_reg(e, dt), tmp);
+            else
+                emit("ps%s $%i, %%xmm%i", dt->array_type->size == 8 ? "llq" : "lld", dt->array_type->size * 8 - 1, tmp);
+        }
+        else // 0 - x
+        {
+            emit_vector_op(e, "pxor", tmp, tmp, wide);
+            emit_vector_op(e, simd_mnemonic(dt, OP_SUB), 0, tmp, wide);
+            emit_simd_copy(e, dt, tmp, 0);
+            return;
+        }
+        emit_vector_op(e, "pxor", tmp, 0, wide);
+        return;
+    }
+    datatype_t* operands = op->lhs->datatype;
+    bool wide = operands->size == 32;
+    int reg;
+    if (op->simd_spill) // the lhs is a call, which would clobber the stashed rhs
+    {
+        char at[32];
+        sprintf(at, "%i(%%rbp)", op->simd_spill->voffset);
+        emit_expr(e, op->lhs);
+        emit_simd_store(e, operands, 0, at);
+        emit_expr(e, op->rhs);
+        reg = emitter_stash_simd_reg(e, operands);
+        emit_simd_load(e, operands, at, 0);
+    }
+    else
+    {
+        emit_expr(e, op->rhs);
+        reg = emitter_stash_simd_reg(e, operands);
+        emit_expr(e, op->lhs);
+    }
+    int base = simd_base_op(op->type);
+    switch (base)
+    {
+        case OP_EQUAL:
+        case OP_NOT_EQUAL:
+        case OP_GREATER:
+        case OP_GREATER_EQUAL:
+        case OP_LESS:
+        case OP_LESS_EQUAL:
+            emit_simd_compare(e, operands, base, reg);
+            break;
+        case OP_MUL:
+        {
+            if (operands->array_type->type == DTT_I32 && !options->avx2)
+            {
+                emit_simd_mul(e, reg);
+                break;
+            }
+        }
+        // fallthrough
+        default:
+            emit_vector_op(e, simd_mnemonic(operands, base), reg, 0, wide);
+    }
+    emitter_restore_simd_reg(e);
+}
+
+// folds every lane of xmm0 (ymm0) into its bottom one with op, and moves integers on to rax
+static void emit_simd_fold(emitter_t* e, datatype_t* dt, int op)
+{
+    datatype_t* half = simd_datatype(dt->array_type->type, 16);
+    int tmp = emitter_simd_scratch(e, 0);
+    bool min_max = op != OP_ADD;
+    e->ftmp++; // the i64 mins and maxes, and the i32 ones without avx2, need scratch registers past tmp
+    if (dt->size == 32)
+    {
+        e->ymm = true;
+        emit("vextracti128 $1, %%ymm0, %%xmm%i", tmp);
+        if (min_max)
+            emit_simd_min_max(e, half, op, tmp);
+        else
+            emit_vector_op(e, simd_mnemonic(half, op), tmp, 0, false);
+    }
+    emit("%spshufd $0x4e, %%xmm0, %%xmm%i", options->avx2 ? "v" : "", tmp);
+    if (min_max)
+        emit_simd_min_max(e, half, op, tmp);
+    else
+        emit_vector_op(e, simd_mnemonic(half, op), tmp, 0, false);
+    if (dt->array_type->size == 4)
+    {
+        emit("%spshufd $0xb1, %%xmm0, %%xmm%i", options->avx2 ? "v" : "", tmp);
+        if (min_max)
+            emit_simd_min_max(e, half, op, tmp);
+        else
+            emit_vector_op(e, simd_mnemonic(half, op), tmp, 0, false);
+    }
+    e->ftmp--;
+    if (dt->array_type->type == DTT_I32)
+        emit("%smovd %%xmm0, %%eax", options->avx2 ? "v" : "");
+    else if (dt->array_type->type == DTT_I64)
+        emit("%smovq %%xmm0, %%rax", options->avx2 ? "v" : "");
+}
+
+// shuffle's lanes come out of the literals after its value
+static void emit_simd_shuffle(emitter_t* e, ast_node_t* call)
+{
+    datatype_t* dt = call->datatype;
+    int lanes = dt->size / dt->array_type->size;
+    int picks[8];
+    for (int i = 0; i < lanes; i++)
+        picks[i] = ((ast_node_t*) vector_get(call->args, i + 1))->ivalue;
+    if (dt->size == 16)
+    {
+        int imm = 0;
+        for (int i = 0; i < 4; i++) // i64 lanes are two dwords each
+            imm |= (lanes == 4 ? picks[i] : picks[i / 2] * 2 + i % 2) << (i * 2);
+        emit("%spshufd $%i, %%xmm0, %%xmm0", options->avx2 ? "v" : "", imm);
+        return;
+    }
+    e->ymm = true;
+    if (lanes == 4)
+    {
+        int imm = 0;
+        for (int i = 0; i < 4; i++)
+            imm |= picks[i] << (i * 2);
+        emit("vpermq $%i, %%ymm0, %%ymm0", imm);
+        return;
+    }
+    // eight dword lanes need their indices in a register
+    long long lo = 0;
+    for (int i = 0; i < 8; i++)
+        lo |= (long long) picks[i] << (i * 8);
+    int tmp = emitter_simd_scratch(e, 0);
+    emit("vpmovzxbd %s(%%rip), %%ymm%i", emitter_constant(e, constant_init(CONSTANT_XMM, NULL, lo, 0)), tmp);
+    emit("vpermd %%ymm0, %%ymm%i, %%ymm0", tmp);
+}
+
+// intrinsics are worked out inline, their arguments after the first wait in the float stash
+static void emit_simd_intrinsic(emitter_t* e, ast_node_t* call)
+{
+    char* name = call->func->func_name;
+    ast_node_t* first = vector_get(call->args, 0);
+    datatype_t* dt = first->datatype;
+    bool wide = dt->size == 32;
+    int simd_args = strcmp(name, "shuffle") ? call->args->size : 1;
+    for (int i = simd_args - 1; i > 0; i--)
+    {
+        ast_node_t* arg = vector_get(call->args, i);
+        emit_expr(e, arg);
+        emitter_stash_simd_reg(e, arg->datatype);
+    }
+    emit_expr(e, first);
+    if (!strcmp(name, "hsum"))
+        emit_simd_fold(e, dt, OP_ADD);
+    else if (!strcmp(name, "hmin"))
+        emit_simd_fold(e, dt, OP_LESS);
+    else if (!strcmp(name, "hmax"))
+        emit_simd_fold(e, dt, OP_GREATER);
+    else if (!strcmp(name, "vmin") || !strcmp(name, "vmax"))
+        emit_simd_min_max(e, dt, *(name + 2) == 'i' ? OP_LESS : OP_GREATER, e->ftmp - 1);
+    else if (!strcmp(name, "shuffle"))
+        emit_simd_shuffle(e, call);
+    else if (!strcmp(name, "select"))
+    {
+        // (mask & a) | (~mask & b)
+        int a = e->ftmp - 1, b = e->ftmp - 2, tmp = emitter_simd_scratch(e, 0);
+        emit_simd_copy(e, dt, 0, tmp);
+        emit_vector_op(e, "pand", a, tmp, wide);
+        emit_vector_op(e, "pandn", b, 0, wide);
+        emit_vector_op(e, "por", tmp, 0, wide);
+    }
+    else
+    {
+        // every lane of a mask is all ones or all zeros, so its bytes' top bits say the same
+        bool all = !strcmp(name, "all");
+        emit("%spmovmskb %%%cmm0, %%eax", options->avx2 ? "v" : "", simd_reg(e, dt));
+        if (all)
+            emit("cmpl $%i, %%eax", wide ? -1 : 0xffff);
+        else
+            emit("testl %%eax, %%eax");
+        emit("set%s %%al", all ? "e" : "ne");
+    }
+    for (int i = 1; i < simd_args; i++)
+        emitter_restore_simd_reg(e);
+}
+
+// simd casts convert between f32 and i32 lanes, load from an array or slice, or spread a scalar over every lane
+static void emit_simd_cast(emitter_t* e, ast_node_t* cast)
+{
+    datatype_t* dt = cast->datatype, * from = cast->castval->datatype;
+    datatype_type lane = dt->array_type->type;
+    emit_expr(e, cast->castval);
+    switch (from->type)
+    {
+        case DTT_SIMD:
+        {
+            char r = simd_reg(e, dt);
+            if (from->array_type->type == DTT_F32 && lane == DTT_I32)
+                emit("%scvttps2dq %%%cmm0, %%%cmm0", options->avx2 ? "v" : "", r, r);
+            else if (from->array_type->type == DTT_I32 && lane == DTT_F32)
+                emit("%scvtdq2ps %%%cmm0, %%%cmm0", options->avx2 ? "v" : "", r, r);
+            break;
+        }
+        case DTT_ARRAY:
+        case DTT_SLICE:
+        {
+            if (e->checked) // the last lane has to be in bounds too
+            {
+                if (from->type == DTT_ARRAY)
+                    emit("movq -8(%%rax), %%rdx");
+                emit("movq $%i, %%rcx", dt->size / dt->array_type->size - 1);
+                emit_bounds_check(e, "rcx", "%rdx");
+            }
+            emit_simd_load(e, dt, "(%rax)", 0);
+            break;
+        }
+        default:
+        {
+            emit_conv(e, from, dt->array_type);
+            if (!isfloattype(lane)) // floats are already in the bottom lane
+                emit_vector_scalar(e, lane, lane == DTT_I32 ? "%eax" : "%rax", 0);
+            if (dt->size == 32)
+                emit_vector_broadcast(e, lane, 0);
+            else
+                emit("%spshufd $%i, %%xmm0, %%xmm0", options->avx2 ? "v" : "", dt->array_type->size == 4 ? 0 : 0x44);
+            e->ymm |= dt->size == 32;
+        }
+    }
+}
+
+static void emit_for_loop(emitter_t* e, ast_node_t* stmt)
+{
+    if (stmt->for_vector && (!e->checked || stmt->for_fast))
+        emit_vector_loop(e, stmt);
+    char* check_cond = emitter_make_label(e);
     emit("jmp %s", check_cond);
-    char* loop = make_label(e->p, NULL);
+    char* loop = emitter_make_label(e);
     emit_noindent("%s:", loop);
     for (int i = 0; i < stmt->for_then->statements->size; i++)
         emit_stmt(e, vector_get(stmt->for_then->statements, i));
@@ -716,6 +2166,193 @@ static void emit_for_statement(emitter_t* e, ast_node_t* stmt)
     emit("jne %s", loop);
 }
 
+// a loop range.c guarded runs without its checks when the guards pass, see the top of range.c
+static void emit_guarded_loop(emitter_t* e, ast_node_t* stmt)
+{
+    if (!e->checked || !stmt->for_guards)
+    {
+        emit_for_loop(e, stmt);
+        return;
+    }
+    char* checked = emitter_make_label(e);
+    char* fast = emitter_make_label(e);
+    char* done = emitter_make_label(e);
+    ast_node_t* var = stmt->for_cond->lhs, * bound = stmt->for_cond->rhs;
+    if (range_needs_sign_guard(stmt))
+    {
+        emit("cmp%c $0, %i(%%rbp)", int_reg_size(var->datatype->size), var->voffset);
+        emit("jl %s", checked);
+    }
+    emit_expr(e, bound);
+    emit_conv(e, bound->datatype, t_i64);
+    if (range_needs_width_guard(stmt))
+    {
+        emit("cmpq $%lli, %%rax", (1LL << (var->datatype->size * 8 - 1)) - 1);
+        emit("jg %s", checked);
+    }
+    if (stmt->for_guards->size)
+    {
+        emit("testq %%rax, %%rax");
+        emit("jle %s", fast); // never runs
+    }
+    for (int i = 0; i < stmt->for_guards->size; i++)
+    {
+        ast_node_t* array = vector_get(stmt->for_guards, i);
+        if (array->datatype->type == DTT_SLICE)
+        {
+            emit("cmpq %i(%%rbp), %%rax", array->voffset + 8);
+            emit("jg %s", checked);
+            continue;
+        }
+        emit("movq %i(%%rbp), %%rcx", array->voffset);
+        emit("testq %%rcx, %%rcx");
+        emit("jz %s", checked);
+        emit("cmpq -8(%%rcx), %%rax");
+        emit("jg %s", checked);
+    }
+    emit_noindent("%s:", fast);
+    stmt->for_fast = true;
+    emit_for_loop(e, stmt);
+    stmt->for_fast = false;
+    emit("jmp %s", done);
+    emit_noindent("%s:", checked);
+    emit_for_loop(e, stmt);
+    emit_noindent("%s:", done);
+}
+
+static char* parallel_kept[] = { "rbx", "rsi", "rdi", "r12", "r13", "r14", "r15" };
+
+// a task runs the iterations [rdx, r8) on a copy of the frame rcx points to, adding what it adds up to the row of
+// partials in r9. the frame is copied to the same place below its own rbp, so the body can be emitted like it usually is
+static void emit_parallel_task(emitter_t* e, ast_node_t* stmt)
+{
+    parallel_loop_t* parallel = stmt->for_parallel;
+    ast_node_t* var = stmt->for_cond->lhs;
+    int kept = sizeof(parallel_kept) / sizeof(char*);
+    emit("pushq %%rbp");
+    emit("movq %%rsp, %%rbp");
+    emit("subq $%i, %%rsp", e->frame_size);
+    for (int i = 0; i < kept; i++)
+        emit("pushq %%%s", parallel_kept[i]);
+    // room for the calls' stack arguments, then xmm6-xmm15
+    emit("subq $232, %%rsp");
+    for (int i = 6; i < 16; i++)
+        emit("movdqu %%xmm%i, %i(%%rsp)", i, 64 + (i - 6) * 16);
+    emit("movq %%rcx, %%rax");
+    emit("leaq -%i(%%rax), %%rsi", e->frame_size);
+    emit("leaq -%i(%%rbp), %%rdi", e->frame_size);
+    emit("movl $%i, %%ecx", e->frame_size);
+    emit("rep movsb");
+    for (int i = 16; i < 48; i += 8) // the parameters' home space
+    {
+        emit("movq %i(%%rax), %%r10", i);
+        emit("movq %%r10, %i(%%rbp)", i);
+    }
+    emit("mov%c %%%s, %i(%%rbp)", int_reg_size(var->datatype->size), find_register(x64cc[1], var->datatype->size), var->voffset);
+    emit("mov%c %%%s, %i(%%rbp)", int_reg_size(var->datatype->size), find_register(x64cc[2], var->datatype->size), parallel->bound->voffset);
+    emit("movq %%r9, %i(%%rbp)", parallel->row->voffset);
+    for (int i = 0; i < parallel->reductions->size; i++)
+    {
+        ast_node_t* lvar = vector_get(parallel->reductions, i);
+        emit("mov%c $0, %i(%%rbp)", int_reg_size(lvar->datatype->size), lvar->voffset);
+    }
+    emit_guarded_loop(e, stmt);
+    emit("movq %i(%%rbp), %%rcx", parallel->row->voffset);
+    for (int i = 0; i < parallel->reductions->size; i++)
+    {
+        ast_node_t* lvar = vector_get(parallel->reductions, i);
+        datatype_t* dt = lvar->datatype;
+        if (isfloattype(dt->type))
+        {
+            emit("movs%c %i(%%rcx), %%xmm0", floatsize(dt->size), i * 8);
+            emit("adds%c %i(%%rbp), %%xmm0", floatsize(dt->size), lvar->voffset);
+            emit("movs%c %%xmm0, %i(%%rcx)", floatsize(dt->size), i * 8);
+        }
+        else
+        {
+            emit("mov%c %i(%%rbp), %%%s", int_reg_size(dt->size), lvar->voffset, find_register(REG_A, dt->size));
+            emit_conv(e, dt, t_i64);
+            emit("addq %%rax, %i(%%rcx)", i * 8);
+        }
+    }
+    if (e->ymm)
+        emit("vzeroupper");
+    for (int i = 6; i < 16; i++)
+        emit("movdqu %i(%%rsp), %%xmm%i", 64 + (i - 6) * 16, i);
+    emit("leaq -%i(%%rbp), %%rsp", e->frame_size + kept * 8);
+    for (int i = kept - 1; i >= 0; i--)
+        emit("popq %%%s", parallel_kept[i]);
+    emit("movq %%rbp, %%rsp");
+    emit("popq %%rbp");
+    emit("ret");
+}
+
+// once every task is done, the runtime has the function's own frame in rcx add up each worker's row of partials in rdx
+static void emit_parallel_merge(emitter_t* e, ast_node_t* stmt)
+{
+    parallel_loop_t* parallel = stmt->for_parallel;
+    for (int i = 0; i < parallel->reductions->size; i++)
+    {
+        ast_node_t* lvar = vector_get(parallel->reductions, i);
+        datatype_t* dt = lvar->datatype;
+        if (isfloattype(dt->type))
+        {
+            emit("movs%c %i(%%rcx), %%xmm0", floatsize(dt->size), lvar->voffset);
+            emit("adds%c %i(%%rdx), %%xmm0", floatsize(dt->size), i * 8);
+            emit("movs%c %%xmm0, %i(%%rcx)", floatsize(dt->size), lvar->voffset);
+        }
+        else
+        {
+            emit("movq %i(%%rdx), %%rax", i * 8);
+            emit("add%c %%%s, %i(%%rcx)", int_reg_size(dt->size), find_register(REG_A, dt->size), lvar->voffset);
+        }
+    }
+    emit("ret");
+}
+
+// the tasks and the merge are emitted in the middle of the function and jumped over, the runtime calls them
+static void emit_parallel_for(emitter_t* e, ast_node_t* stmt)
+{
+    parallel_loop_t* parallel = stmt->for_parallel;
+    ast_node_t* var = stmt->for_cond->lhs;
+    emit_stmt(e, stmt->for_init);
+    char* task = emitter_make_label(e);
+    char* merge = emitter_make_label(e);
+    char* skip = emitter_make_label(e);
+    emit("jmp %s", skip);
+    emit_noindent("%s:", task);
+    emit_parallel_task(e, stmt);
+    emit_noindent("%s:", merge);
+    emit_parallel_merge(e, stmt);
+    emit_noindent("%s:", skip);
+    emit_expr(e, parallel->limit);
+    emit_conv(e, parallel->limit->datatype, t_i64);
+    if (parallel->inclusive)
+        emit("incq %%rax");
+    emit("subq $48, %%rsp"); // the last two arguments go on the stack past the shadow space, below the frame
+    emit("movq %%rax, 32(%%rsp)");
+    emit("movq $%i, 40(%%rsp)", parallel->reductions->size);
+    emit("mov%c %i(%%rbp), %%%s", int_reg_size(var->datatype->size), var->voffset, find_register(REG_A, var->datatype->size));
+    emit_conv(e, var->datatype, t_i64);
+    emit("movq %%rax, %%r9");
+    emit("movq %%rbp, %%r8");
+    emit("leaq %s(%%rip), %%rdx", merge);
+    emit("leaq %s(%%rip), %%rcx", task);
+    emit("call __libsgcllc_parallel_for");
+    emit("addq $48, %%rsp");
+}
+
+static void emit_for_statement(emitter_t* e, ast_node_t* stmt)
+{
+    if (stmt->for_parallel)
+    {
+        emit_parallel_for(e, stmt);
+        return;
+    }
+    emit_stmt(e, stmt->for_init);
+    emit_guarded_loop(e, stmt);
+}
+
 static void emit_switch_statement(emitter_t* e, ast_node_t* stmt)
 {
     ast_node_t* cmp = stmt->cmp;
@@ -749,7 +2386,7 @@ static void emit_switch_statement(emitter_t* e, ast_node_t* stmt)
             emit("je %s", case_stmt->case_label);
         }
     }
-    char* end_label = make_label(e->p, NULL);
+    char* end_label = emitter_make_label(e);
     if (default_case_index != -1)
     {
         ast_node_t* case_stmt = vector_get(stmt->cases, default_case_index);
@@ -774,7 +2411,12 @@ static void emit_delete_statement(emitter_t* e, ast_node_t* stmt)
     {
         case AST_LVAR:
         {
-            if (stmt->delsym->datatype->type == DTT_ARRAY)
+            if (stmt->delsym->datatype->type == DTT_ARRAY && stmt->delsym->datatype->soa)
+            {
+                emit("movq %i(%%rbp), %%rcx", stmt->delsym->voffset);
+                emit("call __libsgcllc_delete_soa_array");
+            }
+            else if (stmt->delsym->datatype->type == DTT_ARRAY)
             {
                 emit("movq %i(%%rbp), %%rcx", stmt->delsym->voffset);
                 emit("movl $%i, %%edx", stmt->delsym->datatype->depth);
@@ -782,12 +2424,11 @@ static void emit_delete_statement(emitter_t* e, ast_node_t* stmt)
                 for (int i = 0; i < stmt->delsym->datatype->depth; i++, current = current->array_type)
                 {
                     emit_expr(e, current->length);
+                    emit_conv(e, current->length->datatype, t_i64); // the runtime reads every length as 64 bits
                     if (i >= 2)
-                        emit("mov%c %%%s, %i(%%rsp)", int_reg_size(current->length->datatype->size),
-                            find_register(REG_A, current->length->datatype->type), 32 + 8 * (i - 2));
+                        emit("movq %%rax, %i(%%rsp)", 32 + 8 * (i - 2));
                     else
-                        emit("mov%c %%%s, %%%s", int_reg_size(current->length->datatype->size),
-                            find_register(REG_A, current->length->datatype->type), find_register(x64cc[i + 2], current->length->datatype->type));
+                        emit("movq %%rax, %%%s", find_register(x64cc[i + 2], 8));
                 }
                 emit("call __libsgcllc_delete_array");
             }
@@ -807,11 +2448,11 @@ static void emit_ternary(emitter_t* e, ast_node_t* expr)
 {
     emit_expr(e, expr->tern_cond);
     emit("cmp%c $0, %%%s", int_reg_size(expr->tern_cond->datatype->size), find_register(REG_A, expr->tern_cond->datatype->size));
-    char* skip = make_label(e->p, NULL);
+    char* skip = emitter_make_label(e);
     emit("je %s", skip);
     emit_expr(e, expr->tern_then);
     emit_conv(e, expr->tern_then->datatype, expr->datatype);
-    char* skip_els = make_label(e->p, NULL);
+    char* skip_els = emitter_make_label(e);
     emit("jmp %s", skip_els);
     emit_noindent("%s:", skip);
     emit_expr(e, expr->tern_els);
@@ -825,6 +2466,11 @@ static void emit_expr(emitter_t* e, ast_node_t* expr)
     {
         case OP_ASSIGN:
         {
+            if (expr->rhs->type == AST_FUNC_CALL && expr->rhs->call_result == expr->lhs) // constructed in place
+            {
+                emit_func_call(e, expr->rhs);
+                break;
+            }
             emit_expr(e, expr->rhs);
             if (expr->lhs->datatype != expr->rhs->datatype)
                 emit_conv(e, expr->rhs->datatype, expr->lhs->datatype);
@@ -904,6 +2550,11 @@ static void emit_expr(emitter_t* e, ast_node_t* expr)
             emit_complement(e, expr);
             break;
         }
+        case OP_SPAWN:
+        {
+            emit_spawn(e, expr);
+            break;
+        }
         case OP_ASM:
         {
             emit("%s /* inline assembly (line %i, row %i) */", unwrap_string_literal(expr->operand->svalue), expr->loc->row, expr->loc->col);
@@ -981,7 +2632,20 @@ static void emit_expr(emitter_t* e, ast_node_t* expr)
         }
         case AST_LVAR:
         {
-            if (isfloattype(expr->datatype->type))
+            if (isvaluetype(expr->datatype))
+                emit("leaq %i(%%rbp), %%rax", expr->voffset);
+            else if (expr->datatype->type == DTT_SLICE)
+            {
+                emit("movq %i(%%rbp), %%rax", expr->voffset);
+                emit("movq %i(%%rbp), %%rdx", expr->voffset + 8);
+            }
+            else if (expr->datatype->type == DTT_SIMD)
+            {
+                char at[32];
+                sprintf(at, "%i(%%rbp)", expr->voffset);
+                emit_simd_load(e, expr->datatype, at, 0);
+            }
+            else if (isfloattype(expr->datatype->type))
                 emit("movs%c %i(%%rbp), %%xmm0", floatsize(expr->datatype->size), expr->voffset);
             else
                 emit("mov%c %i(%%rbp), %%%s", int_reg_size(expr->datatype->size), expr->voffset, find_register(REG_A, expr->datatype->size));
@@ -989,11 +2653,19 @@ static void emit_expr(emitter_t* e, ast_node_t* expr)
         }
         case AST_FUNC_CALL:
         {
-            emit_func_call(e, expr);
+            if (expr->func->extrn == 'v')
+                emit_simd_intrinsic(e, expr);
+            else
+                emit_func_call(e, expr);
             break;
         }
         case AST_CAST:
         {
+            if (expr->datatype->type == DTT_SIMD)
+            {
+                emit_simd_cast(e, expr);
+                break;
+            }
             emit_expr(e, expr->castval);
             emit_conv(e, expr->castval->datatype, expr->datatype);
             break;
@@ -1008,17 +2680,43 @@ static void emit_expr(emitter_t* e, ast_node_t* expr)
             emit_ternary(e, expr);
             break;
         }
+        case OP_SLICE:
+        {
+            emit_slice(e, expr);
+            break;
+        }
         case OP_MAGNITUDE:
         {
+            if (expr->operand->datatype->type == DTT_SIMD) // how many lanes
+            {
+                emit("movq $%i, %%rax", expr->operand->datatype->size / expr->operand->datatype->array_type->size);
+                break;
+            }
+            if (isvaluetype(expr->operand->datatype))
+            {
+                emit("movq $%i, %%rax", expr->operand->datatype->size);
+                break;
+            }
+            if (expr->operand->datatype->type == DTT_SLICE) // the length sits next to the pointer
+            {
+                if (expr->operand->type == AST_LVAR)
+                    emit("movq %i(%%rbp), %%rax", expr->operand->voffset + 8);
+                else
+                {
+                    emit_expr(e, expr->operand);
+                    emit("movq %%rdx, %%rax");
+                }
+                break;
+            }
             emit_expr(e, expr->operand);
             emit("mov %%rax, %%rcx");
             switch (expr->operand->datatype->type)
             {
                 case DTT_ARRAY:
-                    emit("call __libsgcllc_array_size");
+                    emit("movq -8(%%rax), %%rax"); // length from in front of the elements
                     break;
                 case DTT_STRING:
-                    emit("call __libsgcllc_string_length");
+                    emit("movq -8(%%rax), %%rax"); // length from the string header
                     break;
                 case DTT_OBJECT:
                     emit("call __libsgcllc_blueprint_size");
@@ -1045,7 +2743,13 @@ static void emit_stmt(emitter_t* e, ast_node_t* stmt)
         case AST_RETURN:
         {
             emit_expr(e, stmt->retval);
-            char* end_label = stmt->retfunc->end_label ? stmt->retfunc->end_label : (stmt->retfunc->end_label = make_label(e->p, NULL));
+            if (isvaluetype(stmt->retfunc->datatype) && stmt->retfunc->func_type != 'c') // constructors already built it there
+            {
+                emit("movq 16(%%rbp), %%rdx");
+                emit_value_copy(e, "rax", "rdx", stmt->retfunc->datatype->size);
+                emit("movq %%rdx, %%rax");
+            }
+            char* end_label = stmt->retfunc->end_label ? stmt->retfunc->end_label : (stmt->retfunc->end_label = emitter_make_label(e));
             emit("jmp %s", end_label);
             break;
         }
@@ -1085,9 +2789,25 @@ static void emit_stmt(emitter_t* e, ast_node_t* stmt)
 void emitter_emit(emitter_t* e)
 {
     emit_file(e, e->p->nfile);
+    emitter_flush(e);
+}
+
+// emits whatever the parser has finished since the last call, constants wait for emitter_stream_end
+void emitter_stream(emitter_t* e)
+{
+    emit_decls(e, e->p->nfile->decls);
+}
+
+// the entry point goes last since an enter statement could come after main
+void emitter_stream_end(emitter_t* e)
+{
+    emit_entry(e);
+    emit_constants(e);
+    emitter_flush(e);
 }
 
 emitter_t* emitter_delete(emitter_t* e)
 {
+    buffer_delete(e->code);
     free(e);
 }
\ No newline at end of file
@@ -0,0 +1,294 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sgcllc.h"
+
+// objects and arrays that a function makes and only ever reaches through one local variable don't need the heap,
+// they get a slot in the function's frame instead. the variable's pointer getting out in any way (returned, stored,
+// passed to a call, copied to another variable, compared or deleted) keeps everything it's given on the heap. the same
+// goes for the constructor it's made by, which has to keep this to itself
+
+// bigger arrays stay on the heap so frames stay small
+#define ESCAPE_MAX_ARRAY_BYTES 1024
+
+typedef struct
+{
+    parser_t* p;
+    ast_node_t* func;
+    vector_t* escaped; // local variables whose pointer gets out
+    vector_t* sites; // local variable, allocation pairs
+    bool parallel; // the function has a parallel for, whose tasks each work on a copy of the frame
+} escape_t;
+
+static void escape_expr(escape_t* es, ast_node_t* expr, bool contained);
+
+static bool escape_tracked(ast_node_t* lvar)
+{
+    return (lvar->datatype->type == DTT_OBJECT && !lvar->datatype->value) || lvar->datatype->type == DTT_ARRAY;
+}
+
+// bytes of frame an allocation needs, 0 if it has to stay on the heap
+static int escape_allocation_size(escape_t* es, ast_node_t* node)
+{
+    if (node->type == AST_FUNC_CALL)
+    {
+        if (node->func->func_type != 'c' || !node->func->this_stays || isvaluetype(node->datatype))
+            return 0;
+        ast_node_t* blueprint = map_get(es->p->lenv ? es->p->lenv : es->p->genv, node->datatype->name);
+        // a blueprint still being read doesn't know its size yet
+        if (!blueprint || blueprint->type != AST_BLUEPRINT || blueprint == es->p->current_blueprint)
+            return 0;
+        return max(blueprint->bp_size, 1);
+    }
+    if (node->type == AST_MAKE)
+    {
+        datatype_t* dt = node->datatype;
+        if (dt->depth != 1 || dt->soa || dt->length->type != AST_ILITERAL || dt->length->ivalue < 0)
+            return 0;
+        long long bytes = dt->length->ivalue * dt->array_type->size + 8; // the length goes in front
+        return bytes <= ESCAPE_MAX_ARRAY_BYTES ? bytes : 0;
+    }
+    return 0;
+}
+
+static void escape_stmt(escape_t* es, ast_node_t* stmt)
+{
+    if (!stmt)
+        return;
+    switch (stmt->type)
+    {
+        case AST_LVAR:
+        {
+            escape_expr(es, stmt->vinit, false);
+            break;
+        }
+        case AST_BLOCK:
+        {
+            for (int i = 0; i < stmt->statements->size; i++)
+                escape_stmt(es, vector_get(stmt->statements, i));
+            break;
+        }
+        case AST_IF:
+        {
+            escape_expr(es, stmt->if_cond, false);
+            escape_stmt(es, stmt->if_then);
+            escape_stmt(es, stmt->if_els);
+            break;
+        }
+        case AST_WHILE:
+        {
+            escape_expr(es, stmt->while_cond, false);
+            escape_stmt(es, stmt->while_then);
+            break;
+        }
+        case AST_FOR:
+        {
+            escape_stmt(es, stmt->for_init);
+            escape_expr(es, stmt->for_cond, false);
+            escape_expr(es, stmt->for_post, false);
+            escape_stmt(es, stmt->for_then);
+            if (stmt->for_parallel)
+            {
+                es->parallel = true;
+                escape_expr(es, stmt->for_parallel->limit, false);
+            }
+            break;
+        }
+        case AST_SWITCH:
+        {
+            escape_expr(es, stmt->cmp, false);
+            for (int i = 0; i < stmt->cases->size; i++)
+            {
+                ast_node_t* c = vector_get(stmt->cases, i);
+                if (c->case_conditions)
+                {
+                    for (int j = 0; j < c->case_conditions->size; j++)
+                        escape_expr(es, vector_get(c->case_conditions, j), false);
+                }
+                escape_stmt(es, c->case_then);
+            }
+            break;
+        }
+        case AST_RETURN:
+        {
+            // a constructor hands this back to whoever made it
+            if (es->func->func_type == 'c' && stmt->retval == vector_get(es->func->local_variables, 0))
+                break;
+            escape_expr(es, stmt->retval, false);
+            break;
+        }
+        case AST_DELETE:
+        {
+            escape_expr(es, stmt->delsym, false);
+            break;
+        }
+        case AST_BREAK:
+        case AST_CONTINUE:
+            break;
+        default:
+            escape_expr(es, stmt, false);
+    }
+}
+
+// contained is set when expr is only used to reach inside it, like the a in a.x or a[i]
+static void escape_expr(escape_t* es, ast_node_t* expr, bool contained)
+{
+    if (!expr)
+        return;
+    switch (expr->type)
+    {
+        case AST_LVAR:
+        {
+            if (!contained && escape_tracked(expr))
+                vector_push(es->escaped, expr);
+            break;
+        }
+        case OP_SELECTION:
+        {
+            escape_expr(es, expr->lhs, true);
+            break;
+        }
+        case OP_SUBSCRIPT:
+        {
+            escape_expr(es, expr->lhs, true);
+            escape_expr(es, expr->rhs, false);
+            break;
+        }
+        case OP_ASSIGN:
+        {
+            if (expr->lhs->type != AST_LVAR)
+                escape_expr(es, expr->lhs, true);
+            else if (escape_tracked(expr->lhs) && escape_allocation_size(es, expr->rhs))
+            {
+                vector_push(es->sites, expr->lhs);
+                vector_push(es->sites, expr->rhs);
+            }
+            escape_expr(es, expr->rhs, false);
+            break;
+        }
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_MOD:
+        case OP_ASSIGN_ADD:
+        case OP_ASSIGN_SUB:
+        case OP_ASSIGN_MUL:
+        case OP_ASSIGN_DIV:
+        case OP_ASSIGN_MOD:
+        case OP_EQUAL:
+        case OP_NOT_EQUAL:
+        case OP_GREATER:
+        case OP_GREATER_EQUAL:
+        case OP_LESS:
+        case OP_LESS_EQUAL:
+        case OP_AND:
+        case OP_OR:
+        case OP_XOR:
+        case OP_ASSIGN_AND:
+        case OP_ASSIGN_OR:
+        case OP_ASSIGN_XOR:
+        case OP_SHIFT_LEFT:
+        case OP_SHIFT_RIGHT:
+        case OP_SHIFT_URIGHT:
+        case OP_ASSIGN_SHIFT_LEFT:
+        case OP_ASSIGN_SHIFT_RIGHT:
+        case OP_ASSIGN_SHIFT_URIGHT:
+        case OP_LOGICAL_AND:
+        case OP_LOGICAL_OR:
+        {
+            escape_expr(es, expr->lhs, false);
+            escape_expr(es, expr->rhs, false);
+            break;
+        }
+        // an array's length is in front of it, the heap only knows how big an object is
+        case OP_MAGNITUDE:
+        {
+            escape_expr(es, expr->operand, expr->operand->datatype->type == DTT_ARRAY);
+            break;
+        }
+        case OP_NOT:
+        case OP_COMPLEMENT:
+        case OP_MINUS:
+        case OP_PREFIX_INCREMENT:
+        case OP_PREFIX_DECREMENT:
+        case OP_POSTFIX_INCREMENT:
+        case OP_POSTFIX_DECREMENT:
+        case OP_SPAWN:
+        {
+            escape_expr(es, expr->operand, false);
+            break;
+        }
+        case AST_FUNC_CALL:
+        {
+            for (int i = 0; i < expr->args->size; i++)
+                escape_expr(es, vector_get(expr->args, i), false);
+            break;
+        }
+        case AST_CAST:
+        {
+            escape_expr(es, expr->castval, false);
+            break;
+        }
+        // a slice keeps pointing into what it was taken from
+        case OP_SLICE:
+        {
+            escape_expr(es, expr->slice_base, false);
+            escape_expr(es, expr->slice_lo, false);
+            escape_expr(es, expr->slice_hi, false);
+            break;
+        }
+        case AST_TERNARY:
+        {
+            escape_expr(es, expr->tern_cond, false);
+            escape_expr(es, expr->tern_then, false);
+            escape_expr(es, expr->tern_els, false);
+            break;
+        }
+        case AST_MAKE:
+        {
+            datatype_t* current = expr->datatype;
+            for (int i = 0; i < expr->datatype->depth; i++, current = current->array_type)
+                escape_expr(es, current->length, false);
+            break;
+        }
+    }
+}
+
+void escape_analyze(parser_t* p, ast_node_t* func)
+{
+    escape_t es = { p, func, vector_init(8, 8), vector_init(8, 8), false };
+    escape_stmt(&es, func->body);
+    if (func->func_type == 'c')
+    {
+        ast_node_t* this_var = vector_get(func->local_variables, 0);
+        func->this_stays = true;
+        for (int i = 0; i < es.escaped->size && func->this_stays; i++)
+            func->this_stays = vector_get(es.escaped, i) != this_var;
+    }
+    for (int i = 0; i < es.sites->size; i += 2)
+    {
+        ast_node_t* lvar = vector_get(es.sites, i);
+        ast_node_t* allocation = vector_get(es.sites, i + 1);
+        bool escaped = false;
+        for (int j = 0; j < es.escaped->size && !escaped; j++)
+            escaped = vector_get(es.escaped, j) == lvar;
+        if (escaped || es.parallel) // what the tasks change has to be somewhere they share
+            continue;
+        // the slot is an anonymous value blueprint as far as the frame is concerned
+        datatype_t* dt = calloc(1, sizeof(datatype_t));
+        dt->visibility = VT_PRIVATE;
+        dt->type = DTT_OBJECT;
+        dt->value = true;
+        dt->size = round_up(escape_allocation_size(&es, allocation), 8);
+        ast_node_t* storage = ast_lvar_init(dt, allocation->loc, "", NULL, func->residing);
+        vector_push(func->local_variables, storage);
+        if (allocation->type == AST_FUNC_CALL)
+            allocation->call_storage = storage;
+        else
+            allocation->make_storage = storage;
+        tracef(TRACE_PARSER, TRACE_INFO, "%s: '%s' doesn't escape, %i bytes go in the frame\n", func->func_label, lvar->var_name, dt->size);
+    }
+    vector_delete(es.escaped);
+    vector_delete(es.sites);
+}
\ No newline at end of file
@@ -1,241 +1,504 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define HEADER_MMAP
+#elif defined(_WIN32)
+#define NOMINMAX // sgcllc.h has its own
+#include <windows.h>
+#define HEADER_MAPVIEW
+#endif
+
 #include "sgcllc.h"
 
-#define writedt(dt) impl_writedt(dt, out)
-#define writefunc(func) impl_writefunc(func, out)
+#define HEADER_MAGIC "SGLH"
+#define HEADER_VERSION 6
+
+#define HEADER_HAS_LOWLVL 0x1
 
-#define readdt impl_readdt(in)
-#define readfunc(bp) impl_readfunc(in, filename, ident, bp)
+// see doc/header_format.txt, everything here is written and read as-is
 
-static void impl_writedt(datatype_t* dt, FILE* out)
+typedef struct
 {
-    write(dt->visibility);
-    if (dt->type == DTT_ARRAY)
+    char magic[4];
+    unsigned short version;
+    unsigned short flags;
+    unsigned int symbol_count; // top-level symbols, only these are in the hash index
+    unsigned int record_count; // top-level symbols followed by blueprint methods
+    unsigned int bucket_count; // always a power of 2
+    unsigned int member_count;
+    unsigned int string_size;
+} header_file_t;
+
+typedef struct
+{
+    unsigned int name; // offset into the string table, 0 if there is none
+    unsigned char visibility;
+    unsigned char type; // element type for arrays
+    unsigned char size;
+    unsigned char usign;
+    unsigned char depth;
+    unsigned char value; // value blueprint, size is then the whole blueprint
+    unsigned char soa; // the innermost array is soa
+    unsigned char slice; // a slice of the rest
+    unsigned char lane; // lane type for simd types, size is then the whole value
+} header_datatype_t;
+
+typedef struct
+{
+    unsigned int name;
+    header_datatype_t datatype;
+} header_member_t;
+
+typedef struct
+{
+    unsigned int name;
+    unsigned int next; // next record in the same bucket + 1, 0 ends the chain
+    unsigned short decl_type;
+    short operator;
+    unsigned char func_type;
+    unsigned char lowlvl;
+    unsigned short method_count;
+    unsigned int member_start; // parameters for functions, instance variables for blueprints
+    unsigned int member_count;
+    unsigned int method_start;
+    unsigned int bp_size;
+    header_datatype_t datatype;
+} header_record_t;
+
+struct header_t
+{
+    char* filename;
+    char* data;
+    size_t size;
+    header_file_t* file;
+    unsigned int* buckets;
+    header_record_t* records;
+    header_member_t* members;
+    char* strings;
+    ast_node_t** nodes; // materialized records, NULL until something asks for them
+};
+
+// fnv-1a, part of the format so it can't change without bumping HEADER_VERSION
+static unsigned int header_hash(char* str)
+{
+    unsigned int hash = 2166136261u;
+    for (; *str; str++)
     {
-        datatype_t* current = dt;
-        while (dt->array_type)
-            current = dt->array_type;
-        write(current->type);
+        hash ^= (unsigned char) *str;
+        hash *= 16777619u;
     }
-    else
-        write(dt->type);
-    write(dt->size);
-    write(dt->usign);
-    if (dt->type == DTT_OBJECT && dt->name)
-        writestr(dt->name);
-    if (dt->type == DTT_ARRAY)
-        write(dt->depth);
+    return hash;
 }
 
-static void impl_writefunc(ast_node_t* func, FILE* out)
+typedef struct
 {
-    writedt(func->datatype);
-    write(func->func_type);
-    write(func->lowlvl_label != NULL);
-    writei16(func->operator);
-    writei16(func->params->size);
-    for (int i = 0; i < func->params->size; i++)
+    buffer_t* strings;
+    map_t* string_offsets;
+    vector_t* records;
+    vector_t* members;
+} header_writer_t;
+
+static unsigned int header_write_string(header_writer_t* w, char* str)
+{
+    if (!str || !*str)
+        return 0;
+    unsigned int offset = (uintptr_t) map_get(w->string_offsets, str);
+    if (offset)
+        return offset;
+    offset = w->strings->size;
+    buffer_nstring(w->strings, str, strlen(str) + 1);
+    map_put(w->string_offsets, str, (void*) (uintptr_t) offset);
+    return offset;
+}
+
+static header_datatype_t header_write_datatype(header_writer_t* w, datatype_t* dt)
+{
+    header_datatype_t hdt = { 0 };
+    hdt.visibility = dt->visibility;
+    if (dt->type == DTT_SLICE)
+    {
+        hdt.slice = true;
+        dt = dt->array_type;
+    }
+    // declared arrays don't fill in depth, so the brackets get counted
+    while (dt->type == DTT_ARRAY && dt->array_type)
+    {
+        hdt.depth++;
+        hdt.soa = dt->soa;
+        dt = dt->array_type;
+    }
+    hdt.type = dt->type;
+    hdt.size = dt->size;
+    hdt.usign = dt->usign;
+    if (dt->type == DTT_OBJECT)
     {
-        ast_node_t* param = vector_get(func->params, i);
-        writestr(param->var_name);
-        writedt(param->datatype);
+        hdt.name = header_write_string(w, dt->name);
+        hdt.value = dt->value;
     }
+    if (dt->type == DTT_SIMD)
+        hdt.lane = dt->array_type->type;
+    return hdt;
 }
 
-static datatype_t* impl_readdt(FILE* in)
-{
-    char visibility = read;
-    char dtt = read;
-    char size = read;
-    char usign = read;
-    char* name = NULL;
-    char depth = 0;
-    if (dtt == DTT_OBJECT)
-        name = readstr;
-    if (dtt == DTT_ARRAY)
-        depth = read;
-    datatype_t* dt = calloc(1, sizeof(datatype_t));
-    dt->visibility = visibility;
-    dt->type = dtt;
-    dt->size = size;
-    dt->usign = usign;
-    dt->name = name;
-    dt->depth = 0;
-    for (int i = 0; i < depth; i++)
+static void header_write_members(header_writer_t* w, header_record_t* record, vector_t* vars)
+{
+    record->member_start = w->members->size;
+    record->member_count = vars->size;
+    for (int i = 0; i < vars->size; i++)
     {
-        datatype_t* array = calloc(1, sizeof(datatype_t));
-        array->visibility = visibility;
-        array->type = DTT_ARRAY;
-        array->size = 8;
-        array->usign = false;
-        array->name = NULL;
-        array->depth = i + 1;
-        array->array_type = dt;
-        dt = array;
+        ast_node_t* var = vector_get(vars, i);
+        header_member_t* member = calloc(1, sizeof(header_member_t));
+        member->name = header_write_string(w, var->var_name);
+        member->datatype = header_write_datatype(w, var->datatype);
+        vector_push(w->members, member);
     }
-    return dt;
 }
 
-static ast_node_t* impl_readfunc(FILE* in, char* filename, char* ident, ast_node_t* bp)
-{
-    datatype_t* rettype = readdt;
-    char func_type = read;
-    bool lowlvl = read;
-    short operator = readi16;
-    short arg_count = readi16;
-    vector_t* args = vector_init(arg_count, 1);
-    for (int i = 0; i < arg_count; i++)
-    {
-        char* name = readstr;
-        datatype_t* dt = readdt;
-        vector_push(args, ast_lvar_init(dt, NULL, name, NULL, filename));
-    }
-    ast_node_t* node = ast_builtin_init(rettype, ident, args, filename, 'u');
-    node->func_type = func_type;
-    node->operator = operator;
-    node->func_label = make_func_label(filename, node, bp);
-    if (lowlvl)
-    {
-        int label_len = strlen(node->func_label);
-        char* lowlvl_label = malloc(label_len + 1);
-        memcpy(lowlvl_label, node->func_label, label_len);
-        lowlvl_label[label_len] = '\0';
-        for (int i = 0; i < label_len + 1; i++)
-        {
-            if (lowlvl_label[i] == '@')
-                lowlvl_label[i] = '_';
-        }
-        node->lowlvl_label = lowlvl_label;
-    }
-    else
-        node->lowlvl_label = NULL;
-    return node;
+static header_record_t* header_write_func(header_writer_t* w, ast_node_t* func)
+{
+    header_record_t* record = calloc(1, sizeof(header_record_t));
+    record->name = header_write_string(w, func->func_name);
+    record->decl_type = AST_FUNC_DEFINITION;
+    record->operator = func->operator;
+    record->func_type = func->func_type;
+    record->lowlvl = func->lowlvl_label != NULL;
+    record->datatype = header_write_datatype(w, func->datatype);
+    header_write_members(w, record, func->params);
+    return vector_push(w->records, record);
 }
 
 // wb mode on fopen for this function
 void write_header(FILE* out, map_t* genv)
 {
+    header_writer_t w = {
+        .strings = buffer_init(256, 256),
+        .string_offsets = map_init(NULL, 64),
+        .records = vector_init(32, 32),
+        .members = vector_init(64, 64)
+    };
+    buffer_append(w.strings, '\0'); // offset 0 is the empty string
+    header_file_t file = { .version = HEADER_VERSION };
+    memcpy(file.magic, HEADER_MAGIC, 4);
+    vector_t* blueprints = vector_init(4, 4); // node, record pairs
     for (int i = 0; i < genv->capacity; i++)
     {
-        char* key = genv->key[i];
-        if (!key)
-            continue;
-        ast_node_t* node = genv->value[i];
+        ast_node_t* node = genv->key[i] ? genv->value[i] : NULL;
         if (!node)
             continue;
-        if (node->type == AST_FUNC_DEFINITION && node->extrn)
-            continue;
-        writei16(node->type);
         switch (node->type)
         {
-            case AST_GVAR:
+            case AST_FUNC_DEFINITION:
             {
-                writestr(node->var_name);
+                if (node->extrn)
+                    break;
+                if (header_write_func(&w, node)->lowlvl)
+                    file.flags |= HEADER_HAS_LOWLVL;
                 break;
             }
-            case AST_FUNC_DEFINITION:
+            case AST_BLUEPRINT:
             {
-                writestr(node->func_name);
+                if (node->residing) // imported
+                    break;
+                header_record_t* record = calloc(1, sizeof(header_record_t));
+                record->name = header_write_string(&w, node->bp_name);
+                record->decl_type = AST_BLUEPRINT;
+                record->bp_size = node->bp_size;
+                record->datatype = header_write_datatype(&w, node->bp_datatype);
+                header_write_members(&w, record, node->inst_variables);
+                vector_push(w.records, record);
+                vector_push(blueprints, node);
+                vector_push(blueprints, record);
                 break;
             }
-            case AST_BLUEPRINT:
+            case AST_GVAR:
             {
-                writestr(node->bp_name);
+                header_record_t* record = calloc(1, sizeof(header_record_t));
+                record->name = header_write_string(&w, node->var_name);
+                record->decl_type = AST_GVAR;
+                record->datatype = header_write_datatype(&w, node->datatype);
+                vector_push(w.records, record);
                 break;
             }
         }
-        writedt(node->datatype);
-        switch (node->type)
+    }
+    file.symbol_count = w.records->size;
+    // methods go after every top-level symbol so they stay out of the hash index
+    for (int i = 0; i < blueprints->size; i += 2)
+    {
+        ast_node_t* bp = vector_get(blueprints, i);
+        header_record_t* record = vector_get(blueprints, i + 1);
+        record->method_start = w.records->size;
+        record->method_count = bp->methods->size;
+        for (int j = 0; j < bp->methods->size; j++)
         {
-            case AST_FUNC_DEFINITION:
-                writefunc(node);
-                break;
-            case AST_BLUEPRINT:
-            {
-                write(node->bp_datatype->visibility);
-                writei32(node->bp_size);
-                writei16(node->inst_variables->size);
-                for (int i = 0; i < node->inst_variables->size; i++)
-                {
-                    ast_node_t* inst_var = vector_get(node->inst_variables, i);
-                    writestr(inst_var->var_name);
-                    writedt(inst_var->datatype);
-                }
-                writei16(node->methods->size);
-                for (int i = 0; i < node->methods->size; i++)
-                {
-                    ast_node_t* method = vector_get(node->methods, i);
-                    writestr(method->func_name);
-                    writefunc(method);
-                }
-            }
+            if (header_write_func(&w, vector_get(bp->methods, j))->lowlvl)
+                file.flags |= HEADER_HAS_LOWLVL;
         }
     }
+    file.record_count = w.records->size;
+    file.bucket_count = 1;
+    while (file.bucket_count < file.symbol_count * 2)
+        file.bucket_count <<= 1;
+    unsigned int* buckets = calloc(file.bucket_count, sizeof(unsigned int));
+    for (int i = file.symbol_count - 1; i >= 0; i--) // backwards so chains keep genv order
+    {
+        header_record_t* record = vector_get(w.records, i);
+        unsigned int bucket = header_hash(w.strings->data + record->name) & (file.bucket_count - 1);
+        record->next = buckets[bucket];
+        buckets[bucket] = i + 1;
+    }
+    file.member_count = w.members->size;
+    file.string_size = w.strings->size;
+    fwrite(&file, sizeof(file), 1, out);
+    fwrite(buckets, sizeof(unsigned int), file.bucket_count, out);
+    for (int i = 0; i < w.records->size; i++)
+        fwrite(vector_get(w.records, i), sizeof(header_record_t), 1, out);
+    for (int i = 0; i < w.members->size; i++)
+        fwrite(vector_get(w.members, i), sizeof(header_member_t), 1, out);
+    fwrite(w.strings->data, 1, w.strings->size, out);
+    free(buckets);
+    vector_delete(blueprints);
+    vector_delete(w.records);
+    vector_delete(w.members);
+    map_delete(w.string_offsets);
+    buffer_delete(w.strings);
 }
 
-vector_t* read_header(FILE* in, char* filename)
+static char* header_load(char* path, size_t* size)
 {
-    vector_t* decls = vector_init(25, 10);
-    for (;;)
+    #ifdef HEADER_MMAP
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0)
+        errorc("could not open header '%s'", path);
+    *size = st.st_size;
+    char* data = *size ? mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    close(fd);
+    if (data == MAP_FAILED)
+        errorc("could not map header '%s'", path);
+    return data;
+    #elif defined(HEADER_MAPVIEW)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER file_size;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &file_size))
+        errorc("could not open header '%s'", path);
+    *size = file_size.QuadPart;
+    char* data = NULL;
+    if (*size)
     {
-        short decl_type;
-        if (fread(&decl_type, sizeof(short), 1, in) < 1)
-            break;
-        char* ident = readstr;
-        datatype_t* dt = readdt;
-        switch (decl_type)
+        // the view keeps the mapping alive on its own
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (mapping)
+            CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    if (*size && !data)
+        errorc("could not map header '%s'", path);
+    return data;
+    #else
+    FILE* in = fopen(path, "rb");
+    if (!in)
+        errorc("could not open header '%s'", path);
+    fseek(in, 0, SEEK_END);
+    *size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    char* data = malloc(*size ? *size : 1);
+    if (fread(data, 1, *size, in) != *size)
+        errorc("could not read header '%s'", path);
+    fclose(in);
+    return data;
+    #endif
+}
+
+header_t* open_header(char* path, char* filename)
+{
+    header_t* h = calloc(1, sizeof(header_t));
+    h->filename = filename;
+    h->data = header_load(path, &h->size);
+    h->file = (header_file_t*) h->data;
+    if (h->size < sizeof(header_file_t) || memcmp(h->file->magic, HEADER_MAGIC, 4) || h->file->version != HEADER_VERSION)
+        errorc("'%s' was written by a different version of sgcllc, rebuild it", path);
+    h->buckets = (unsigned int*) (h->file + 1);
+    h->records = (header_record_t*) (h->buckets + h->file->bucket_count);
+    h->members = (header_member_t*) (h->records + h->file->record_count);
+    h->strings = (char*) (h->members + h->file->member_count);
+    if (h->strings + h->file->string_size != h->data + h->size)
+        errorc("corrupted header '%s'", path);
+    h->nodes = calloc(h->file->record_count, sizeof(ast_node_t*));
+    return h;
+}
+
+// windows won't write over a file that's still mapped, so a header has to be let go of before it's rewritten. nodes
+// already made from it keep their names in the mapping and go with it
+void close_header(header_t* h)
+{
+    #ifdef HEADER_MMAP
+    if (h->size)
+        munmap(h->data, h->size);
+    #elif defined(HEADER_MAPVIEW)
+    if (h->size)
+        UnmapViewOfFile(h->data);
+    #else
+    free(h->data);
+    #endif
+    free(h->nodes);
+    free(h);
+}
+
+bool header_has_lowlvl(header_t* h)
+{
+    return h->file->flags & HEADER_HAS_LOWLVL;
+}
+
+static datatype_t* header_read_datatype(header_t* h, header_datatype_t* hdt)
+{
+    datatype_t* dt = calloc(1, sizeof(datatype_t));
+    dt->visibility = hdt->visibility;
+    dt->type = hdt->type;
+    dt->size = hdt->size;
+    dt->usign = hdt->usign;
+    dt->value = hdt->value;
+    dt->name = hdt->name ? h->strings + hdt->name : NULL; // shares memory with depth
+    if (dt->type == DTT_SIMD)
+        dt->array_type = simd_datatype(hdt->lane, hdt->size)->array_type;
+    for (int i = 0; i < hdt->depth; i++)
+    {
+        datatype_t* array = calloc(1, sizeof(datatype_t));
+        array->visibility = hdt->visibility;
+        array->type = DTT_ARRAY;
+        array->size = 8;
+        array->usign = false;
+        array->name = NULL;
+        array->depth = i + 1;
+        array->soa = !i && hdt->soa;
+        array->array_type = dt;
+        dt = array;
+    }
+    if (hdt->slice)
+    {
+        datatype_t* slice = calloc(1, sizeof(datatype_t));
+        slice->visibility = hdt->visibility;
+        slice->type = DTT_SLICE;
+        slice->size = 16;
+        slice->depth = 1;
+        slice->array_type = dt;
+        dt = slice;
+    }
+    return dt;
+}
+
+static vector_t* header_read_members(header_t* h, header_record_t* record)
+{
+    vector_t* vars = vector_init(record->member_count ? record->member_count : 1, 1);
+    for (int i = 0; i < record->member_count; i++)
+    {
+        header_member_t* member = h->members + record->member_start + i;
+        vector_push(vars, ast_lvar_init(header_read_datatype(h, &member->datatype), NULL, h->strings + member->name, NULL, h->filename));
+    }
+    return vars;
+}
+
+static ast_node_t* header_read_func(header_t* h, header_record_t* record, ast_node_t* bp)
+{
+    ast_node_t* node = ast_builtin_init(header_read_datatype(h, &record->datatype), h->strings + record->name,
+        header_read_members(h, record), h->filename, 'u');
+    node->func_type = record->func_type;
+    node->operator = record->operator;
+    node->func_label = make_func_label(h->filename, node, bp);
+    if (record->lowlvl)
+    {
+        char* lowlvl_label = strdup(node->func_label);
+        for (char* c = lowlvl_label; *c; c++)
         {
-            case AST_FUNC_DEFINITION:
-            {
-                vector_push(decls, readfunc(NULL));
-                break;
-            }
-            case AST_BLUEPRINT:
-            {
-                char visibility = read;
-                int size = readi32;
-                short inst_var_count = readi16;
-                ast_node_t* bp = vector_push(decls, ast_blueprint_init(NULL, ident, NULL));
-                bp->residing = filename;
-                vector_t* inst_vars = vector_init(10, 5);
-                for (int i = 0; i < inst_var_count; i++)
-                {
-                    char* ident = readstr;
-                    datatype_t* dt = readdt;
-                    vector_push(inst_vars, ast_lvar_init(dt, NULL, ident, NULL, filename));
-                }
-                short method_count = readi16;
-                vector_t* methods = vector_init(10, 5);
-                for (int i = 0; i < methods->size; i++)
-                {
-                    char* ident = readstr;
-                    vector_push(methods, readfunc(bp));
-                }
-                datatype_t* dt = calloc(1, sizeof(datatype_t));
-                dt->array_type = NULL;
-                dt->depth = 0;
-                dt->length = NULL;
-                dt->name = ident;
-                dt->size = 8;
-                dt->type = DTT_OBJECT;
-                dt->usign = false;
-                dt->visibility = visibility;
-                bp->bp_datatype = dt;
-                bp->inst_variables = inst_vars;
-                bp->methods = methods;
-                bp->bp_size = size;
-                vector_push(decls, bp);
-                break;
-            }
-            case AST_GVAR:
+            if (*c == '@')
+                *c = '_';
+        }
+        node->lowlvl_label = lowlvl_label;
+    }
+    else
+        node->lowlvl_label = NULL;
+    return node;
+}
+
+static ast_node_t* header_materialize(header_t* h, unsigned int index)
+{
+    if (h->nodes[index])
+        return h->nodes[index];
+    header_record_t* record = h->records + index;
+    switch (record->decl_type)
+    {
+        case AST_FUNC_DEFINITION:
+            return h->nodes[index] = header_read_func(h, record, NULL);
+        case AST_BLUEPRINT:
+        {
+            char* name = h->strings + record->name;
+            datatype_t* dt = calloc(1, sizeof(datatype_t));
+            dt->array_type = NULL;
+            dt->depth = 0;
+            dt->length = NULL;
+            dt->name = name;
+            dt->value = record->datatype.value;
+            dt->size = dt->value ? record->bp_size : 8;
+            dt->type = DTT_OBJECT;
+            dt->usign = false;
+            dt->visibility = record->datatype.visibility;
+            ast_node_t* bp = h->nodes[index] = ast_blueprint_init(NULL, name, dt);
+            bp->residing = h->filename;
+            bp->inst_variables = header_read_members(h, record);
+            bp->bp_size = record->bp_size;
+            // laid out the same way parser_read_blueprint did
+            for (int i = 0, offset = 0; i < bp->inst_variables->size; i++)
             {
-                errorc(0, 0, "tell dev to add global variables lol");
-                break;
+                ast_node_t* inst_var = vector_get(bp->inst_variables, i);
+                inst_var->voffset = offset;
+                offset += max(2, inst_var->datatype->size);
             }
+            for (int i = 0; i < record->method_count; i++)
+                vector_push(bp->methods, h->nodes[record->method_start + i] = header_read_func(h, h->records + record->method_start + i, bp));
+            return bp;
         }
+        default:
+            errorc("tell dev to add global variables lol");
+    }
+    return NULL;
+}
+
+#define header_is_eager(record) ((record)->decl_type != AST_FUNC_DEFINITION || (record)->operator != -1)
+
+// pushes every plain function called name, nodes are made once and shared by every parser that imports h
+void header_find(header_t* h, char* name, vector_t* found)
+{
+    int phase = report_switch(PHASE_IMPORT);
+    vector_t* tracked = ast_track(NULL); // these outlive whatever function asked for them
+    unsigned int bucket = header_hash(name) & (h->file->bucket_count - 1);
+    for (unsigned int i = h->buckets[bucket]; i; i = h->records[i - 1].next)
+    {
+        header_record_t* record = h->records + i - 1;
+        if (header_is_eager(record) || strcmp(h->strings + record->name, name))
+            continue;
+        vector_push(found, header_materialize(h, i - 1));
+    }
+    ast_track(tracked);
+    report_switch(phase);
+}
+
+// operator overloads are looked up by signature instead of by name, and blueprints by type name, so those can't wait
+void header_find_eager(header_t* h, vector_t* found)
+{
+    int phase = report_switch(PHASE_IMPORT);
+    for (unsigned int i = 0; i < h->file->symbol_count; i++)
+    {
+        if (!header_is_eager(h->records + i))
+            continue;
+        vector_push(found, header_materialize(h, i));
     }
-    return decls;
+    report_switch(phase);
 }
\ No newline at end of file
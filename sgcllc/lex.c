@@ -45,9 +45,16 @@ static int lex_peek(lexer_t* lex)
     return lex->peek ? lex->peek : (lex->peek = fgetc(lex->file));
 }
 
+// the file is taken away once everything in it has been lexed
 bool lex_eof(lexer_t* lex)
 {
-    return feof(lex->file);
+    return !lex->file || feof(lex->file);
+}
+
+// keywords an operand can end with, a - or ++ after one of these is binary or postfix (the type of a cast included)
+static bool lex_closes_operand(token_t* top)
+{
+    return top->id == ')' || top->id == ']' || top->id == KW_TRUE || top->id == KW_FALSE || (top->id >= KW_VOID && top->id <= KW_I64X4);
 }
 
 void lex_read_token(lexer_t* lex)
@@ -155,9 +162,7 @@ void lex_read_token(lexer_t* lex)
                     buffer_append(buffer, (char) lex_read(lex));
                     break;
                 }
-                escaping = 0;
-                if (c == '\\')
-                    escaping = 1;
+                escaping = !escaping && c == '\\'; // \\ is an escaped backslash, not the start of another escape
                 buffer_append(buffer, (char) lex_read(lex));
             }
             buffer_append(buffer, '\0');
@@ -167,7 +172,7 @@ void lex_read_token(lexer_t* lex)
         }
         case '\'':
         {
-            buffer_t* buffer = buffer_init(3, 0);
+            buffer_t* buffer = buffer_init(4, 0);
             buffer_append(buffer, c);
             buffer_append(buffer, (char) lex_read(lex));
             if (lex_peek(lex) != '\'')
@@ -200,6 +205,13 @@ void lex_read_token(lexer_t* lex)
             {
                 c = OP_SCOPE;
                 lex_read(lex);
+                // the string library shares its name with the keyword, so string:: is a namespace
+                token_t* top = vector_top(lex->output);
+                if (top && top->type == TT_KEYWORD && top->id == KW_STRING)
+                {
+                    top->type = TT_IDENTIFIER;
+                    top->content = "string";
+                }
             }
             vector_push(lex->output, id_token_init(TT_KEYWORD, c, lex->offset, lex->row, lex->col));
             break;
@@ -291,16 +303,16 @@ void lex_read_token(lexer_t* lex)
             if (vector_top(lex->output) != NULL)
             {
                 token_t* top = vector_top(lex->output);
-                if (top->type == TT_KEYWORD && top->id != ')')
+                if (top->type == TT_KEYWORD && !lex_closes_operand(top))
                     c = OP_MINUS;
                 if (lex_peek(lex) == OP_SUB)
                 {
-                    if (top->type == TT_KEYWORD && top->id != ')')
+                    if (top->type == TT_KEYWORD && !lex_closes_operand(top))
                     {
                         c = OP_PREFIX_DECREMENT;
                         lex_read(lex);
                     }
-                    else if (top->type == TT_IDENTIFIER || (top->type == TT_KEYWORD && top->id == ')'))
+                    else if (top->type == TT_IDENTIFIER || (top->type == TT_KEYWORD && lex_closes_operand(top)))
                     {
                         c = OP_POSTFIX_DECREMENT;
                         lex_read(lex);
@@ -325,12 +337,12 @@ void lex_read_token(lexer_t* lex)
             if (lex_peek(lex) == OP_ADD)
             {
                 token_t* top = vector_top(lex->output);
-                if (top->type == TT_KEYWORD && top->id != ')')
+                if (top->type == TT_KEYWORD && !lex_closes_operand(top))
                 {
                     c = OP_PREFIX_INCREMENT;
                     lex_read(lex);
                 }
-                else if (top->type == TT_IDENTIFIER || (top->type == TT_KEYWORD && top->id == ')'))
+                else if (top->type == TT_IDENTIFIER || (top->type == TT_KEYWORD && lex_closes_operand(top)))
                 {
                     c = OP_POSTFIX_INCREMENT;
                     lex_read(lex);
@@ -406,7 +418,24 @@ void lex_delete(lexer_t* lex)
     free(lex);
 }
 
+// tokens that haven't been lexed yet are lexed on the spot, so the parser can run without lexing the whole file first
+// one extra is lexed since a token can still change because of the one after it (string::)
 token_t* lex_get(lexer_t* lex, int index)
 {
-    return (token_t*) vector_get(lex->output, index);
+    while (index - lex->released + 1 >= lex->output->size && !lex_eof(lex))
+        lex_read_token(lex);
+    return (token_t*) vector_get(lex->output, index - lex->released);
+}
+
+// drops the tokens before index, their locations and contents are left alone since the ast points at them
+void lex_release(lexer_t* lex, int index)
+{
+    int count = min(index - lex->released, lex->output->size - 1); // the newest one stays for lex_read_token to look back at
+    if (count <= 0)
+        return;
+    for (int i = 0; i < count; i++)
+        free(lex->output->data[i]);
+    memmove(lex->output->data, lex->output->data + count, (lex->output->size - count) * sizeof(void*));
+    lex->output->size -= count;
+    lex->released += count;
 }
\ No newline at end of file
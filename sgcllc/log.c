@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
 
 #include "sgcllc.h"
 
@@ -24,6 +26,60 @@
 #define chgcolor(file, fg, bg, attr) fprintf(file, "%c[%d;%d;%dm", 0x1B, attr, fg + 30, bg + 40)
 #define resetcolor(file) chgcolor(file, WHITE, BLACK, RESET)
 
+static char* trace_names[TRACE_COUNT] = { "lexer", "parser", "overloads", "emitter", "driver" };
+
+int trace_levels[TRACE_COUNT];
+
+// spec is a comma-separated list of categories (or all), each optionally followed by :level (1 if it isn't),
+// e.g. lexer,overloads:2. NULL or an empty spec turns everything off
+void trace_setup(char* spec)
+{
+    for (int i = 0; i < TRACE_COUNT; i++)
+        trace_levels[i] = 0;
+    while (spec && *spec)
+    {
+        int length = strcspn(spec, ",:");
+        int level = TRACE_INFO;
+        char* next = spec + length;
+        if (*next == ':')
+        {
+            level = strtol(next + 1, &next, 10);
+            if (level < 0 || (*next && *next != ','))
+                errorc("invalid trace level in '%s'", spec);
+        }
+        bool all = length == 3 && !strncmp(spec, "all", 3), found = all;
+        for (int i = 0; i < TRACE_COUNT; i++)
+        {
+            if (all || (strlen(trace_names[i]) == length && !strncmp(spec, trace_names[i], length)))
+            {
+                trace_levels[i] = level;
+                found = true;
+            }
+        }
+        if (!found)
+            errorc("unknown trace category '%.*s'", length, spec);
+        spec = *next ? next + 1 : next;
+    }
+}
+
+static __thread jmp_buf* recovery = NULL;
+
+// errors jump back here instead of exiting while env is set, the server can't go down with a bad file.
+// it's per thread so emitter workers can catch their own, returns what was set before
+jmp_buf* error_recover(jmp_buf* env)
+{
+    jmp_buf* previous = recovery;
+    recovery = env;
+    return previous;
+}
+
+void error_exit(void)
+{
+    if (recovery)
+        longjmp(*recovery, 1);
+    exit(EXIT_FAILURE);
+}
+
 void errorf(int row, int col, const char* what, char* fmt, va_list args)
 {
     fprintf(stderr, "sgcllc: ");
@@ -49,7 +105,7 @@ void errorl(lexer_t* lex, char* fmt, ...)
     va_start(args, fmt);
     errorf(lex->row, lex->col, "lexer", fmt, args);
     va_end(args);
-    exit(EXIT_FAILURE);
+    error_exit();
 }
 
 void errorp(int row, int col, char* fmt, ...)
@@ -58,7 +114,7 @@ void errorp(int row, int col, char* fmt, ...)
     va_start(args, fmt);
     errorf(row, col, "parser", fmt, args);
     va_end(args);
-    exit(EXIT_FAILURE);
+    error_exit();
 }
 
 void errore(int row, int col, char* fmt, ...)
@@ -67,7 +123,7 @@ void errore(int row, int col, char* fmt, ...)
     va_start(args, fmt);
     errorf(row, col, "emitter", fmt, args);
     va_end(args);
-    exit(EXIT_FAILURE);
+    error_exit();
 }
 
 void errorc(char* fmt, ...)
@@ -76,7 +132,7 @@ void errorc(char* fmt, ...)
     va_start(args, fmt);
     errorf(0, 0, "compiler", fmt, args);
     va_end(args);
-    exit(EXIT_FAILURE);
+    error_exit();
 }
 
 void warnf(int row, int col, char* fmt, ...)
@@ -99,14 +155,4 @@ void warnf(int row, int col, char* fmt, ...)
     vprintf(fmt, args);
     va_end(args);
     printf("\n");
-}
-
-void debugf(char* fmt, ...)
-{
-    #ifdef SGCLLC_DEBUG
-    va_list args;
-    va_start(args, fmt);
-    vprintf(fmt, args);
-    va_end(args);
-    #endif
 }
\ No newline at end of file
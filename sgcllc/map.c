@@ -77,10 +77,9 @@ void* map_put(map_t* map, char* k, void* v)
 
 void* map_get_local(map_t* map, char* k)
 {
-    for (int i = hash(k) % map->capacity; map->key[i] != NULL; i++)
+    for (int i = hash(k) % map->capacity; map->key[i] != NULL; i = (i + 1) % map->capacity)
     {
-        if (i >= map->capacity) i = 0;
-        if (map->key[i] && !strcmp(map->key[i], k))
+        if (!strcmp(map->key[i], k))
             return map->value[i];
     }
     return NULL;
@@ -99,9 +98,8 @@ void* map_get(map_t* map, char* k)
 // does not deallocate memory at K
 bool map_erase(map_t* map, char* k)
 {
-    for (int i = hash(k) % map->capacity; map->key[i] != NULL; i++)
+    for (int i = hash(k) % map->capacity; map->key[i] != NULL; i = (i + 1) % map->capacity)
     {
-        if (i >= map->capacity) i = 0;
         if (!strcmp(map->key[i], k))
         {
             map->key[i] = map->value[i] = NULL;
@@ -7,7 +7,7 @@
 
 #define NO_TERMINATOR -2
 
-#define isarithtype(type) (type != DTT_ARRAY && type != DTT_STRING && type != DTT_OBJECT)
+#define isarithtype(type) (type != DTT_ARRAY && type != DTT_STRING && type != DTT_OBJECT && type != DTT_SLICE && type != DTT_SIMD)
 
 typedef struct 
 {
@@ -17,6 +17,7 @@ typedef struct
 } header_plus_t;
     
 static ast_node_t* ast_get_by_token(parser_t* p, token_t* token);
+datatype_t* get_default_type(int kw);
 int parser_get_datatype_type(parser_t* p);
 static bool parser_is_func_definition(parser_t* p);
 static bool parser_is_var_decl(parser_t* p);
@@ -45,10 +46,24 @@ datatype_t* t_f64 = &(datatype_t){ VT_PUBLIC, DTT_F64, 8, false };
 datatype_t* t_string = &(datatype_t){ VT_PUBLIC, DTT_STRING, 8, false };
 datatype_t* t_array = &(datatype_t){ VT_PUBLIC, DTT_ARRAY, 8, false };
 datatype_t* t_object = &(datatype_t){ VT_PUBLIC, DTT_OBJECT, 8, false };
+// the simd types keep their lanes' type where arrays keep their elements', the 32 byte ones need --avx2
+datatype_t* t_f32x4 = &(datatype_t){ VT_PUBLIC, DTT_SIMD, 16, false, .array_type = &(datatype_t){ VT_PUBLIC, DTT_F32, 4, false } };
+datatype_t* t_f64x2 = &(datatype_t){ VT_PUBLIC, DTT_SIMD, 16, false, .array_type = &(datatype_t){ VT_PUBLIC, DTT_F64, 8, false } };
+datatype_t* t_i32x4 = &(datatype_t){ VT_PUBLIC, DTT_SIMD, 16, false, .array_type = &(datatype_t){ VT_PUBLIC, DTT_I32, 4, false } };
+datatype_t* t_i64x2 = &(datatype_t){ VT_PUBLIC, DTT_SIMD, 16, false, .array_type = &(datatype_t){ VT_PUBLIC, DTT_I64, 8, false } };
+datatype_t* t_f32x8 = &(datatype_t){ VT_PUBLIC, DTT_SIMD, 32, false, .array_type = &(datatype_t){ VT_PUBLIC, DTT_F32, 4, false } };
+datatype_t* t_f64x4 = &(datatype_t){ VT_PUBLIC, DTT_SIMD, 32, false, .array_type = &(datatype_t){ VT_PUBLIC, DTT_F64, 8, false } };
+datatype_t* t_i32x8 = &(datatype_t){ VT_PUBLIC, DTT_SIMD, 32, false, .array_type = &(datatype_t){ VT_PUBLIC, DTT_I32, 4, false } };
+datatype_t* t_i64x4 = &(datatype_t){ VT_PUBLIC, DTT_SIMD, 32, false, .array_type = &(datatype_t){ VT_PUBLIC, DTT_I64, 8, false } };
+
+// simd intrinsics, their types are worked out per call since they take any simd type
+static char* simd_intrinsics[] = { "hsum", "hmin", "hmax", "vmin", "vmax", "shuffle", "select", "any", "all" };
 
 void set_up_builtins(void)
 {
     builtins = map_init(NULL, 15);
+    for (int i = 0; i < sizeof(simd_intrinsics) / sizeof(char*); i++)
+        map_put(builtins, simd_intrinsics[i], ast_builtin_init(t_void, simd_intrinsics[i], vector_init(1, 1), NULL, 'v'));
 }
 
 int precedence(int op)
@@ -112,6 +127,7 @@ int precedence(int op)
         case OP_MINUS:
         case OP_PREFIX_INCREMENT:
         case OP_PREFIX_DECREMENT:
+        case OP_SPAWN:
             return 3;
         case OP_POSTFIX_INCREMENT:
         case OP_POSTFIX_DECREMENT:
@@ -189,8 +205,14 @@ bool same_datatype(parser_t* p, datatype_t* t1, datatype_t* t2)
 {
     if (!t1 || !t2)
         return false;
+    if (t1->type == DTT_ARRAY && t2->type == DTT_ARRAY && t1->soa != t2->soa)
+        return false;
     if (t1->type == DTT_OBJECT && t2->type == DTT_OBJECT)
         return !strcmp(t1->name, t2->name);
+    if (t1->type == DTT_SLICE && t2->type == DTT_SLICE)
+        return same_datatype(p, t1->array_type, t2->array_type);
+    if (t1->type == DTT_SIMD && t2->type == DTT_SIMD)
+        return t1->size == t2->size && t1->array_type->type == t2->array_type->type;
     return t1->type == t2->type;
 }
 
@@ -198,8 +220,14 @@ bool convertible_datatype(parser_t* p, datatype_t* t1, datatype_t* t2)
 {
     if (!t1 || !t2)
         return false;
+    if (t1->type == DTT_ARRAY && t2->type == DTT_ARRAY && t1->soa != t2->soa)
+        return false;
     if (t1->type == DTT_OBJECT && t2->type == DTT_OBJECT)
         return !strcmp(t1->name, t2->name);
+    if (t1->type == DTT_SLICE && t2->type == DTT_SLICE)
+        return same_datatype(p, t1->array_type, t2->array_type);
+    if (t1->type == DTT_SIMD && t2->type == DTT_SIMD)
+        return same_datatype(p, t1, t2);
     if (isarithtype(t1->type) && isarithtype(t2->type))
         return true;
     return t1->type == t2->type;
@@ -212,6 +240,38 @@ datatype_t* clone_datatype(datatype_t* dt)
     return new;
 }
 
+// the simd type with lanes of type lane filling size bytes, null if there isn't one
+datatype_t* simd_datatype(datatype_type lane, int size)
+{
+    for (int kw = KW_F32X4; kw <= KW_I64X4; kw++)
+    {
+        datatype_t* dt = get_default_type(kw);
+        if (dt->array_type->type == lane && dt->size == size)
+            return dt;
+    }
+    return NULL;
+}
+
+// comparing simd values gives a mask, every bit of a lane set where it held
+static datatype_t* simd_mask_datatype(datatype_t* dt)
+{
+    datatype_type lane = dt->array_type->type;
+    if (isfloattype(lane))
+        lane = lane == DTT_F32 ? DTT_I32 : DTT_I64;
+    return simd_datatype(lane, dt->size);
+}
+
+static datatype_t* slice_datatype(datatype_t* element)
+{
+    datatype_t* dt = calloc(1, sizeof(datatype_t));
+    dt->visibility = VT_PRIVATE;
+    dt->type = DTT_SLICE;
+    dt->size = 16; // pointer and then length
+    dt->depth = 1;
+    dt->array_type = element;
+    return dt;
+}
+
 char* make_label(parser_t* p, void* content)
 {
     buffer_t* namebuffer = buffer_init(4, 2);
@@ -232,6 +292,16 @@ char* make_label(parser_t* p, void* content)
     return label;
 }
 
+static char* parser_constant(parser_t* p, constant_t* constant)
+{
+    constant_t* pooled = pool_put(p->constants, constant);
+    if (pooled != constant)
+        constant_delete(constant);
+    else
+        constant->label = make_label(p, NULL);
+    return pooled->label;
+}
+
 char* make_func_label(char* filename, ast_node_t* func, ast_node_t* current_blueprint)
 {
     buffer_t* buffer = buffer_init(15, 10);
@@ -269,20 +339,48 @@ char* make_func_label(char* filename, ast_node_t* func, ast_node_t* current_blue
         switch (dt->type)
         {
             types;
+            case DTT_SIMD:
+            {
+                // the lane type and how many lanes, like the keyword
+                char lbuffer[33];
+                itos(dt->size / dt->array_type->size, lbuffer);
+                dt = dt->array_type;
+                switch (dt->type)
+                {
+                    types;
+                }
+                buffer_append(buffer, 'x');
+                buffer_string(buffer, lbuffer);
+                break;
+            }
             case DTT_ARRAY:
             {
-                datatype_t* basetype = dt;
-                for (; dt->array_type != NULL; dt = dt->array_type);
-                switch (basetype->type)
+                // the element type and how many brackets it's under, declared arrays don't fill in depth
+                int depth = 0;
+                if (dt->soa)
+                    buffer_string(buffer, "soa$");
+                for (; dt->type == DTT_ARRAY; dt = dt->array_type)
+                    depth++;
+                switch (dt->type)
                 {
                     types;
                 }
                 buffer_string(buffer, "$$");
                 char dbuffer[33];
-                itos(dt->depth, dbuffer);
+                itos(depth, dbuffer);
                 buffer_string(buffer, dbuffer);
                 break;
             }
+            case DTT_SLICE:
+            {
+                buffer_string(buffer, "slice$");
+                dt = dt->array_type;
+                switch (dt->type)
+                {
+                    types;
+                }
+                break;
+            }
         }
     }
     buffer_append(buffer, '\0');
@@ -298,11 +396,15 @@ parser_t* parser_init(lexer_t* lex)
     p->genv = map_init(NULL, 50);
     p->lenv = NULL;
     p->labels = map_init(NULL, 20);
+    p->constants = pool_init();
     p->lex = lex;
     p->oindex = 0;
     p->userexterns = vector_init(5, 5);
     p->cexterns = vector_init(5, 5);
     p->links = vector_init(5, 5);
+    p->imports = vector_init(5, 5);
+    p->resolved = map_init(NULL, 50);
+    p->operators = vector_init(5, 5);
     p->funcs = map_init(NULL, 50);
     p->entry = "main";
     p->has_lowlvl = false;
@@ -360,14 +462,14 @@ static ast_node_t* ast_get_by_token(parser_t* p, token_t* token)
             datatype_t* dt = get_arith_type(token);
             if (isfloattype(dt->type))
             {
-                char* label = make_label(p, token->content);
+                char* label = parser_constant(p, constant_float_init(dt, token->content));
                 return ast_fliteral_init(dt, token->loc, atof(token->content), label);
             }
             return ast_iliteral_init(dt, token->loc, read_iliteral(token->content, token->loc));
         }
         case TT_STRING_LITERAL:
         {
-            char* label = make_label(p, token->content);
+            char* label = parser_constant(p, constant_init(CONSTANT_STRING, token->content, 0, 0));
             return ast_sliteral_init(t_string, token->loc, token->content, label);
         }
         case TT_KEYWORD:
@@ -389,9 +491,11 @@ static ast_node_t* ast_get_by_token(parser_t* p, token_t* token)
 
 static token_t* parser_get(parser_t* p)
 {
-    if (p->oindex >= p->lex->output->size)
+    token_t* token = lex_get(p->lex, p->oindex);
+    if (token == NULL)
         return NULL;
-    return lex_get(p->lex, p->oindex++);
+    p->oindex++;
+    return token;
 }
 
 static void parser_unget(parser_t* p)
@@ -408,8 +512,6 @@ static token_t* parser_peek(parser_t* p)
 
 static token_t* parser_far_peek(parser_t* p, int distance)
 {
-    if (p->oindex + distance - 1 >= p->lex->output->size)
-        return NULL;
     return lex_get(p->lex, p->oindex + distance - 1);
 }
 
@@ -463,7 +565,7 @@ static token_t* parser_expect_content(parser_t* p, const char* content)
 
 bool parser_eof(parser_t* p)
 {
-    return p->oindex >= p->lex->output->size;
+    return lex_get(p->lex, p->oindex) == NULL;
 }
 
 datatype_t* get_default_type(int kw)
@@ -479,6 +581,14 @@ datatype_t* get_default_type(int kw)
         case KW_F32: return t_f32;
         case KW_F64: return t_f64;
         case KW_STRING: return t_string;
+        case KW_F32X4: return t_f32x4;
+        case KW_F64X2: return t_f64x2;
+        case KW_I32X4: return t_i32x4;
+        case KW_I64X2: return t_i64x2;
+        case KW_F32X8: return t_f32x8;
+        case KW_F64X4: return t_f64x4;
+        case KW_I32X8: return t_i32x8;
+        case KW_I64X4: return t_i64x4;
         default: return t_object;
     }
 }
@@ -520,7 +630,7 @@ int parser_get_datatype_type(parser_t* p)
         #include "keywords.inc"
         #undef keyword
     }
-    if (found) return token->id - KW_VOID;
+    if (found) return token->id > KW_STRING ? DTT_SIMD : token->id - KW_VOID;
     return -1;
 }
 
@@ -659,6 +769,130 @@ static ast_node_t* parser_read_for_statement(parser_t* p)
     return for_stmt;
 }
 
+// whether lvar only comes up under stmt as the target of a +=. every task adds into its own copy starting from 0, so
+// reading it anywhere else would see that partial sum instead of the total
+static bool parser_parallel_adds(ast_node_t* stmt, ast_node_t* lvar)
+{
+    if (!stmt)
+        return true;
+    switch (stmt->type)
+    {
+        case AST_BLOCK:
+        {
+            for (int i = 0; i < stmt->statements->size; i++)
+            {
+                if (!parser_parallel_adds(vector_get(stmt->statements, i), lvar))
+                    return false;
+            }
+            return true;
+        }
+        case AST_IF:
+            return !range_uses(stmt->if_cond, lvar) && parser_parallel_adds(stmt->if_then, lvar) && parser_parallel_adds(stmt->if_els, lvar);
+        case AST_WHILE:
+            return !range_uses(stmt->while_cond, lvar) && parser_parallel_adds(stmt->while_then, lvar);
+        case AST_FOR:
+        {
+            return !range_uses(stmt->for_init, lvar) && !range_uses(stmt->for_cond, lvar) && !range_uses(stmt->for_post, lvar) &&
+                !(stmt->for_parallel && range_uses(stmt->for_parallel->limit, lvar)) && parser_parallel_adds(stmt->for_then, lvar);
+        }
+        case AST_SWITCH:
+        {
+            if (range_uses(stmt->cmp, lvar))
+                return false;
+            for (int i = 0; i < stmt->cases->size; i++)
+            {
+                if (!parser_parallel_adds(((ast_node_t*) vector_get(stmt->cases, i))->case_then, lvar))
+                    return false;
+            }
+            return true;
+        }
+        case OP_ASSIGN_ADD:
+        {
+            if (stmt->lhs == lvar)
+                return !range_uses(stmt->rhs, lvar);
+        }
+    }
+    return !range_uses(stmt, lvar);
+}
+
+// a task can't return for the function it's a part of
+static ast_node_t* parser_parallel_return(ast_node_t* stmt)
+{
+    if (!stmt)
+        return NULL;
+    ast_node_t* found = NULL;
+    switch (stmt->type)
+    {
+        case AST_RETURN:
+            return stmt;
+        case AST_BLOCK:
+        {
+            for (int i = 0; i < stmt->statements->size && !found; i++)
+                found = parser_parallel_return(vector_get(stmt->statements, i));
+            return found;
+        }
+        case AST_IF:
+            return (found = parser_parallel_return(stmt->if_then)) ? found : parser_parallel_return(stmt->if_els);
+        case AST_WHILE:
+            return parser_parallel_return(stmt->while_then);
+        case AST_FOR:
+            return parser_parallel_return(stmt->for_then);
+        case AST_SWITCH:
+        {
+            for (int i = 0; i < stmt->cases->size && !found; i++)
+                found = parser_parallel_return(((ast_node_t*) vector_get(stmt->cases, i))->case_then);
+            return found;
+        }
+    }
+    return NULL;
+}
+
+// parallel for (i = lo; i < hi; ++i) splits its iterations into chunks that run on the pool, each on its own copy of the
+// frame. variables from before the loop can only be added to with +=, every worker adds up its own partial sums and
+// they're added to the variables once the loop is done
+static ast_node_t* parser_read_parallel_for(parser_t* p)
+{
+    token_t* parallel_keyword = parser_expect(p, KW_PARALLEL);
+    int outer = p->current_func->local_variables->size;
+    ast_node_t* loop = parser_read_for_statement(p);
+    ast_node_t* cond = loop->for_cond, * start;
+    bool inclusive = cond->type == OP_LESS_EQUAL;
+    if (inclusive) // counted the same way, the limit is one further
+        cond->type = OP_LESS;
+    ast_node_t* var = range_induction(loop, &start);
+    if (!var)
+        errorp(parallel_keyword->loc->row, parallel_keyword->loc->col, "parallel for has to count up by one to a limit, like (i64 i = lo; i < hi; ++i)");
+    if (range_modifies(loop->for_then, var, true))
+        errorp(parallel_keyword->loc->row, parallel_keyword->loc->col, "can't change '%s' inside a parallel for, every task counts its own part", var->var_name);
+    ast_node_t* ret = parser_parallel_return(loop->for_then);
+    if (ret)
+        errorp(ret->loc->row, ret->loc->col, "can't return from inside a parallel for");
+    parser_ensure_cextern(p, "__libsgcllc_parallel_for", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+    parallel_loop_t* parallel = calloc(1, sizeof(parallel_loop_t));
+    parallel->limit = cond->rhs;
+    parallel->inclusive = inclusive;
+    parallel->bound = ast_lvar_init(var->datatype, cond->loc, "", NULL, p->lex->filename);
+    parallel->row = ast_lvar_init(t_i64, cond->loc, "", NULL, p->lex->filename);
+    parallel->reductions = vector_init(4, 4);
+    vector_push(p->current_func->local_variables, parallel->bound);
+    vector_push(p->current_func->local_variables, parallel->row);
+    for (int i = 0; i < p->current_func->params->size + outer; i++)
+    {
+        ast_node_t* lvar = i < p->current_func->params->size ? vector_get(p->current_func->params, i) :
+            vector_get(p->current_func->local_variables, i - p->current_func->params->size);
+        if (!*lvar->var_name || !range_modifies(loop->for_then, lvar, true))
+            continue;
+        if (!parser_parallel_adds(loop->for_then, lvar))
+            errorp(parallel_keyword->loc->row, parallel_keyword->loc->col, "parallel for can only add to '%s' with += and not read it, it was declared outside the loop", lvar->var_name);
+        if (!isintegraltype(lvar->datatype->type) && !isfloattype(lvar->datatype->type))
+            errorp(parallel_keyword->loc->row, parallel_keyword->loc->col, "parallel for can only add up numbers");
+        vector_push(parallel->reductions, lvar);
+    }
+    loop->for_cond = ast_binary_op_init(OP_LESS, t_bool, cond->loc, var, parallel->bound);
+    loop->for_parallel = parallel;
+    return loop;
+}
+
 static ast_node_t* parser_read_stub_statement(parser_t* p, int kw, ast_node_type type)
 {
     token_t* kwtok = parser_expect(p, kw);
@@ -736,6 +970,7 @@ static datatype_t* parser_build_datatype(parser_t* p, datatype_type unspecified_
     dt->usign = false;
     dt->type = unspecified_dtt;
     dt->size = 4;
+    token_t* soa = NULL;
     for (;; parser_get(p))
     {
         token_t* token = parser_peek(p);
@@ -774,6 +1009,15 @@ static datatype_t* parser_build_datatype(parser_t* p, datatype_type unspecified_
                     dt->name = token->content;
                     break;
                 }
+                case DTT_SIMD:
+                {
+                    datatype_t* simd = get_default_type(token->id);
+                    dt->size = simd->size;
+                    dt->array_type = simd->array_type;
+                    if (dt->size == 32 && options && !options->avx2)
+                        errorp(token->loc->row, token->loc->col, "32 byte simd types need --avx2");
+                    break;
+                }
                 default:
                     dt->size = 8;
                     break;
@@ -790,6 +1034,9 @@ static datatype_t* parser_build_datatype(parser_t* p, datatype_type unspecified_
             case KW_UNSIGNED:
                 dt->usign = true;
                 break;
+            case KW_SOA:
+                soa = token;
+                break;
             case KW_OPERATOR:
             {
                 parser_get(p);
@@ -828,6 +1075,10 @@ static datatype_t* parser_build_datatype(parser_t* p, datatype_type unspecified_
             case KW_LBRACK:
             {
                 parser_get(p);
+                if (dt->type == DTT_SLICE)
+                    errorp(token->loc->row, token->loc->col, "tell dev to add arrays of slices lol");
+                if (dt->type == DTT_SIMD)
+                    errorp(token->loc->row, token->loc->col, "tell dev to add arrays of simd types lol");
                 datatype_t* ddt = calloc(1, sizeof(datatype_t));
                 *ddt = *dt;
                 dt->array_type = ddt;
@@ -835,77 +1086,129 @@ static datatype_t* parser_build_datatype(parser_t* p, datatype_type unspecified_
                 dt->type = DTT_ARRAY;
                 dt->usign = false;
                 dt->length = NULL;
+                // soa applies to the innermost brackets, the ones holding the blueprints
+                dt->soa = soa && ddt->type != DTT_ARRAY;
+                if (dt->soa && ddt->type != DTT_OBJECT)
+                    errorp(soa->loc->row, soa->loc->col, "soa arrays can only hold blueprints");
+                // i32[:] is a slice, a pointer into something else's elements and how many of them it covers
+                if (parser_check(p, ':'))
+                {
+                    parser_get(p);
+                    if (ddt->type == DTT_ARRAY || dt->soa)
+                        errorp(token->loc->row, token->loc->col, "tell dev to add slices of arrays lol");
+                    dt->type = DTT_SLICE;
+                    dt->size = 16;
+                    dt->depth = 1;
+                }
                 break;
             }
         }
     }
+    if (dt->type == DTT_SIMD && dt->usign)
+        errorp(parser_peek(p)->loc->row, parser_peek(p)->loc->col, "tell dev to add unsigned simd types lol");
+    // value blueprints are as big as their instance variables, which a blueprint still being read doesn't know yet
+    datatype_t* element = dt;
+    while (element->type == DTT_ARRAY || element->type == DTT_SLICE)
+        element = element->array_type;
+    // make soa point[n] has its brackets read later, so the element carries it until then
+    if (soa && dt->type != DTT_ARRAY)
+    {
+        if (terminator != '[')
+            errorp(soa->loc->row, soa->loc->col, "soa only applies to arrays");
+        element->soa = true;
+    }
+    if (element->type == DTT_OBJECT && element->name)
+    {
+        ast_node_t* bp = map_get(p->lenv ? p->lenv : p->genv, element->name);
+        if (bp && bp->type == AST_BLUEPRINT && bp->bp_datatype->value)
+        {
+            element->value = true;
+            if (bp->bp_sized)
+            {
+                element->size = 0;
+                vector_push(bp->bp_sized, element);
+            }
+            else
+                element->size = bp->bp_size;
+        }
+    }
     return dt;
 }
 
+static void parser_add_import_func(parser_t* p, ast_node_t* func)
+{
+    vector_t* nonspecific_vec = map_get(p->funcs, func->func_name);
+    if (!nonspecific_vec)
+        map_put(p->funcs, func->func_name, vector_qinit(1, func));
+    else
+        vector_push(nonspecific_vec, func);
+    if (func->lowlvl_label)
+        parser_ensure_cextern(p, func->lowlvl_label, func->datatype, func->params);
+}
+
+static void parser_add_import_symbol(parser_t* p, ast_node_t* symbol)
+{
+    char* name;
+    if (symbol->type == AST_FUNC_DEFINITION)
+    {
+        name = symbol->func_label;
+        parser_add_import_func(p, symbol);
+        if (symbol->operator != -1)
+            vector_push(p->operators, symbol);
+    }
+    else
+    {
+        name = symbol->bp_name;
+        for (int i = 0; i < symbol->methods->size; i++)
+            parser_add_import_func(p, vector_get(symbol->methods, i));
+    }
+    tracef(TRACE_PARSER, TRACE_INFO, "included symbol from %s: %s\n", symbol->residing, name);
+    map_put(p->genv, name, vector_push(p->userexterns, symbol));
+}
+
+// imported functions only get pulled out of their headers once something asks for them by name
+static vector_t* parser_lookup_funcs(parser_t* p, char* name)
+{
+    if (!map_get(p->resolved, name))
+    {
+        map_put(p->resolved, name, (void*) 1);
+        vector_t* symbols = vector_init(4, 4);
+        for (int i = 0; i < p->imports->size; i++)
+            header_find(vector_get(p->imports, i), name, symbols);
+        for (int i = 0; i < symbols->size; i++)
+            parser_add_import_symbol(p, vector_get(symbols, i));
+        vector_delete(symbols);
+    }
+    return map_get(p->funcs, name);
+}
+
 static ast_node_t* parser_read_import(parser_t* p)
 {
     parser_expect(p, KW_IMPORT); // skip import keyword
     token_t* path = parser_expect_type(p, TT_STRING_LITERAL);
     ast_node_t* node = ast_import_init(path->loc, unwrap_string_literal(path->content));
     parser_expect(p, ';');
-    char* headerpath = NULL;
-    for (int i = 0; i < options->import_search_paths->size; i++)
-    {
-        char* path = vector_get(options->import_search_paths, i);
-        buffer_t* checkbuf = buffer_init(256, 128);
-        buffer_string(checkbuf, path);
-        buffer_append(checkbuf, '/');
-        buffer_string(checkbuf, node->path);
-        buffer_string(checkbuf, ".o");
-        char* fullpath = buffer_export(checkbuf);
-        buffer_delete(checkbuf);
-        buffer_t* headerbuf = buffer_init(256, 128);
-        buffer_string(headerbuf, path);
-        buffer_append(headerbuf, '/');
-        buffer_string(headerbuf, node->path);
-        buffer_string(headerbuf, ".sgcllh");
-        char* lheaderpath = buffer_export(headerbuf);
-        if (fexists(fullpath) && fexists(lheaderpath))
-        {
-            vector_push(p->links, fullpath);
-            headerpath = lheaderpath;
-            break;
-        }
-        free(fullpath);
-    }
-    if (!headerpath)
+    char* object_path;
+    header_t* header = import_cache_get(node->path, &object_path);
+    if (!header)
         errorp(path->loc->row, path->loc->col, "could not open a library by the name of '%s'", node->path);
-    FILE* header = fopen(headerpath, "rb");
-    vector_t* symbols = read_header(header, node->path);
-    char* lowlvl_path = NULL;
-    for (int i = 0; i < symbols->size; i++)
+    vector_push(p->links, object_path);
+    vector_push(p->imports, header);
+    if (header_has_lowlvl(header))
     {
-        ast_node_t* symbol = vector_get(symbols, i);
-        char* name;
-        if (symbol->type == AST_FUNC_DEFINITION)
-        {
-            name = symbol->func_label;
-            vector_t* nonspecific_vec = map_get(p->funcs, symbol->func_name);
-            if (!nonspecific_vec)
-                map_put(p->funcs, symbol->func_name, vector_qinit(1, symbol));
-            else
-                vector_push(nonspecific_vec, symbol);
-            if (symbol->lowlvl_label)
-            {
-                parser_ensure_cextern(p, symbol->lowlvl_label, symbol->datatype, symbol->params);
-                if (!lowlvl_path)
-                {
-                    lowlvl_path = malloc(256);
-                    sprintf(lowlvl_path, "libsgcll/%s_lowlvl.o", node->path);
-                    vector_push(p->links, lowlvl_path);
-                }
-            }
-        }
-        else if (symbol->type == AST_GVAR)
-            name = symbol->var_name;
-        debugf("included symbol from %s: %s\n", node->path, name);
-        map_put(p->genv, name, vector_push(p->userexterns, symbol));
+        char* lowlvl_path = malloc(256);
+        sprintf(lowlvl_path, "libsgcll/%s_lowlvl.o", node->path);
+        vector_push(p->links, lowlvl_path);
     }
+    vector_t* symbols = vector_init(10, 10);
+    header_find_eager(header, symbols);
+    // names that were already looked up won't be looked up again, so this import has to chip in now
+    vector_t* resolved = map_keys(p->resolved);
+    for (int i = 0; i < resolved->size; i++)
+        header_find(header, vector_get(resolved, i), symbols);
+    vector_delete(resolved);
+    for (int i = 0; i < symbols->size; i++)
+        parser_add_import_symbol(p, vector_get(symbols, i));
     vector_delete(symbols);
     return node;
 }
@@ -926,7 +1229,8 @@ static ast_node_t* parser_read_func_definition(parser_t* p)
         func_node->func_type = 'c';
         func_node->func_name = p->current_blueprint->bp_name;
         func_node->datatype = p->current_blueprint->bp_datatype;
-        parser_ensure_cextern(p, "__libsgcllc_alloc_bytes", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+        if (!func_node->datatype->value)
+            parser_ensure_cextern(p, "__libsgcllc_alloc_bytes", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
     }
     else if (!strcmp(func_name_token->content, "destructor"))
     {
@@ -942,18 +1246,27 @@ static ast_node_t* parser_read_func_definition(parser_t* p)
     map_t* func_host_env = p->lenv ? p->lenv : p->genv;
     map_t* func_env = p->lenv = map_init(func_host_env, 100);
     bool this_arg = p->current_blueprint && func_node->func_type != 'c';
+    bool result_arg = isvaluetype(func_node->datatype); // the caller passes where to put the value blueprint before anything else
     if (p->current_blueprint)
     {
-        ast_node_t* this_var = map_put(p->lenv, "this", ast_lvar_init(p->current_blueprint->bp_datatype, func_name_token->loc, "this", NULL, p->lex->filename));
+        // this always points at the instance, even in a value blueprint
+        datatype_t* this_dt = p->current_blueprint->bp_datatype;
+        if (this_dt->value)
+        {
+            this_dt = clone_datatype(this_dt);
+            this_dt->value = false;
+            this_dt->size = 8;
+        }
+        ast_node_t* this_var = map_put(p->lenv, "this", ast_lvar_init(this_dt, func_name_token->loc, "this", NULL, p->lex->filename));
         if (this_arg) // implicit this arg
         {
-            this_var->voffset = 16;
+            this_var->voffset = result_arg ? 24 : 16;
             vector_push(func_node->params, this_var);
         }
         else // constructor this
             vector_push(func_node->local_variables, this_var);
     }
-    for (int i = this_arg ? 24 : 16;; i += 8)
+    for (int i = 16 + 8 * (this_arg + result_arg);; i += 8)
     {
         if (parser_check(p, ')'))
         {
@@ -968,12 +1281,19 @@ static ast_node_t* parser_read_func_definition(parser_t* p)
             parser_expect(p, ')');
         ast_node_t* lvar = map_put(p->lenv, param_name_token->content, ast_lvar_init(pdt, param_name_token->loc, param_name_token->content, NULL, p->lex->filename));
         lvar->voffset = i;
+        if (pdt->type == DTT_SLICE) // the length comes in the next register
+            i += 8;
+        // the prologue moves simd parameters into the frame, which a constructor has to give this first
+        if (pdt->type == DTT_SIMD && func_node->func_type == 'c')
+            errorp(param_name_token->loc->row, param_name_token->loc->col, "tell dev to add simd constructor parameters lol");
         vector_push(func_node->params, lvar);
     }
     func_node->func_label = make_func_label(p->lex->filename, func_node, p->current_blueprint);
     if (map_get(func_host_env, func_node->func_label))
         errorp(func_name_token->loc->row, func_name_token->loc->col, "function is identical to an already-defined function");
     map_put(func_host_env, func_node->func_label, func_node);
+    if (func_host_env == p->genv && func_node->operator != -1)
+        vector_push(p->operators, func_node);
     vector_t* nonspecific_vec = map_get(p->funcs, func_node->func_name);
     int func_index;
     if (!nonspecific_vec)
@@ -991,12 +1311,34 @@ static ast_node_t* parser_read_func_definition(parser_t* p)
         parser_expect(p, '{');
         ast_node_t* cf = p->current_func;
         p->current_func = func_node;
+        vector_t* tracked = ast_track(p->body_nodes);
         parser_read_func_body(p);
+        escape_analyze(p, func_node);
+        if (options && options->bounds_check && func_node->unsafe == -2)
+            range_analyze(p, func_node);
+        if (options)
+            vectorize_analyze(p, func_node);
+        ast_track(tracked);
         p->current_func = cf;
     }
     else
     {
         parser_expect(p, ';');
+        bool value_blueprints = result_arg, simd = dt->type == DTT_SIMD;
+        for (int i = 0; i < func_node->params->size; i++)
+        {
+            datatype_t* pdt = ((ast_node_t*) vector_get(func_node->params, i))->datatype;
+            value_blueprints |= isvaluetype(pdt);
+            simd |= pdt->type == DTT_SIMD;
+        }
+        if (value_blueprints)
+            errorp(func_name_token->loc->row, func_name_token->loc->col, "tell dev to add value blueprints to lowlvl functions lol");
+        // c passes simd values by address, these are only ever in registers
+        if (simd)
+            errorp(func_name_token->loc->row, func_name_token->loc->col, "tell dev to add simd types to lowlvl functions lol");
+        // slice parameters are just the pointer and length parameters to c, a returned one would need memory
+        if (dt->type == DTT_SLICE)
+            errorp(func_name_token->loc->row, func_name_token->loc->col, "tell dev to add lowlvl functions returning slices lol");
         int label_len = strlen(func_node->func_label);
         char* lowlvl_label = malloc(label_len + 1);
         memcpy(lowlvl_label, func_node->func_label, label_len);
@@ -1068,6 +1410,8 @@ static void parser_read_func_body(parser_t* p)
         {
             if (p->current_func->func_type == 'c')
                 vector_push(p->current_func->body->statements, ast_return_init(p->current_func->datatype, stmt->loc, vector_get(p->current_func->local_variables, 0), p->current_func));
+            else if (isvaluetype(p->current_func->datatype))
+                errorp(stmt->loc->row, stmt->loc->col, "function returning a value blueprint has no return statement");
             else
                 vector_push(p->current_func->body->statements, ast_return_init(p->current_func->datatype, stmt->loc, ast_iliteral_init(p->current_func->datatype, stmt->loc, 0), p->current_func));
         }
@@ -1094,6 +1438,7 @@ static bool parser_is_blueprint(parser_t* p)
 static ast_node_t* parser_read_blueprint(parser_t* p)
 {
     visibility_type vt = VT_PRIVATE;
+    bool value = false;
     for (;;)
     {
         token_t* token = parser_get(p);
@@ -1107,6 +1452,11 @@ static ast_node_t* parser_read_blueprint(parser_t* p)
                 vt = parser_peek(p)->id - KW_PRIVATE;
                 break;
             }
+            case KW_VALUE:
+            {
+                value = true;
+                break;
+            }
             case KW_BLUEPRINT:
                 goto leave_loop;
             case KW_PROTECTED:
@@ -1123,7 +1473,10 @@ leave_loop:
         errorp(name_token->loc->row, name_token->loc->col, "expected identifier for blueprint");
     datatype_t* dt = clone_datatype(t_object);
     dt->name = name_token->content;
+    dt->value = value;
     ast_node_t* blueprint = ast_blueprint_init(name_token->loc, name_token->content, dt);
+    if (value)
+        blueprint->bp_sized = vector_qinit(1, dt);
     parser_expect(p, '{');
     map_t* bp_host_env = p->lenv ? p->lenv : p->genv;
     map_t* bp_env = p->lenv = map_init(bp_host_env, 100);
@@ -1146,6 +1499,12 @@ leave_loop:
         if (parser_is_var_decl(p))
         {
             ast_node_t* lvar = parser_read_lvar_decl(p);
+            if (isvaluetype(lvar->datatype) && !lvar->datatype->size)
+                errorp(lvar->loc->row, lvar->loc->col, "value blueprint '%s' can't contain itself", lvar->datatype->name);
+            if (lvar->datatype->type == DTT_SLICE)
+                errorp(lvar->loc->row, lvar->loc->col, "tell dev to add slices in blueprints lol");
+            if (lvar->datatype->type == DTT_SIMD)
+                errorp(lvar->loc->row, lvar->loc->col, "tell dev to add simd types in blueprints lol");
             lvar->voffset = size;
             size += max(2, lvar->datatype->size);
             vector_push(p->current_blueprint->inst_variables, lvar);
@@ -1155,6 +1514,17 @@ leave_loop:
         else
             errorp(token->loc->row, token->loc->col, "expected variable declaration or method definition");
     }
+    if (value)
+    {
+        // copies move 8 bytes at a time, and headers keep the size in a byte
+        size = max(8, round_up(size, 8));
+        if (size > 248)
+            errorp(name_token->loc->row, name_token->loc->col, "value blueprint '%s' is %i bytes, value blueprints can be at most 248", name_token->content, size);
+        for (int i = 0; i < blueprint->bp_sized->size; i++)
+            ((datatype_t*) vector_get(blueprint->bp_sized, i))->size = size;
+        vector_delete(blueprint->bp_sized);
+        blueprint->bp_sized = NULL;
+    }
     p->current_blueprint->bp_size = size;
     p->current_blueprint = cbp;
     p->lenv = p->lenv->parent;
@@ -1238,7 +1608,10 @@ static ast_node_t* parser_read_delete_statement(parser_t* p)
     token_t* del_keyword = parser_expect(p, KW_DELETE);
     ast_node_t* node = ast_get_by_token(p, parser_get(p));
     parser_expect(p, ';');
-    parser_ensure_cextern(p, "__libsgcllc_delete_array", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+    if (node && node->datatype && node->datatype->type == DTT_ARRAY && node->datatype->soa)
+        parser_ensure_cextern(p, "__libsgcllc_delete_soa_array", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+    else
+        parser_ensure_cextern(p, "__libsgcllc_delete_array", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
     return ast_delete_init(t_void, del_keyword->loc, node);
 }
 
@@ -1256,6 +1629,8 @@ static ast_node_t* parser_read_stmt(parser_t* p)
         return parser_read_while_statement(p);
     if (parser_is_header_statement(p, KW_FOR))
         return parser_read_for_statement(p);
+    if (parser_is_header_statement(p, KW_PARALLEL))
+        return parser_read_parallel_for(p);
     if (parser_is_header_statement(p, KW_SWITCH))
         return parser_read_switch_statement(p);
     if (parser_is_header_statement(p, KW_BREAK))
@@ -1265,6 +1640,20 @@ static ast_node_t* parser_read_stmt(parser_t* p)
     return parser_read_expr(p, ';');
 }
 
+// the : in a[lo:hi] belongs to the closest open bracket, unless a ternary or call is opened after it
+static bool parser_is_slice_colon(vector_t* stack)
+{
+    for (int i = stack->size - 1; i >= 0; i--)
+    {
+        int id = ((token_t*) vector_get(stack, i))->id;
+        if (id == '[')
+            return true;
+        if (id == '(' || id == OP_TERNARY_Q)
+            return false;
+    }
+    return false;
+}
+
 static void parser_rpn(parser_t* p, vector_t* stack, vector_t* expr_result, int terminator)
 {
     vector_t* calls = vector_init(5, 5);
@@ -1279,8 +1668,9 @@ static void parser_rpn(parser_t* p, vector_t* stack, vector_t* expr_result, int
             vector_push(expr_result, token);
         else if (token->type == TT_IDENTIFIER)
         {
+            // a variable or function with the same name wins over a builtin
             ast_node_t* builtin = map_get(builtins, token->content);
-            if (builtin && !map_get(p->genv, token->content))
+            if (builtin && parser_check(p, '(') && !map_get(p->lenv ? p->lenv : p->genv, token->content) && !parser_lookup_funcs(p, token->content))
             {
                 vector_push(p->userexterns, map_put(p->genv, token->content, builtin));
                 map_put(p->funcs, token->content, builtin);
@@ -1292,7 +1682,7 @@ static void parser_rpn(parser_t* p, vector_t* stack, vector_t* expr_result, int
         else if (token->id == '(')
         {
             token_t* prev = parser_far_peek(p, -1);
-            if (prev != NULL && prev->type == TT_IDENTIFIER && map_get(p->funcs, prev->content))
+            if (prev != NULL && prev->type == TT_IDENTIFIER && parser_lookup_funcs(p, prev->content))
             {
                 if (vector_top(stack) != NULL && (((token_t*) vector_top(stack))->id == OP_SELECTION || ((token_t*) vector_top(stack))->id == OP_SCOPE))
                     vector_push(expr_result, vector_pop(stack));
@@ -1300,7 +1690,27 @@ static void parser_rpn(parser_t* p, vector_t* stack, vector_t* expr_result, int
             }
             vector_push(stack, token);
         }
-        else if (token->id == ')' || token->id == ',' || token->id == ']')
+        else if (token->id == ']')
+        {
+            // only as far as the subscript this closes, the operators before it still have their right operand to come
+            token_t* last = NULL;
+            while (vector_top(stack) != NULL && ((token_t*) vector_top(stack))->id != '(' && ((token_t*) vector_top(stack))->id != '[')
+                vector_push(expr_result, last = vector_pop(stack));
+            // a[lo:] goes to the end
+            if (last && last->id == OP_SLICE && parser_far_peek(p, -1)->id == ':')
+                last->id = OP_SLICE_TO_END;
+            // the slice takes its operands itself, the brackets were only holding its place
+            if (vector_top(stack) != NULL && ((token_t*) vector_top(stack))->id == '[' && last && (last->id == OP_SLICE || last->id == OP_SLICE_TO_END))
+                vector_pop(stack);
+            else if (vector_top(stack) != NULL && ((token_t*) vector_top(stack))->id == '[')
+                vector_push(expr_result, vector_pop(stack));
+            else if (terminator == ']')
+            {
+                parser_unget(p);
+                break;
+            }
+        }
+        else if (token->id == ')' || token->id == ',')
         {
             while (vector_top(stack) != NULL && ((token_t*) vector_top(stack))->id != '(')
                 vector_push(expr_result, vector_pop(stack));
@@ -1313,11 +1723,6 @@ static void parser_rpn(parser_t* p, vector_t* stack, vector_t* expr_result, int
                     break;
                 }
             }
-            if (token->id == ']' && terminator == ']' && (vector_top(stack) == NULL || ((token_t*) vector_top(stack))->id != '['))
-            {
-                parser_unget(p);
-                break;
-            }
         }
         else if (token->id == OP_MAKE)
         {
@@ -1366,13 +1771,24 @@ static void parser_rpn(parser_t* p, vector_t* stack, vector_t* expr_result, int
             vector_push(expr_result, content_token_init(TT_NUMBER_LITERAL, depthbuffer, token->loc->offset, token->loc->row, token->loc->col));
             vector_push(expr_result, token);
         }
+        else if (token->id == ':' && parser_is_slice_colon(stack))
+        {
+            // a[:hi] starts at 0
+            if (parser_far_peek(p, -1)->id == '[')
+                vector_push(expr_result, content_token_init(TT_NUMBER_LITERAL, "0", token->loc->offset, token->loc->row, token->loc->col));
+            while (vector_top(stack) != NULL && ((token_t*) vector_top(stack))->id != '[')
+                vector_push(expr_result, vector_pop(stack));
+            vector_push(stack, id_token_init(TT_KEYWORD, OP_SLICE, token->loc->offset, token->loc->row, token->loc->col));
+        }
         else
         {
-            if (token->id >= KW_VOID && token->id <= KW_STRING)
+            if (token->id >= KW_VOID && token->id <= KW_I64X4)
                 vector_push(expr_result, datatype_token_init(TT_DATATYPE, get_default_type(token->id), token->loc->offset, token->loc->row, token->loc->col));
             else
             {
-                while (vector_top(stack) != NULL && precedence(token->id) > precedence(((token_t*) vector_top(stack))->id))
+                // a.b.c selects from a.b
+                while (vector_top(stack) != NULL && ((token_t*) vector_top(stack))->id != '[' && (precedence(token->id) > precedence(((token_t*) vector_top(stack))->id) ||
+                    (token->id == OP_SELECTION && ((token_t*) vector_top(stack))->id == OP_SELECTION)))
                     vector_push(expr_result, vector_pop(stack));
                 vector_push(stack, token);
             }
@@ -1383,18 +1799,62 @@ static void parser_rpn(parser_t* p, vector_t* stack, vector_t* expr_result, int
     vector_delete(calls);
 }
 
+// a value blueprint is returned into a slot in the caller's frame, which the callee gets a pointer to
+static ast_node_t* parser_func_call(parser_t* p, ast_node_t* func, location_t* loc, vector_t* args)
+{
+    ast_node_t* call = ast_func_call_init(func->datatype, loc, func, args);
+    if (isvaluetype(func->datatype))
+    {
+        if (!p->current_func)
+            errorp(loc->row, loc->col, "tell dev to add value blueprints outside of functions lol");
+        call->call_result = ast_lvar_init(func->datatype, loc, "", NULL, p->lex->filename);
+        vector_push(p->current_func->local_variables, call->call_result);
+    }
+    return call;
+}
+
+// spawn f(args) gathers the arguments in a frame slot, the runtime copies them for the new thread
+static ast_node_t* parser_spawn(parser_t* p, token_t* token, ast_node_t* call)
+{
+    if (!call || call->type != AST_FUNC_CALL)
+        errorp(token->loc->row, token->loc->col, "spawn expected a function call");
+    ast_node_t* func = call->func;
+    if (func->func_type == 'c' || func->extrn == 'v' || func->extrn == 'b')
+        errorp(token->loc->row, token->loc->col, "only functions and blueprint functions can be spawned");
+    if (!p->current_func)
+        errorp(token->loc->row, token->loc->col, "spawn can only be used inside functions");
+    if (call->call_result || func->datatype->type == DTT_SIMD)
+        errorp(token->loc->row, token->loc->col, "tell dev to add spawning functions that return value blueprints or simd values lol");
+    int slots = 0; // slices take two registers
+    for (int i = 0; i < func->params->size; i++)
+    {
+        datatype_t* dt = ((ast_node_t*) vector_get(func->params, i))->datatype;
+        if (isvaluetype(dt) || dt->type == DTT_SIMD)
+            errorp(token->loc->row, token->loc->col, "tell dev to add spawning functions that take value blueprints or simd values lol");
+        slots += dt->type == DTT_SLICE ? 2 : 1;
+    }
+    if (slots > 4)
+        errorp(token->loc->row, token->loc->col, "function calls with 4+ arguments are not supported yet");
+    parser_ensure_cextern(p, "__libsgcllc_thread_spawn", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+    // the slot is an anonymous value blueprint as far as the frame is concerned, one register's worth per argument
+    datatype_t* dt = calloc(1, sizeof(datatype_t));
+    dt->visibility = VT_PRIVATE;
+    dt->type = DTT_OBJECT;
+    dt->value = true;
+    dt->size = max(slots * 8, 8);
+    ast_node_t* spawn = ast_unary_op_init(OP_SPAWN, t_i64, token->loc, call);
+    spawn->spawn_block = ast_lvar_init(dt, token->loc, "", NULL, p->lex->filename);
+    vector_push(p->current_func->local_variables, spawn->spawn_block);
+    return spawn;
+}
+
 static ast_node_t* parser_find_operator_overload(parser_t* p, vector_t* args, datatype_t* rettype, token_t* op)
 {
-    vector_t* keys = map_keys(p->genv);
     ast_node_t* found = NULL;
     unsigned int lowest_conv = -1;
-    for (int i = 0; i < keys->size; i++)
+    for (int i = 0; i < p->operators->size; i++)
     {
-        ast_node_t* node = map_get(p->genv, vector_get(keys, i));
-        if (!node)
-            continue;
-        if (node->type != AST_FUNC_DEFINITION)
-            continue;
+        ast_node_t* node = vector_get(p->operators, i);
         if (node->operator != op->id)
             continue;
         if (node->params->size != args->size)
@@ -1402,12 +1862,12 @@ static ast_node_t* parser_find_operator_overload(parser_t* p, vector_t* args, da
         if (rettype && !same_datatype(p, node->datatype, rettype))
             continue;
         int conversions = 0;
-        debugf("comparing against: %s\n", node->func_label);
+        tracef(TRACE_OVERLOADS, TRACE_VERBOSE, "comparing against: %s\n", node->func_label);
         for (int j = 0; j < args->size; j++)
         {
             ast_node_t* param = vector_get(node->params, j);
             ast_node_t* arg = vector_get(args, j);
-            debugf("    comparing arg: %i, to %i\n", arg->datatype->type, param->datatype->type);
+            tracef(TRACE_OVERLOADS, TRACE_VERBOSE, "    comparing arg: %i, to %i\n", arg->datatype->type, param->datatype->type);
             if (!convertible_datatype(p, param->datatype, arg->datatype))
                 goto try_again_overload;
             if (same_datatype(p, param->datatype, arg->datatype))
@@ -1425,8 +1885,194 @@ static ast_node_t* parser_find_operator_overload(parser_t* p, vector_t* args, da
 try_again_overload:
     }
     if (found)
-        debugf("found operator overload: %s\n", found->func_label);
-    return found ? ast_func_call_init(found->datatype, op->loc, found, args) : NULL;
+        tracef(TRACE_OVERLOADS, TRACE_INFO, "found operator overload: %s\n", found->func_label);
+    return found ? parser_func_call(p, found, op->loc, args) : NULL;
+}
+
+// a scalar where a simd value is wanted goes in every lane
+static ast_node_t* parser_simd_splat(parser_t* p, datatype_t* dt, ast_node_t* node, location_t* loc)
+{
+    if (node->datatype->type == DTT_SIMD)
+    {
+        if (!same_datatype(p, node->datatype, dt))
+            errorp(loc->row, loc->col, "simd operands have to be the same type");
+        return node;
+    }
+    if (!isintegraltype(node->datatype->type) && !isfloattype(node->datatype->type))
+        errorp(loc->row, loc->col, "only numbers can be spread across simd lanes");
+    return ast_cast_init(dt, loc, node);
+}
+
+// simd operators work lane by lane, comparisons give a mask with every bit of a lane set where it held
+static ast_node_t* parser_simd_binary_op(parser_t* p, token_t* token, ast_node_t* lhs, ast_node_t* rhs)
+{
+    location_t* loc = token->loc;
+    // v[i] is one lane of a variable
+    if (token->id == OP_SUBSCRIPT)
+    {
+        if (lhs->datatype->type != DTT_SIMD)
+            errorp(loc->row, loc->col, "simd values can't be used as subscripts");
+        if (lhs->type != AST_LVAR)
+            errorp(loc->row, loc->col, "tell dev to add subscripting simd values outside of variables lol");
+        if (!isintegraltype(rhs->datatype->type))
+            errorp(loc->row, loc->col, "simd lanes are picked with integers");
+        if (options && options->bounds_check)
+            parser_ensure_cextern(p, "__libsgcllc_bounds_fail", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+        return ast_binary_op_init(OP_SUBSCRIPT, lhs->datatype->array_type, loc, lhs, rhs);
+    }
+    // a[i:] = v stores the lanes over the slice's first elements
+    if (token->id == OP_ASSIGN && lhs->type == OP_SLICE)
+    {
+        if (rhs->datatype->type != DTT_SIMD || lhs->datatype->array_type->type != rhs->datatype->array_type->type)
+            errorp(loc->row, loc->col, "simd values can only be stored over elements of their lane type");
+        if (options && options->bounds_check)
+            parser_ensure_cextern(p, "__libsgcllc_bounds_fail", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+        return ast_binary_op_init(OP_ASSIGN, rhs->datatype, loc, lhs, rhs);
+    }
+    bool assign = precedence(token->id) == precedence(OP_ASSIGN);
+    if (assign && lhs->datatype->type != DTT_SIMD)
+        errorp(loc->row, loc->col, "simd values can't be assigned to scalars");
+    datatype_t* dt = lhs->datatype->type == DTT_SIMD ? lhs->datatype : rhs->datatype;
+    lhs = parser_simd_splat(p, dt, lhs, loc);
+    rhs = parser_simd_splat(p, dt, rhs, loc);
+    datatype_type lane = dt->array_type->type;
+    datatype_t* rettype = dt;
+    switch (token->id)
+    {
+        case OP_ASSIGN:
+        case OP_ADD:
+        case OP_SUB:
+        case OP_AND:
+        case OP_OR:
+        case OP_XOR:
+        case OP_ASSIGN_ADD:
+        case OP_ASSIGN_SUB:
+        case OP_ASSIGN_AND:
+        case OP_ASSIGN_OR:
+        case OP_ASSIGN_XOR:
+            break;
+        // sse and avx2 only multiply i64 lanes into 128 bit results
+        case OP_MUL:
+        case OP_ASSIGN_MUL:
+        {
+            if (lane == DTT_I64)
+                errorp(loc->row, loc->col, "tell dev to add multiplying i64 lanes lol");
+            break;
+        }
+        case OP_DIV:
+        case OP_ASSIGN_DIV:
+        {
+            if (!isfloattype(lane))
+                errorp(loc->row, loc->col, "tell dev to add dividing integer lanes lol");
+            break;
+        }
+        case OP_EQUAL:
+        case OP_NOT_EQUAL:
+        case OP_GREATER:
+        case OP_GREATER_EQUAL:
+        case OP_LESS:
+        case OP_LESS_EQUAL:
+            rettype = simd_mask_datatype(dt);
+            break;
+        default:
+            errorp(loc->row, loc->col, "operator %i can't be applied to simd values", token->id);
+    }
+    ast_node_t* op = ast_binary_op_init(token->id, rettype, loc, lhs, rhs);
+    // a call on the left would clobber the register the right side is kept in
+    ast_node_t* called = lhs->type == AST_CAST ? lhs->castval : lhs;
+    if (!assign && called->type == AST_FUNC_CALL && called->func->extrn != 'v' && p->current_func)
+    {
+        op->simd_spill = ast_lvar_init(dt, loc, "", NULL, p->lex->filename);
+        vector_push(p->current_func->local_variables, op->simd_spill);
+    }
+    return op;
+}
+
+// scalars spread across every lane, arrays and slices load their first elements, and f32 and i32 lanes convert
+static ast_node_t* parser_simd_cast(parser_t* p, token_t* token, datatype_t* dt, ast_node_t* castval)
+{
+    location_t* loc = token->loc;
+    datatype_t* from = castval->datatype;
+    if (dt->type != DTT_SIMD)
+        errorp(loc->row, loc->col, "simd values can only be cast to other simd types");
+    datatype_type lane = dt->array_type->type;
+    switch (from->type)
+    {
+        case DTT_SIMD:
+        {
+            datatype_type from_lane = from->array_type->type;
+            if (from->size != dt->size)
+                errorp(loc->row, loc->col, "simd casts can't change how big a value is");
+            if (from_lane != lane && !(from_lane == DTT_F32 && lane == DTT_I32) && !(from_lane == DTT_I32 && lane == DTT_F32))
+                errorp(loc->row, loc->col, "tell dev to add converting between those simd lanes lol");
+            break;
+        }
+        case DTT_ARRAY:
+        case DTT_SLICE:
+        {
+            if (from->soa || from->array_type->type != lane)
+                errorp(loc->row, loc->col, "simd values can only be loaded from elements of their lane type");
+            if (options && options->bounds_check)
+                parser_ensure_cextern(p, "__libsgcllc_bounds_fail", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+            break;
+        }
+        default:
+            return parser_simd_splat(p, dt, castval, loc);
+    }
+    return ast_cast_init(dt, loc, castval);
+}
+
+// hsum, hmin and hmax fold every lane into one, vmin and vmax pick lane by lane, shuffle(v, lanes...) rearranges v's
+// lanes, select(mask, a, b) takes a's lanes where mask is set and b's everywhere else, and any and all check a mask
+static ast_node_t* parser_simd_intrinsic(parser_t* p, token_t* token, ast_node_t* intrinsic, vector_t* args)
+{
+    location_t* loc = token->loc;
+    char* name = intrinsic->func_name;
+    ast_node_t* first = args->size ? vector_get(args, 0) : NULL;
+    if (!first || first->datatype->type != DTT_SIMD)
+        errorp(loc->row, loc->col, "%s expected a simd value first", name);
+    datatype_t* dt = first->datatype;
+    int lanes = dt->size / dt->array_type->size;
+    bool mask = isintegraltype(dt->array_type->type);
+    int arity = 1;
+    if (!strcmp(name, "vmin") || !strcmp(name, "vmax"))
+        arity = 2;
+    else if (!strcmp(name, "shuffle"))
+        arity = 1 + lanes;
+    else if (!strcmp(name, "select"))
+        arity = 3;
+    if (args->size != arity)
+        errorp(loc->row, loc->col, "%s expected %i arguments, got %i", name, arity, args->size);
+    datatype_t* rettype = dt;
+    if (!strcmp(name, "hsum") || !strcmp(name, "hmin") || !strcmp(name, "hmax"))
+        rettype = dt->array_type;
+    else if (!strcmp(name, "vmin") || !strcmp(name, "vmax"))
+        args->data[1] = parser_simd_splat(p, dt, vector_get(args, 1), loc);
+    else if (!strcmp(name, "shuffle"))
+    {
+        for (int i = 1; i < args->size; i++)
+        {
+            ast_node_t* lane = vector_get(args, i);
+            if (lane->type != AST_ILITERAL || lane->ivalue < 0 || lane->ivalue >= lanes)
+                errorp(loc->row, loc->col, "shuffle's lanes have to be literals from 0 to %i", lanes - 1);
+        }
+    }
+    else if (!strcmp(name, "select"))
+    {
+        ast_node_t* a = vector_get(args, 1), * b = vector_get(args, 2);
+        rettype = a->datatype->type == DTT_SIMD ? a->datatype : b->datatype;
+        if (!mask || rettype->type != DTT_SIMD || !same_datatype(p, simd_mask_datatype(rettype), dt))
+            errorp(loc->row, loc->col, "select expected a mask the shape of what it's picking between");
+        args->data[1] = parser_simd_splat(p, rettype, a, loc);
+        args->data[2] = parser_simd_splat(p, rettype, b, loc);
+    }
+    else
+    {
+        if (!mask)
+            errorp(loc->row, loc->col, "%s expected a mask", name);
+        rettype = t_bool;
+    }
+    return ast_func_call_init(rettype, loc, intrinsic, args);
 }
 
 static ast_node_t* parser_read_expr(parser_t* p, int terminator)
@@ -1437,20 +2083,21 @@ static ast_node_t* parser_read_expr(parser_t* p, int terminator)
     vector_clear(stack, RETAIN_OLD_CAPACITY);
     if (!expr_result->size)
         errorp(parser_peek(p)->loc->row, parser_peek(p)->loc->col, "null statement is not allowed");
-    #ifdef SGCLLC_DEBUG
-    printf("----- results: (size %i)\n", expr_result->size);
-    for (int i = 0; i < expr_result->size; i++)
+    if (tracing(TRACE_PARSER, TRACE_VERBOSE))
     {
-        token_t* token = (token_t*) vector_get(expr_result, i);
-        if (token_has_content(token))
-            printf("result[%i] = %s\n", i, token->content);
-        else if (token->type == TT_DATATYPE)
-            printf("result[%i] = %i\n", i, token->dt->type);
-        else
-            printf("result[%i] = %c (id: %i)\n", i, token->id, token->id);
+        printf("----- results: (size %i)\n", expr_result->size);
+        for (int i = 0; i < expr_result->size; i++)
+        {
+            token_t* token = (token_t*) vector_get(expr_result, i);
+            if (token_has_content(token))
+                printf("result[%i] = %s\n", i, token->content);
+            else if (token->type == TT_DATATYPE)
+                printf("result[%i] = %i\n", i, token->dt->type);
+            else
+                printf("result[%i] = %c (id: %i)\n", i, token->id, token->id);
+        }
+        printf("----- end results\n");
     }
-    printf("----- end results\n");
-    #endif
     for (int i = 0; i < expr_result->size; i++)
     {
         token_t* token = (token_t*) vector_get(expr_result, i);
@@ -1462,9 +2109,11 @@ static ast_node_t* parser_read_expr(parser_t* p, int terminator)
         {
             ast_node_t* found = NULL;
             ast_node_t* builtin = map_get(builtins, token->content);
+            if (builtin && (map_get(p->lenv ? p->lenv : p->genv, token->content) != builtin || map_get(p->funcs, token->content) != builtin))
+                builtin = NULL;
             if (!builtin)
             {
-                vector_t* flavors = map_get(p->funcs, token->content);
+                vector_t* flavors = parser_lookup_funcs(p, token->content);
                 if (!flavors)
                 {
                     #define binop_chk(op, offset) (i + offset < expr_result->size && ((token_t*) vector_get(expr_result, i + offset))->id == op)
@@ -1552,9 +2201,33 @@ next_token:
                     ast_node_t* overload = parser_find_operator_overload(p, vector_qinit(2, lhs, rhs), NULL, token);
                     if (overload)
                     {
+                        // an overload gets a copy of a value blueprint, so compound assignment stores what it returns
+                        if (isvaluetype(lhs->datatype) && token->id != OP_ASSIGN && precedence(token->id) == precedence(OP_ASSIGN) && same_datatype(p, overload->datatype, lhs->datatype))
+                            overload = ast_binary_op_init(OP_ASSIGN, lhs->datatype, token->loc, lhs, overload);
                         vector_push(stack, overload);
                         break;
                     }
+                    if (lhs->datatype->type == DTT_SIMD || rhs->datatype->type == DTT_SIMD)
+                    {
+                        vector_push(stack, parser_simd_binary_op(p, token, lhs, rhs));
+                        break;
+                    }
+                    if (isvaluetype(lhs->datatype) || isvaluetype(rhs->datatype))
+                    {
+                        if (token->id != OP_ASSIGN)
+                            errorp(token->loc->row, token->loc->col, "no overload of operator %i for value blueprints", token->id);
+                        if (!same_datatype(p, lhs->datatype, rhs->datatype))
+                            errorp(token->loc->row, token->loc->col, "value blueprint '%s' cannot be assigned to '%s'", rhs->datatype->name, lhs->datatype->name);
+                        // construct straight into the variable instead of a temporary
+                        if (lhs->type == AST_LVAR && rhs->type == AST_FUNC_CALL && rhs->call_result)
+                        {
+                            if (vector_top(p->current_func->local_variables) == rhs->call_result)
+                                vector_pop(p->current_func->local_variables);
+                            rhs->call_result = lhs;
+                        }
+                        vector_push(stack, ast_binary_op_init(OP_ASSIGN, lhs->datatype, token->loc, lhs, rhs));
+                        break;
+                    }
                     datatype_t* rettype = arith_conv(lhs->datatype, rhs->datatype);
                     if (token->id == OP_EQUAL ||
                         token->id == OP_NOT_EQUAL ||
@@ -1578,13 +2251,54 @@ next_token:
                             case DTT_STRING:
                                 rettype = t_i8;
                                 break;
+                            case DTT_SLICE:
+                                rettype = lhs->datatype->array_type;
+                                break;
                             default:
                                 errorp(token->loc->row, token->loc->col, "subscript operator may not be applied to left hand side");
                         }
+                        if (options && options->bounds_check)
+                            parser_ensure_cextern(p, "__libsgcllc_bounds_fail", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
                     }
                     vector_push(stack, ast_binary_op_init(type, rettype, token->loc, lhs, rhs));
                     break;
                 }
+                case OP_SLICE:
+                case OP_SLICE_TO_END:
+                {
+                    ast_node_t* hi = token->id == OP_SLICE ? vector_pop(stack) : NULL;
+                    ast_node_t* lo = vector_pop(stack);
+                    ast_node_t* base = vector_pop(stack);
+                    if (!base || !lo || (token->id == OP_SLICE && !hi))
+                        errorp(token->loc->row, token->loc->col, "expected operands for slice operator");
+                    datatype_t* element = NULL;
+                    switch (base->datatype->type)
+                    {
+                        case DTT_ARRAY:
+                        {
+                            if (base->datatype->soa)
+                                errorp(token->loc->row, token->loc->col, "tell dev to add soa slices lol");
+                            element = base->datatype->array_type;
+                            if (element->type == DTT_ARRAY)
+                                errorp(token->loc->row, token->loc->col, "tell dev to add slices of arrays lol");
+                            break;
+                        }
+                        case DTT_STRING:
+                            element = t_i8;
+                            break;
+                        case DTT_SLICE:
+                            element = base->datatype->array_type;
+                            break;
+                        default:
+                            errorp(token->loc->row, token->loc->col, "slice operator may not be applied to left hand side");
+                    }
+                    if (!isintegraltype(lo->datatype->type) || (hi && !isintegraltype(hi->datatype->type)))
+                        errorp(token->loc->row, token->loc->col, "slice bounds have to be integers");
+                    vector_push(stack, ast_slice_init(slice_datatype(element), token->loc, base, lo, hi));
+                    if (options && options->bounds_check)
+                        parser_ensure_cextern(p, "__libsgcllc_slice_fail", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+                    break;
+                }
                 case OP_SELECTION:
                 {
                     ast_node_t* member = vector_pop(stack);
@@ -1606,9 +2320,19 @@ next_token:
                         vector_push(stack, overload);
                         break;
                     }
+                    if (type->datatype->type == DTT_SIMD || castval->datatype->type == DTT_SIMD)
+                    {
+                        vector_push(stack, parser_simd_cast(p, token, type->datatype, castval));
+                        break;
+                    }
                     vector_push(stack, ast_cast_init(type->datatype, token->loc, castval));
                     break;
                 }
+                case OP_SPAWN:
+                {
+                    vector_push(stack, parser_spawn(p, token, vector_pop(stack)));
+                    break;
+                }
                 case OP_MAGNITUDE:
                 case OP_NOT:
                 case OP_COMPLEMENT:
@@ -1625,7 +2349,6 @@ next_token:
                     datatype_t* dt = operand->datatype;
                     if (token->id == OP_MAGNITUDE)
                     {
-                        parser_ensure_cextern(p, "__libsgcllc_array_size", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
                         parser_ensure_cextern(p, "__libsgcllc_string_length", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
                         parser_ensure_cextern(p, "__libsgcllc_blueprint_size", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
                         dt = t_i64;
@@ -1646,6 +2369,8 @@ next_token:
                         vector_push(stack, overload);
                         break;
                     }
+                    if (operand->datatype->type == DTT_SIMD && token->id != OP_MAGNITUDE && token->id != OP_MINUS && token->id != OP_COMPLEMENT)
+                        errorp(token->loc->row, token->loc->col, "operator %i can't be applied to simd values", token->id);
                     vector_push(stack, ast_unary_op_init(token->id, dt, token->loc, operand));
                     break;
                 }
@@ -1655,6 +2380,18 @@ next_token:
                     int depth = depth_node->ivalue;
                     ast_node_t* dt_node = vector_pop(stack);
                     datatype_t* dt = dt_node->datatype;
+                    if (dt->type == DTT_SIMD)
+                        errorp(token->loc->row, token->loc->col, "tell dev to add arrays of simd types lol");
+                    ast_node_t* soa_blueprint = NULL;
+                    if (dt->soa)
+                    {
+                        dt->soa = false;
+                        soa_blueprint = dt->type == DTT_OBJECT ? map_get(p->lenv ? p->lenv : p->genv, dt->name) : NULL;
+                        if (!soa_blueprint || soa_blueprint->type != AST_BLUEPRINT)
+                            errorp(token->loc->row, token->loc->col, "soa arrays can only hold blueprints");
+                        if (depth != 1)
+                            errorp(token->loc->row, token->loc->col, "soa arrays can only be made one dimension at a time");
+                    }
                     for (int i = 0; i < depth; i++)
                     {
                         ast_node_t* dimension = vector_pop(stack);
@@ -1666,10 +2403,16 @@ next_token:
                         adt->usign = false;
                         adt->visibility = VT_PRIVATE;
                         adt->depth = i + 1;
+                        adt->soa = soa_blueprint != NULL;
                         dt = adt;
                     }
-                    vector_push(stack, ast_make_init(dt, token->loc));
-                    parser_ensure_cextern(p, "__libsgcllc_dynamic_ndim_array", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+                    ast_node_t* make = ast_make_init(dt, token->loc);
+                    make->make_soa_blueprint = soa_blueprint;
+                    vector_push(stack, make);
+                    if (soa_blueprint)
+                        parser_ensure_cextern(p, "__libsgcllc_soa_array", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
+                    else
+                        parser_ensure_cextern(p, "__libsgcllc_dynamic_ndim_array", t_void, vector_init(DEFAULT_CAPACITY, DEFAULT_ALLOC_DELTA));
                     break;
                 }
                 case OP_SCOPE:
@@ -1696,6 +2439,7 @@ next_token:
                     ast_node_t* random_flavor = NULL;
                     ast_node_t* modifier = NULL;
                     ast_node_type ntype = -1;
+                    int callee = 0;
                     for (int i = stack->size - 1; i >= 0; i--)
                     {
                         ast_node_t* node = vector_get(stack, i);
@@ -1703,6 +2447,7 @@ next_token:
                         if (node->type == AST_FUNC_DEFINITION)
                         {
                             random_flavor = node;
+                            callee = i;
                             break;
                         }
                         if ((node->type == OP_SELECTION || node->type == OP_SCOPE) && node->rhs->type == AST_FUNC_DEFINITION)
@@ -1714,6 +2459,17 @@ next_token:
                     }
                     if (!random_flavor)
                         errorp(token->loc->row, token->loc->col, "no function name provided for function call");
+                    // intrinsics take however many arguments are above them
+                    if (random_flavor->extrn == 'v')
+                    {
+                        vector_t* args = vector_init(max(stack->size - callee - 1, 1), 1);
+                        for (int i = callee + 1; i < stack->size; i++)
+                            vector_push(args, vector_get(stack, i));
+                        while (stack->size > callee)
+                            vector_pop(stack);
+                        vector_push(stack, parser_simd_intrinsic(p, token, random_flavor, args));
+                        break;
+                    }
                     vector_t* flavors = map_get(p->funcs, random_flavor->func_name);
                     ast_node_t* found = NULL;
                     if (random_flavor->extrn != 'b')
@@ -1724,7 +2480,7 @@ next_token:
                             ast_node_t* flavor = vector_get(flavors, i);
                             if (ntype == OP_SCOPE && strcmp(modifier->ns_name, flavor->residing))
                                 continue;
-                            if (ntype != OP_SCOPE && strcmp(flavor->residing, p->lex->filename))
+                            if (ntype != OP_SCOPE && ntype != OP_SELECTION && strcmp(flavor->residing, p->lex->filename))
                                 continue;
                             bool thisless = flavor->func_type == 'g' || flavor->func_type == 'c';
                             int thisless_size = flavor->params->size - (thisless ? 0 : 1);
@@ -1757,7 +2513,7 @@ found_function:
                         errorp(token->loc->row, token->loc->col, "could not find a function by the name of '%s' that matched the specified args", random_flavor->func_name);
                     if (!strcmp(found->func_name, "_"))
                         errorp(token->loc->row, token->loc->col, "cannot call unnamed functions");
-                    debugf("found function flavor: %s\n", found->func_label);
+                    tracef(TRACE_OVERLOADS, TRACE_INFO, "found function flavor: %s\n", found->func_label);
                     if (found->residing != NULL && strcmp(p->lex->filename, found->residing) && found->datatype->visibility != VT_PUBLIC)
                         errorp(token->loc->row, token->loc->col, "can't call a function that's private to '%s'", found->residing);
                     vector_t* args = vector_init(found->params->size, 1);
@@ -1777,7 +2533,7 @@ found_function:
                     if (!thisless)
                         args->data[0] = modifier;
                     vector_pop(stack); // pop func name
-                    vector_push(stack, ast_func_call_init(found->datatype, token->loc, found, args));
+                    vector_push(stack, parser_func_call(p, found, token->loc, args));
                     break;
                 }
             }
@@ -1785,12 +2541,13 @@ found_function:
     }
     if (!stack->size)
     {
-        #ifdef SGCLLC_DEBUG
-        printf("-- end of stack trace -\n");
-        for (int i = 0; i < stack->size; i++)
-            ast_print(vector_get(stack, i));
-        printf("-^^^- stack trace -^^^-\n");
-        #endif
+        if (tracing(TRACE_PARSER, TRACE_INFO))
+        {
+            printf("-- end of stack trace -\n");
+            for (int i = 0; i < stack->size; i++)
+                ast_print(vector_get(stack, i));
+            printf("-^^^- stack trace -^^^-\n");
+        }
         errorp(0, 0, "dev error: you messed up with the stack goofball");
     }
     ast_node_t* top = (ast_node_t*) vector_top(stack);
@@ -1827,6 +2584,32 @@ void parser_read(parser_t* p)
     return;
 }
 
+static void parser_release_func(ast_node_t* func)
+{
+    func->body->statements->size = 0;
+    func->local_variables->size = 0;
+}
+
+// once everything read so far has been emitted, the function bodies and tokens behind the parser aren't needed anymore
+void parser_release(parser_t* p)
+{
+    for (int i = 0; i < p->nfile->decls->size; i++)
+    {
+        ast_node_t* node = vector_get(p->nfile->decls, i);
+        if (node->type == AST_FUNC_DEFINITION)
+            parser_release_func(node);
+        else if (node->type == AST_BLUEPRINT)
+        {
+            for (int j = 0; j < node->methods->size; j++)
+                parser_release_func(vector_get(node->methods, j));
+        }
+    }
+    p->nfile->decls->size = 0;
+    if (p->body_nodes)
+        ast_release(p->body_nodes);
+    lex_release(p->lex, p->oindex);
+}
+
 void parser_delete(parser_t* p)
 {
     if (!p) return;
@@ -1834,5 +2617,10 @@ void parser_delete(parser_t* p)
     map_delete(p->lenv);
     vector_delete(p->userexterns);
     vector_delete(p->cexterns);
+    vector_delete(p->imports);
+    map_delete(p->resolved);
+    vector_delete(p->operators);
+    if (p->body_nodes)
+        vector_delete(p->body_nodes);
     free(p);
 }
\ No newline at end of file
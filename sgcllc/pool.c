@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sgcllc.h"
+
+// constants are keyed by kind and value, so 1.0 written twice (or as 1.00) ends up stored once
+
+pool_t* pool_init(void)
+{
+    pool_t* pool = calloc(1, sizeof(pool_t));
+    pool->index = map_init(NULL, 20);
+    pool->constants = vector_init(10, 10);
+    return pool;
+}
+
+constant_t* constant_init(int kind, char* text, unsigned long long low, unsigned long long high)
+{
+    constant_t* constant = calloc(1, sizeof(constant_t));
+    constant->kind = kind;
+    constant->text = text;
+    constant->bits[0] = low;
+    constant->bits[1] = high;
+    if (kind == CONSTANT_STRING)
+    {
+        constant->key = malloc(strlen(text) + 2);
+        sprintf(constant->key, "s%s", text);
+    }
+    else
+    {
+        constant->key = malloc(40);
+        sprintf(constant->key, "%c%016llx%016llx", "fdx"[kind], high, low);
+    }
+    return constant;
+}
+
+// float literals are keyed by their bits, which also saves gas from parsing them again
+constant_t* constant_float_init(datatype_t* dt, char* text)
+{
+    unsigned long long bits = 0;
+    if (dt->type == DTT_F32)
+    {
+        float value = strtof(text, NULL);
+        memcpy(&bits, &value, sizeof(float));
+        return constant_init(CONSTANT_F32, text, bits, 0);
+    }
+    double value = strtod(text, NULL);
+    memcpy(&bits, &value, sizeof(double));
+    return constant_init(CONSTANT_F64, text, bits, 0);
+}
+
+// returns the constant that was already pooled with the same value, or constant itself if it's new
+constant_t* pool_put(pool_t* pool, constant_t* constant)
+{
+    constant_t* pooled = map_get(pool->index, constant->key);
+    if (pooled)
+        return pooled;
+    map_put(pool->index, constant->key, constant);
+    vector_push(pool->constants, constant);
+    return constant;
+}
+
+void constant_delete(constant_t* constant)
+{
+    free(constant->key);
+    free(constant);
+}
+
+void pool_delete(pool_t* pool)
+{
+    map_delete(pool->index);
+    vector_delete(pool->constants);
+    free(pool);
+}
\ No newline at end of file
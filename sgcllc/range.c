@@ -0,0 +1,481 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sgcllc.h"
+
+// with --bounds-check every subscript compares its index against the length in front of what it subscripts. in a loop
+// like for (i = lo; i < bound; ++i) that never changes i or the arrays it subscripts with i, the comparisons inside
+// can all be made once: i stays in [lo, bound), so a[i] is in bounds whenever lo >= 0 and bound <= #a. whatever can't
+// be told from the code (bound <= #a when bound isn't #a itself, lo >= 0 when it isn't a literal, and bound fitting in
+// i) gets checked before the loop, and the loop is emitted twice: a copy without those checks for when they pass and
+// one keeping them for when they don't
+
+// every guarded loop doubles the loops inside it, so only this many get guarded inside each other
+#define RANGE_MAX_NESTING 3
+
+typedef struct
+{
+    parser_t* p;
+    ast_node_t* func;
+    int nesting; // guarded loops around the statement being looked at
+} range_t;
+
+static void range_stmt(range_t* rs, ast_node_t* stmt);
+
+// lvar itself, or a field or lane of it when it's a value blueprint or simd vector, which are kept in its own slot
+static bool range_writes(ast_node_t* target, ast_node_t* lvar)
+{
+    while ((target->type == OP_SELECTION || target->type == OP_SUBSCRIPT) && (isvaluetype(target->lhs->datatype) || target->lhs->datatype->type == DTT_SIMD))
+        target = target->lhs;
+    return target == lvar;
+}
+
+// whether anything under node assigns, increments or deletes lvar, or with uses so much as mentions it
+static bool range_touches(ast_node_t* node, ast_node_t* lvar, bool stmt, bool uses)
+{
+    if (!node)
+        return false;
+    switch (node->type)
+    {
+        // declared again every time around
+        case AST_LVAR:
+            return node == lvar ? stmt || uses : stmt && range_touches(node->vinit, lvar, false, uses);
+        case AST_BLOCK:
+        {
+            for (int i = 0; i < node->statements->size; i++)
+            {
+                if (range_touches(vector_get(node->statements, i), lvar, true, uses))
+                    return true;
+            }
+            return false;
+        }
+        case AST_IF:
+            return range_touches(node->if_cond, lvar, false, uses) || range_touches(node->if_then, lvar, true, uses) || range_touches(node->if_els, lvar, true, uses);
+        case AST_WHILE:
+            return range_touches(node->while_cond, lvar, false, uses) || range_touches(node->while_then, lvar, true, uses);
+        case AST_FOR:
+        {
+            return range_touches(node->for_init, lvar, true, uses) || range_touches(node->for_cond, lvar, false, uses) ||
+                range_touches(node->for_post, lvar, false, uses) || range_touches(node->for_then, lvar, true, uses) ||
+                (node->for_parallel && range_touches(node->for_parallel->limit, lvar, false, uses));
+        }
+        case AST_SWITCH:
+        {
+            if (range_touches(node->cmp, lvar, false, uses))
+                return true;
+            for (int i = 0; i < node->cases->size; i++)
+            {
+                ast_node_t* c = vector_get(node->cases, i);
+                if (range_touches(c->case_then, lvar, true, uses))
+                    return true;
+            }
+            return false;
+        }
+        case AST_RETURN:
+            return range_touches(node->retval, lvar, false, uses);
+        case AST_DELETE:
+            return node->delsym == lvar || range_touches(node->delsym, lvar, false, uses);
+        case OP_ASSIGN:
+        case OP_ASSIGN_ADD:
+        case OP_ASSIGN_SUB:
+        case OP_ASSIGN_MUL:
+        case OP_ASSIGN_DIV:
+        case OP_ASSIGN_MOD:
+        case OP_ASSIGN_AND:
+        case OP_ASSIGN_OR:
+        case OP_ASSIGN_XOR:
+        case OP_ASSIGN_SHIFT_LEFT:
+        case OP_ASSIGN_SHIFT_RIGHT:
+        case OP_ASSIGN_SHIFT_URIGHT:
+        {
+            if (range_writes(node->lhs, lvar))
+                return true;
+        }
+        // fallthrough
+        case OP_SELECTION:
+        case OP_SUBSCRIPT:
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_MOD:
+        case OP_EQUAL:
+        case OP_NOT_EQUAL:
+        case OP_GREATER:
+        case OP_GREATER_EQUAL:
+        case OP_LESS:
+        case OP_LESS_EQUAL:
+        case OP_AND:
+        case OP_OR:
+        case OP_XOR:
+        case OP_SHIFT_LEFT:
+        case OP_SHIFT_RIGHT:
+        case OP_SHIFT_URIGHT:
+        case OP_LOGICAL_AND:
+        case OP_LOGICAL_OR:
+            return range_touches(node->lhs, lvar, false, uses) || range_touches(node->rhs, lvar, false, uses);
+        case OP_PREFIX_INCREMENT:
+        case OP_PREFIX_DECREMENT:
+        case OP_POSTFIX_INCREMENT:
+        case OP_POSTFIX_DECREMENT:
+        {
+            if (range_writes(node->operand, lvar))
+                return true;
+        }
+        // fallthrough
+        case OP_MAGNITUDE:
+        case OP_NOT:
+        case OP_COMPLEMENT:
+        case OP_MINUS:
+        case OP_SPAWN: // the arguments are copied, so only they can write locals
+            return range_touches(node->operand, lvar, false, uses);
+        case AST_FUNC_CALL:
+        {
+            // a method gets a value blueprint's own slot as this
+            bool method = node->func->func_type != 'g' && node->func->func_type != 'c' && node->args->size;
+            if (method && isvaluetype(((ast_node_t*) vector_get(node->args, 0))->datatype) && range_writes(vector_get(node->args, 0), lvar))
+                return true;
+            for (int i = 0; i < node->args->size; i++)
+            {
+                if (range_touches(vector_get(node->args, i), lvar, false, uses))
+                    return true;
+            }
+            return false;
+        }
+        case AST_CAST:
+            return range_touches(node->castval, lvar, false, uses);
+        case OP_SLICE:
+            return range_touches(node->slice_base, lvar, false, uses) || range_touches(node->slice_lo, lvar, false, uses) || range_touches(node->slice_hi, lvar, false, uses);
+        case AST_TERNARY:
+            return range_touches(node->tern_cond, lvar, false, uses) || range_touches(node->tern_then, lvar, false, uses) || range_touches(node->tern_els, lvar, false, uses);
+        case AST_MAKE:
+        {
+            datatype_t* current = node->datatype;
+            for (int i = 0; i < node->datatype->depth; i++, current = current->array_type)
+            {
+                if (range_touches(current->length, lvar, false, uses))
+                    return true;
+            }
+            return false;
+        }
+        case OP_ASM: // could write to anything
+            return true;
+    }
+    return false;
+}
+
+bool range_modifies(ast_node_t* node, ast_node_t* lvar, bool stmt)
+{
+    return range_touches(node, lvar, stmt, false);
+}
+
+bool range_uses(ast_node_t* node, ast_node_t* lvar)
+{
+    return range_touches(node, lvar, true, true);
+}
+
+// what a loop counts with and where it starts, if it counts up by one
+ast_node_t* range_induction(ast_node_t* loop, ast_node_t** start)
+{
+    ast_node_t* init = loop->for_init, * cond = loop->for_cond, * post = loop->for_post;
+    ast_node_t* var;
+    if (init && init->type == AST_LVAR && init->vinit) // declarations keep the whole i = lo
+        init = init->vinit;
+    if (init && init->type == OP_ASSIGN && init->lhs->type == AST_LVAR)
+    {
+        var = init->lhs;
+        *start = init->rhs;
+    }
+    else
+        return NULL;
+    if (!isintegraltype(var->datatype->type) || var->datatype->usign)
+        return NULL;
+    if (!cond || cond->type != OP_LESS || cond->lhs != var)
+        return NULL;
+    if (!isintegraltype(cond->rhs->datatype->type) || cond->rhs->datatype->usign)
+        return NULL;
+    if (!post)
+        return NULL;
+    bool step = ((post->type == OP_PREFIX_INCREMENT || post->type == OP_POSTFIX_INCREMENT) && post->operand == var) ||
+        (post->type == OP_ASSIGN_ADD && post->lhs == var && post->rhs->type == AST_ILITERAL && post->rhs->ivalue == 1);
+    return step ? var : NULL;
+}
+
+// the bound has to come out the same every time the condition is checked
+bool range_invariant(ast_node_t* bound, ast_node_t* body)
+{
+    switch (bound->type)
+    {
+        case AST_ILITERAL:
+            return true;
+        case AST_LVAR:
+            return !range_modifies(body, bound, true);
+        // strings can grow in place through another variable
+        case OP_MAGNITUDE:
+        {
+            ast_node_t* measured = bound->operand;
+            return measured->type == AST_LVAR && (measured->datatype->type == DTT_ARRAY || measured->datatype->type == DTT_SLICE) &&
+                !range_modifies(body, measured, true);
+        }
+    }
+    return false;
+}
+
+bool range_needs_sign_guard(ast_node_t* loop)
+{
+    ast_node_t* start;
+    range_induction(loop, &start);
+    return start->type != AST_ILITERAL || start->ivalue < 0;
+}
+
+// i < bound converts both to the wider type, a narrower i could wrap around before reaching it
+bool range_needs_width_guard(ast_node_t* loop)
+{
+    return loop->for_cond->lhs->datatype->size < loop->for_cond->rhs->datatype->size;
+}
+
+// bound <= #a holds without checking when the bound is #a
+static bool range_needs_length_guard(ast_node_t* loop, ast_node_t* array)
+{
+    ast_node_t* bound = loop->for_cond->rhs;
+    return bound->type != OP_MAGNITUDE || bound->operand != array;
+}
+
+// collects the subscripts under node that are indexed by var and subscript something body doesn't change
+static void range_claim(ast_node_t* node, ast_node_t* body, ast_node_t* var, vector_t* subscripts, bool stmt)
+{
+    if (!node)
+        return;
+    switch (node->type)
+    {
+        case AST_LVAR:
+        {
+            if (stmt)
+                range_claim(node->vinit, body, var, subscripts, false);
+            break;
+        }
+        case AST_BLOCK:
+        {
+            for (int i = 0; i < node->statements->size; i++)
+                range_claim(vector_get(node->statements, i), body, var, subscripts, true);
+            break;
+        }
+        case AST_IF:
+        {
+            range_claim(node->if_cond, body, var, subscripts, false);
+            range_claim(node->if_then, body, var, subscripts, true);
+            range_claim(node->if_els, body, var, subscripts, true);
+            break;
+        }
+        case AST_WHILE:
+        {
+            range_claim(node->while_cond, body, var, subscripts, false);
+            range_claim(node->while_then, body, var, subscripts, true);
+            break;
+        }
+        case AST_FOR:
+        {
+            range_claim(node->for_init, body, var, subscripts, true);
+            range_claim(node->for_cond, body, var, subscripts, false);
+            range_claim(node->for_post, body, var, subscripts, false);
+            range_claim(node->for_then, body, var, subscripts, true);
+            break;
+        }
+        case AST_SWITCH:
+        {
+            range_claim(node->cmp, body, var, subscripts, false);
+            for (int i = 0; i < node->cases->size; i++)
+                range_claim(((ast_node_t*) vector_get(node->cases, i))->case_then, body, var, subscripts, true);
+            break;
+        }
+        case AST_RETURN:
+        {
+            range_claim(node->retval, body, var, subscripts, false);
+            break;
+        }
+        case AST_DELETE:
+        {
+            range_claim(node->delsym, body, var, subscripts, false);
+            break;
+        }
+        case OP_SUBSCRIPT:
+        {
+            ast_node_t* array = node->lhs;
+            datatype_type dtt = array->datatype->type;
+            if (node->rhs == var && array->type == AST_LVAR && (dtt == DTT_ARRAY || dtt == DTT_SLICE || dtt == DTT_STRING) &&
+                !range_modifies(body, array, true))
+                vector_push(subscripts, node);
+        }
+        // fallthrough
+        case OP_ASSIGN:
+        case OP_ASSIGN_ADD:
+        case OP_ASSIGN_SUB:
+        case OP_ASSIGN_MUL:
+        case OP_ASSIGN_DIV:
+        case OP_ASSIGN_MOD:
+        case OP_ASSIGN_AND:
+        case OP_ASSIGN_OR:
+        case OP_ASSIGN_XOR:
+        case OP_ASSIGN_SHIFT_LEFT:
+        case OP_ASSIGN_SHIFT_RIGHT:
+        case OP_ASSIGN_SHIFT_URIGHT:
+        case OP_SELECTION:
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_MOD:
+        case OP_EQUAL:
+        case OP_NOT_EQUAL:
+        case OP_GREATER:
+        case OP_GREATER_EQUAL:
+        case OP_LESS:
+        case OP_LESS_EQUAL:
+        case OP_AND:
+        case OP_OR:
+        case OP_XOR:
+        case OP_SHIFT_LEFT:
+        case OP_SHIFT_RIGHT:
+        case OP_SHIFT_URIGHT:
+        case OP_LOGICAL_AND:
+        case OP_LOGICAL_OR:
+        {
+            range_claim(node->lhs, body, var, subscripts, false);
+            range_claim(node->rhs, body, var, subscripts, false);
+            break;
+        }
+        case OP_PREFIX_INCREMENT:
+        case OP_PREFIX_DECREMENT:
+        case OP_POSTFIX_INCREMENT:
+        case OP_POSTFIX_DECREMENT:
+        case OP_MAGNITUDE:
+        case OP_NOT:
+        case OP_COMPLEMENT:
+        case OP_MINUS:
+        case OP_SPAWN:
+        {
+            range_claim(node->operand, body, var, subscripts, false);
+            break;
+        }
+        case AST_FUNC_CALL:
+        {
+            for (int i = 0; i < node->args->size; i++)
+                range_claim(vector_get(node->args, i), body, var, subscripts, false);
+            break;
+        }
+        case AST_CAST:
+        {
+            range_claim(node->castval, body, var, subscripts, false);
+            break;
+        }
+        case OP_SLICE:
+        {
+            range_claim(node->slice_base, body, var, subscripts, false);
+            range_claim(node->slice_lo, body, var, subscripts, false);
+            range_claim(node->slice_hi, body, var, subscripts, false);
+            break;
+        }
+        case AST_TERNARY:
+        {
+            range_claim(node->tern_cond, body, var, subscripts, false);
+            range_claim(node->tern_then, body, var, subscripts, false);
+            range_claim(node->tern_els, body, var, subscripts, false);
+            break;
+        }
+        case AST_MAKE:
+        {
+            datatype_t* current = node->datatype;
+            for (int i = 0; i < node->datatype->depth; i++, current = current->array_type)
+                range_claim(current->length, body, var, subscripts, false);
+            break;
+        }
+    }
+}
+
+static void range_loop(range_t* rs, ast_node_t* loop)
+{
+    ast_node_t* start;
+    ast_node_t* var = range_induction(loop, &start);
+    if (!var || range_modifies(loop->for_then, var, true) || !range_invariant(loop->for_cond->rhs, loop->for_then))
+        return;
+    vector_t* subscripts = vector_init(8, 8);
+    range_claim(loop->for_then, loop->for_then, var, subscripts, true);
+    vector_t* guards = vector_init(4, 4);
+    for (int i = 0; i < subscripts->size; i++)
+    {
+        ast_node_t* array = ((ast_node_t*) vector_get(subscripts, i))->lhs;
+        bool listed = !range_needs_length_guard(loop, array);
+        for (int j = 0; j < guards->size && !listed; j++)
+            listed = vector_get(guards, j) == array;
+        if (!listed)
+            vector_push(guards, array);
+    }
+    bool checked = guards->size || range_needs_sign_guard(loop) || range_needs_width_guard(loop);
+    if (!subscripts->size || (checked && rs->nesting >= RANGE_MAX_NESTING))
+    {
+        // the subscripts stay checked one by one
+        vector_delete(subscripts);
+        vector_delete(guards);
+        return;
+    }
+    for (int i = 0; i < subscripts->size; i++)
+        ((ast_node_t*) vector_get(subscripts, i))->subscript_guard = loop;
+    vector_delete(subscripts);
+    if (checked)
+    {
+        loop->for_guards = guards;
+        tracef(TRACE_PARSER, TRACE_INFO, "%s: loop at %i:%i checks %i arrays before it starts\n", rs->func->func_label, loop->loc->row, loop->loc->col, guards->size);
+    }
+    else
+    {
+        vector_delete(guards);
+        loop->for_fast = true; // nothing left to check, so there's only the fast copy
+        tracef(TRACE_PARSER, TRACE_INFO, "%s: loop at %i:%i needs no bounds checks\n", rs->func->func_label, loop->loc->row, loop->loc->col);
+    }
+}
+
+static void range_stmt(range_t* rs, ast_node_t* stmt)
+{
+    if (!stmt)
+        return;
+    switch (stmt->type)
+    {
+        case AST_BLOCK:
+        {
+            for (int i = 0; i < stmt->statements->size; i++)
+                range_stmt(rs, vector_get(stmt->statements, i));
+            break;
+        }
+        case AST_IF:
+        {
+            range_stmt(rs, stmt->if_then);
+            range_stmt(rs, stmt->if_els);
+            break;
+        }
+        case AST_WHILE:
+        {
+            range_stmt(rs, stmt->while_then);
+            break;
+        }
+        case AST_FOR:
+        {
+            range_loop(rs, stmt);
+            rs->nesting += stmt->for_guards != NULL;
+            range_stmt(rs, stmt->for_then);
+            rs->nesting -= stmt->for_guards != NULL;
+            break;
+        }
+        case AST_SWITCH:
+        {
+            for (int i = 0; i < stmt->cases->size; i++)
+                range_stmt(rs, ((ast_node_t*) vector_get(stmt->cases, i))->case_then);
+            break;
+        }
+    }
+}
+
+void range_analyze(parser_t* p, ast_node_t* func)
+{
+    range_t rs = { p, func, 0 };
+    range_stmt(&rs, func->body);
+}
\ No newline at end of file
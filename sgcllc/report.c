@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef _WIN32
+#define NOMINMAX // sgcllc.h has its own
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+#include "sgcllc.h"
+
+// time is charged to whichever phase is current, so a phase running inside another (imports inside parsing)
+// doesn't get counted twice
+
+typedef struct
+{
+    double wall;
+    double cpu;
+    long long peak_growth;
+} report_phase_t;
+
+static char* phase_names[PHASE_COUNT] = { "other", "lex", "parse", "import", "header", "emit", "assemble", "link" };
+
+static bool enabled = false;
+static int mode;
+static int current;
+static double last_wall, last_cpu;
+static long long last_peak;
+static report_phase_t phases[PHASE_COUNT];
+static int files, tokens, labels;
+static unsigned long long ast_nodes_start;
+
+static double report_wall(void)
+{
+    #ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double) counter.QuadPart / frequency.QuadPart;
+    #else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+    #endif
+}
+
+#ifdef _WIN32
+// sgcllc puts itself in a job so the children it spawns (cmd, as and ld) land in it too, NULL when windows wouldn't
+// let it (a job inside a job before windows 8)
+static HANDLE job = NULL;
+
+static double report_filetime(LARGE_INTEGER time)
+{
+    return time.QuadPart / 1e7;
+}
+#endif
+
+// includes as and ld, they run as children (on windows only when sgcllc got its job)
+static double report_cpu(void)
+{
+    #ifdef _WIN32
+    JOBOBJECT_BASIC_ACCOUNTING_INFORMATION accounting;
+    if (job && QueryInformationJobObject(job, JobObjectBasicAccountingInformation, &accounting, sizeof(accounting), NULL))
+        return report_filetime(accounting.TotalUserTime) + report_filetime(accounting.TotalKernelTime);
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user))
+        return 0;
+    ULARGE_INTEGER k = { .LowPart = kernel.dwLowDateTime, .HighPart = kernel.dwHighDateTime };
+    ULARGE_INTEGER u = { .LowPart = user.dwLowDateTime, .HighPart = user.dwHighDateTime };
+    return (k.QuadPart + u.QuadPart) / 1e7;
+    #else
+    struct rusage self, children;
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &children);
+    return self.ru_utime.tv_sec + self.ru_stime.tv_sec + children.ru_utime.tv_sec + children.ru_stime.tv_sec +
+        (self.ru_utime.tv_usec + self.ru_stime.tv_usec + children.ru_utime.tv_usec + children.ru_stime.tv_usec) / 1e6;
+    #endif
+}
+
+// peak resident set in kb, the os only hands out the high-water mark so phases get charged for raising it
+static long long report_peak(void)
+{
+    #ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ? (long long) (pmc.PeakWorkingSetSize / 1024) : 0;
+    #else
+    struct rusage self;
+    getrusage(RUSAGE_SELF, &self);
+    return self.ru_maxrss;
+    #endif
+}
+
+void report_start(int report_mode)
+{
+    enabled = report_mode != REPORT_NONE;
+    if (!enabled)
+        return;
+    mode = report_mode;
+    #ifdef _WIN32
+    if (!job && (job = CreateJobObjectA(NULL, NULL)) && !AssignProcessToJobObject(job, GetCurrentProcess()))
+    {
+        CloseHandle(job);
+        job = NULL;
+    }
+    #endif
+    current = PHASE_OTHER;
+    for (int i = 0; i < PHASE_COUNT; i++)
+        phases[i] = (report_phase_t){ 0 };
+    files = tokens = labels = 0;
+    ast_nodes_start = ast_node_count;
+    last_wall = report_wall();
+    last_cpu = report_cpu();
+    last_peak = report_peak();
+}
+
+int report_switch(int phase)
+{
+    if (!enabled)
+        return phase;
+    double wall = report_wall(), cpu = report_cpu();
+    long long peak = report_peak();
+    phases[current].wall += wall - last_wall;
+    phases[current].cpu += cpu - last_cpu;
+    phases[current].peak_growth += peak - last_peak;
+    last_wall = wall;
+    last_cpu = cpu;
+    last_peak = peak;
+    int previous = current;
+    current = phase;
+    return previous;
+}
+
+void report_count(int file_tokens, int file_labels)
+{
+    if (!enabled)
+        return;
+    files++;
+    tokens += file_tokens;
+    labels += file_labels;
+}
+
+void report_finish(void)
+{
+    if (!enabled)
+        return;
+    report_switch(PHASE_OTHER);
+    enabled = false;
+    report_phase_t total = { 0 };
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        total.wall += phases[i].wall;
+        total.cpu += phases[i].cpu;
+        total.peak_growth += phases[i].peak_growth;
+    }
+    unsigned long long ast_nodes = ast_node_count - ast_nodes_start;
+    if (mode == REPORT_JSON)
+    {
+        fprintf(stderr, "{\"files\": %i, \"tokens\": %i, \"ast_nodes\": %llu, \"labels\": %i, \"peak_kb\": %lli, \"phases\": {",
+            files, tokens, ast_nodes, labels, last_peak);
+        for (int i = 0; i < PHASE_COUNT; i++)
+            fprintf(stderr, "%s\"%s\": {\"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"peak_growth_kb\": %lli}", i ? ", " : "",
+                phase_names[i], phases[i].wall * 1000, phases[i].cpu * 1000, phases[i].peak_growth);
+        fprintf(stderr, "}, \"total\": {\"wall_ms\": %.3f, \"cpu_ms\": %.3f}}\n", total.wall * 1000, total.cpu * 1000);
+        return;
+    }
+    fprintf(stderr, "sgcllc: time report (%i files, %i tokens, %llu ast nodes, %i labels)\n", files, tokens, ast_nodes, labels);
+    fprintf(stderr, "    %-10s %12s %12s %18s\n", "phase", "wall (ms)", "cpu (ms)", "peak growth (kb)");
+    for (int i = 0; i < PHASE_COUNT; i++)
+        fprintf(stderr, "    %-10s %12.3f %12.3f %18lli\n", phase_names[i], phases[i].wall * 1000, phases[i].cpu * 1000, phases[i].peak_growth);
+    fprintf(stderr, "    %-10s %12.3f %12.3f %18lli\n", "total", total.wall * 1000, total.cpu * 1000, total.peak_growth);
+    fprintf(stderr, "    peak memory: %lli kb\n", last_peak);
+}
\ No newline at end of file
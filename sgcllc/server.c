@@ -0,0 +1,364 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef _WIN32
+
+#define NOMINMAX // sgcllc.h has its own
+#include <windows.h>
+#include <io.h>
+
+#else
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#endif
+
+#include "sgcllc.h"
+
+// sgcllc.h's read and write are for headers, these are the posix ones
+#undef read
+#undef write
+
+// a request is one message carrying the client's stdout and stderr, as fds over a unix socket or as handles the server
+// copies out of the client over a named pipe on windows:
+//     argument count (4 bytes), on windows the two handles (8 bytes each), then the client's working directory and
+//     every argument, each nul-terminated
+// and the reply is the exit status (4 bytes)
+
+#ifdef _WIN32
+typedef HANDLE connection_t;
+#else
+typedef int connection_t;
+#endif
+
+static bool read_full(connection_t c, void* data, size_t size)
+{
+    for (size_t done = 0; done < size;)
+    {
+        #ifdef _WIN32
+        DWORD got;
+        if (!ReadFile(c, (char*) data + done, size - done, &got, NULL) || !got)
+            return false;
+        #else
+        ssize_t got = read(c, (char*) data + done, size - done);
+        if (got <= 0)
+            return false;
+        #endif
+        done += got;
+    }
+    return true;
+}
+
+static bool write_full(connection_t c, void* data, size_t size)
+{
+    for (size_t done = 0; done < size;)
+    {
+        #ifdef _WIN32
+        DWORD put;
+        if (!WriteFile(c, (char*) data + done, size - done, &put, NULL) || !put)
+            return false;
+        #else
+        ssize_t put = write(c, (char*) data + done, size - done);
+        if (put <= 0)
+            return false;
+        #endif
+        done += put;
+    }
+    return true;
+}
+
+static void connection_close(connection_t c)
+{
+    #ifdef _WIN32
+    CloseHandle(c);
+    #else
+    close(c);
+    #endif
+}
+
+static char* read_cstr(connection_t c)
+{
+    buffer_t* buffer = buffer_init(64, 64);
+    for (char ch = 1; ch;)
+    {
+        if (!read_full(c, &ch, 1))
+        {
+            buffer_delete(buffer);
+            return NULL;
+        }
+        buffer_append(buffer, ch);
+    }
+    char* str = buffer_export(buffer);
+    buffer_delete(buffer);
+    return str;
+}
+
+#ifdef _WIN32
+
+// pipes have their own namespace instead of living in the directory, so the name is the socket's full path to still
+// get a server per directory
+static char* pipe_name(char* socket_path)
+{
+    char full[MAX_PATH];
+    DWORD length = GetFullPathNameA(socket_path, MAX_PATH, full, NULL);
+    if (!length || length >= MAX_PATH || length + 9 > 256)
+        errorc("socket path '%s' is too long", socket_path);
+    char* name = calloc(length + 10, sizeof(char));
+    sprintf(name, "\\\\.\\pipe\\%s", full);
+    for (char* c = name + 9; *c; c++)
+    {
+        if (*c == '\\')
+            *c = '/';
+    }
+    return name;
+}
+
+static int server_receive(connection_t client, int* fds)
+{
+    int count;
+    unsigned long long handles[2];
+    ULONG pid;
+    if (!read_full(client, &count, sizeof(int)) || !read_full(client, handles, sizeof(handles)) ||
+        !GetNamedPipeClientProcessId(client, &pid))
+        return -1;
+    HANDLE process = OpenProcess(PROCESS_DUP_HANDLE, FALSE, pid);
+    if (!process)
+        return -1;
+    for (int i = 0; i < 2; i++)
+    {
+        HANDLE mine;
+        fds[i] = -1;
+        if (DuplicateHandle(process, (HANDLE) (uintptr_t) handles[i], GetCurrentProcess(), &mine, 0, FALSE, DUPLICATE_SAME_ACCESS) &&
+            (fds[i] = _open_osfhandle((intptr_t) mine, 0)) < 0)
+            CloseHandle(mine);
+    }
+    CloseHandle(process);
+    if (fds[0] < 0 || fds[1] < 0)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            if (fds[i] >= 0)
+                close(fds[i]);
+        }
+        return -1;
+    }
+    return count;
+}
+
+#else
+
+static int socket_init(char* socket_path, struct sockaddr_un* address)
+{
+    if (strlen(socket_path) >= sizeof(address->sun_path))
+        errorc("socket path '%s' is too long", socket_path);
+    memset(address, 0, sizeof(struct sockaddr_un));
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, socket_path);
+    return socket(AF_UNIX, SOCK_STREAM, 0);
+}
+
+static int server_receive(int client, int* fds)
+{
+    int count;
+    struct iovec iov = { &count, sizeof(int) };
+    char control[CMSG_SPACE(2 * sizeof(int))];
+    struct msghdr msg = { 0 };
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(client, &msg, MSG_WAITALL) != sizeof(int))
+        return -1;
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int)))
+        return -1;
+    memcpy(fds, CMSG_DATA(cmsg), 2 * sizeof(int));
+    return count;
+}
+
+#endif
+
+static char* server_cwd = NULL;
+
+static void server_handle(connection_t client)
+{
+    int fds[2];
+    int count = server_receive(client, fds);
+    if (count < 0)
+        return;
+    char* cwd = read_cstr(client);
+    char** paths = calloc(count + 1, sizeof(char*));
+    bool ok = cwd != NULL;
+    for (int i = 0; i < count && ok; i++)
+        ok = (paths[i] = read_cstr(client)) != NULL;
+    int status = EXIT_FAILURE;
+    if (ok && !chdir(cwd))
+    {
+        if (!server_cwd || strcmp(server_cwd, cwd))
+            import_cache_reset();
+        free(server_cwd);
+        server_cwd = cwd;
+        cwd = NULL;
+        // the compile writes straight to the client's terminal
+        fflush(stdout);
+        fflush(stderr);
+        int saved_out = dup(STDOUT_FILENO), saved_err = dup(STDERR_FILENO);
+        dup2(fds[0], STDOUT_FILENO);
+        dup2(fds[1], STDERR_FILENO);
+        jmp_buf env;
+        if (!setjmp(env))
+        {
+            error_recover(&env);
+            status = compile(count, paths);
+        }
+        else
+            build_abort();
+        error_recover(NULL);
+        fflush(stdout);
+        fflush(stderr);
+        dup2(saved_out, STDOUT_FILENO);
+        dup2(saved_err, STDERR_FILENO);
+        close(saved_out);
+        close(saved_err);
+    }
+    close(fds[0]);
+    close(fds[1]);
+    write_full(client, &status, sizeof(int));
+    for (int i = 0; i < count; i++)
+        free(paths[i]);
+    free(paths);
+    free(cwd);
+}
+
+#ifdef _WIN32
+
+int server_run(char* socket_path)
+{
+    char* name = pipe_name(socket_path);
+    // one instance, so a second server can't start on the same pipe and clients queue up behind the one being served
+    HANDLE server = CreateNamedPipeA(name, PIPE_ACCESS_DUPLEX | FILE_FLAG_FIRST_PIPE_INSTANCE,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, 4096, 4096, 0, NULL);
+    if (server == INVALID_HANDLE_VALUE)
+        errorc("could not listen on '%s'", name);
+    set_up_keywords();
+    set_up_builtins();
+    printf("sgcllc: listening on %s\n", name);
+    fflush(stdout);
+    for (;;)
+    {
+        if (!ConnectNamedPipe(server, NULL) && GetLastError() != ERROR_PIPE_CONNECTED)
+            continue;
+        server_handle(server);
+        FlushFileBuffers(server); // disconnecting throws away whatever the client hasn't read yet
+        DisconnectNamedPipe(server);
+    }
+    return EXIT_SUCCESS;
+}
+
+#else
+
+int server_run(char* socket_path)
+{
+    struct sockaddr_un address;
+    int server = socket_init(socket_path, &address);
+    if (server < 0)
+        errorc("could not create a socket for the server");
+    unlink(socket_path);
+    if (bind(server, (struct sockaddr*) &address, sizeof(address)) || listen(server, 16))
+        errorc("could not listen on '%s'", socket_path);
+    signal(SIGPIPE, SIG_IGN); // a client going away shouldn't take the server with it
+    set_up_keywords();
+    set_up_builtins();
+    printf("sgcllc: listening on %s\n", socket_path);
+    fflush(stdout);
+    for (;;)
+    {
+        int client = accept(server, NULL, NULL);
+        if (client < 0)
+            continue;
+        server_handle(client);
+        close(client);
+    }
+    return EXIT_SUCCESS;
+}
+
+#endif
+
+static int client_local(int count, char** paths)
+{
+    set_up_keywords();
+    set_up_builtins();
+    return compile(count, paths);
+}
+
+// everything after the count and the output, the same on both
+static int client_request(connection_t server, char* socket_path, int count, char** paths)
+{
+    char* cwd = getcwd(NULL, 0);
+    bool ok = cwd && write_full(server, cwd, strlen(cwd) + 1);
+    for (int i = 0; i < count && ok; i++)
+        ok = write_full(server, paths[i], strlen(paths[i]) + 1);
+    free(cwd);
+    int status;
+    if (!ok || !read_full(server, &status, sizeof(int)))
+        errorc("lost the connection to the server on '%s'", socket_path);
+    connection_close(server);
+    return status;
+}
+
+#ifdef _WIN32
+
+int client_run(char* socket_path, int count, char** paths)
+{
+    char* name = pipe_name(socket_path);
+    HANDLE server = CreateFileA(name, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+    // busy with another client, which a socket's backlog would have waited out too
+    while (server == INVALID_HANDLE_VALUE && GetLastError() == ERROR_PIPE_BUSY && WaitNamedPipeA(name, NMPWAIT_WAIT_FOREVER))
+        server = CreateFileA(name, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+    free(name);
+    // no server is no problem, it's just slower
+    if (server == INVALID_HANDLE_VALUE)
+        return client_local(count, paths);
+    unsigned long long handles[2] = { (uintptr_t) _get_osfhandle(STDOUT_FILENO), (uintptr_t) _get_osfhandle(STDERR_FILENO) };
+    if (!write_full(server, &count, sizeof(int)) || !write_full(server, handles, sizeof(handles)))
+        errorc("lost the connection to the server on '%s'", socket_path);
+    return client_request(server, socket_path, count, paths);
+}
+
+#else
+
+int client_run(char* socket_path, int count, char** paths)
+{
+    struct sockaddr_un address;
+    int server = socket_init(socket_path, &address);
+    // no server is no problem, it's just slower
+    if (server < 0 || connect(server, (struct sockaddr*) &address, sizeof(address)))
+    {
+        if (server >= 0)
+            close(server);
+        return client_local(count, paths);
+    }
+    int fds[2] = { STDOUT_FILENO, STDERR_FILENO };
+    struct iovec iov = { &count, sizeof(int) };
+    char control[CMSG_SPACE(2 * sizeof(int))];
+    memset(control, 0, sizeof(control));
+    struct msghdr msg = { 0 };
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+    memcpy(CMSG_DATA(cmsg), fds, 2 * sizeof(int));
+    if (sendmsg(server, &msg, 0) != sizeof(int))
+        errorc("lost the connection to the server on '%s'", socket_path);
+    return client_request(server, socket_path, count, paths);
+}
+
+#endif
@@ -31,84 +31,212 @@ bool chk_extension(char* path, int len)
     return true;
 }
 
-vector_t* build(char* path)
+static FILE* build_out = NULL; // the assembly being written, if an error cuts the build short it's still open
+static FILE* build_in = NULL; // same for the source, which stays open through parsing when streaming
+
+// for when an error jumped out of build
+void build_abort(void)
 {
-    int pathl = strlen(path);
-    if (!chk_extension(path, pathl))
-        errorc("input file does not have extension .sgcll");
-    FILE* file = fopen(path, "r");
-    lexer_t* lexer = lex_init(file, path);
-    while (!lex_eof(lexer))
-        lex_read_token(lexer);
-    #ifdef SGCLLC_DEBUG
-    for (int i = 0; i < lexer->output->size; i++)
-    {
-        token_t* token = vector_get(lexer->output, i);
-        if (token_has_content(token))
-            printf("%s\n", token->content);
-        else
-            printf("%c (id: %i)\n", token->id, token->id);
-    }
-    #endif
-    parser_t* parser = parser_init(lexer);
-    while (!parser_eof(parser))
-        parser_read(parser);
-    #ifdef SGCLLC_DEBUG
-    ast_print(parser->nfile);
-    #endif
+    if (build_out)
+        fclose(build_out);
+    if (build_in)
+        fclose(build_in);
+    build_out = build_in = NULL;
+    ast_track(NULL);
+}
+
+static void build_header(parser_t* parser, char* path, int pathl)
+{
+    report_switch(PHASE_HEADER);
     char* header = calloc(pathl + 2, sizeof(char));
     strcpy(header, path);
     header[pathl] = 'h';
     header[pathl + 1] = '\0';
+    import_cache_invalidate(header);
     FILE* hout = fopen(header, "wb");
     parser_make_header(parser, hout);
     fclose(hout);
     free(header);
+}
+
+// each declaration is emitted as soon as it's parsed and then thrown out, so memory goes with the biggest function
+// instead of the whole file
+static void build_stream(parser_t* parser, char* path, int pathl, char* assembly)
+{
+    report_switch(PHASE_PARSE);
+    parser->body_nodes = vector_init(100, 100);
+    build_out = fopen(assembly, "w");
+    emitter_t* emitter = emitter_init(parser, build_out, true);
+    while (!parser_eof(parser))
+    {
+        parser_read(parser);
+        report_switch(PHASE_EMIT);
+        emitter_stream(emitter);
+        report_switch(PHASE_PARSE);
+        parser_release(parser);
+    }
+    fclose(build_in);
+    build_in = parser->lex->file = NULL;
+    build_header(parser, path, pathl);
+    report_switch(PHASE_EMIT);
+    emitter_stream_end(emitter);
+    emitter_delete(emitter);
+    fclose(build_out);
+    build_out = NULL;
+}
+
+vector_t* build(char* path)
+{
+    int pathl = strlen(path);
+    if (!chk_extension(path, pathl))
+        errorc("input file does not have extension .sgcll");
+    build_in = fopen(path, "r");
+    if (!build_in)
+        errorc("could not open '%s'", path);
+    lexer_t* lexer = lex_init(build_in, path);
+    parser_t* parser = parser_init(lexer);
     char* assembly = calloc(pathl + 1, sizeof(char));
     strcpy(assembly, path);
     assembly[pathl - 4] = '\0';
-    FILE* out = fopen(assembly, "w");
-    emitter_t* emitter = emitter_init(parser, out, true);
-    emitter_emit(emitter);
-    emitter_delete(emitter);
-    fclose(out);
+    if (options->stream)
+        build_stream(parser, path, pathl, assembly);
+    else
+    {
+        report_switch(PHASE_LEX);
+        while (!lex_eof(lexer))
+            lex_read_token(lexer);
+        fclose(build_in);
+        build_in = lexer->file = NULL;
+        if (tracing(TRACE_LEXER, TRACE_VERBOSE))
+        {
+            for (int i = 0; i < lexer->output->size; i++)
+            {
+                token_t* token = vector_get(lexer->output, i);
+                if (token_has_content(token))
+                    printf("%s\n", token->content);
+                else
+                    printf("%c (id: %i)\n", token->id, token->id);
+            }
+        }
+        report_switch(PHASE_PARSE);
+        while (!parser_eof(parser))
+            parser_read(parser);
+        if (tracing(TRACE_PARSER, TRACE_VERBOSE))
+            ast_print(parser->nfile);
+        build_header(parser, path, pathl);
+        report_switch(PHASE_EMIT);
+        build_out = fopen(assembly, "w");
+        emitter_t* emitter = emitter_init(parser, build_out, true);
+        emitter_emit(emitter);
+        emitter_delete(emitter);
+        fclose(build_out);
+        build_out = NULL;
+    }
+    report_count(lexer->released + lexer->output->size, parser->labels->size);
+    report_switch(PHASE_OTHER);
     lex_delete(lexer);
-    fclose(file);
     free(assembly);
     vector_t* links = parser->links;
     parser_delete(parser);
     return links;
 }
 
-int main(int argc, char** argv)
+int compile(int argc, char** argv)
 {
-    if (argc != 2)
-        errorc("only one file input is supported currently");
-    set_up_keywords();
-    set_up_builtins();
     FILE* options_file = fopen("options", "rb");
     options = read_options(options_file);
-    fclose(options_file);
-    char* path = argv[1];
-    int pathl = strlen(path);
-    char* assembly = calloc(pathl + 1, sizeof(char));
-    strcpy(assembly, path);
-    assembly[pathl - 4] = '\0';
-    char* object = calloc(pathl + 1, sizeof(char));
-    strcpy(object, assembly);
-    object[pathl - 5] = 'o';
-    vector_t* links = build(path);
-    char assemble[1024];
-    sprintf(assemble, "as -o %s %s", object, assembly);
-    char link[1024];
-    sprintf(link, "ld -o a.exe %s libsgcllc/libsgcllc.a libsgcll/libsgcll.a %s -lkernel32", object, options->fdlibm_path);
-    debugf("assembler command: %s\n", assemble);
-    debugf("linker command: %s\n", link);
-    system(assemble);
+    if (options_file)
+        fclose(options_file);
+    trace_setup(getenv("SGCLLC_TRACE"));
+    char** paths = calloc(argc, sizeof(char*));
+    int count = 0;
+    options->jobs = 1;
+    options->stream = false;
+    options->bounds_check = false;
+    options->avx2 = false;
+    options->fast_math = false;
+    for (int i = 0; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--time-report"))
+            options->time_report = REPORT_TEXT;
+        else if (!strcmp(argv[i], "--time-report=json"))
+            options->time_report = REPORT_JSON;
+        else if (!strncmp(argv[i], "--jobs=", 7))
+        {
+            options->jobs = atoi(argv[i] + 7);
+            if (options->jobs < 1)
+                errorc("--jobs needs at least 1 thread");
+        }
+        else if (!strcmp(argv[i], "--stream"))
+            options->stream = true;
+        else if (!strcmp(argv[i], "--bounds-check"))
+            options->bounds_check = true;
+        else if (!strcmp(argv[i], "--avx2"))
+            options->avx2 = true;
+        else if (!strcmp(argv[i], "--fast-math"))
+            options->fast_math = true;
+        else if (!strncmp(argv[i], "--trace=", 8))
+            trace_setup(argv[i] + 8);
+        else if (!strncmp(argv[i], "--", 2))
+            errorc("unknown option '%s'", argv[i]);
+        else
+            paths[count++] = argv[i];
+    }
+    if (count < 1)
+        errorc("no input files");
+    report_start(options->time_report);
+    // every file goes through the same process so imports only get opened once
+    buffer_t* objects = buffer_init(256, 256);
+    for (int i = 0; i < count; i++)
+    {
+        char* path = paths[i];
+        int pathl = strlen(path);
+        char* assembly = calloc(pathl + 1, sizeof(char));
+        strcpy(assembly, path);
+        assembly[pathl - 4] = '\0';
+        char* object = calloc(pathl + 1, sizeof(char));
+        strcpy(object, assembly);
+        object[pathl - 5] = 'o';
+        build(path);
+        char assemble[1024];
+        sprintf(assemble, "as -o %s %s", object, assembly);
+        tracef(TRACE_DRIVER, TRACE_INFO, "assembler command: %s\n", assemble);
+        report_switch(PHASE_ASSEMBLE);
+        system(assemble);
+        report_switch(PHASE_OTHER);
+        buffer_string(objects, object);
+        buffer_append(objects, ' ');
+        free(assembly);
+        free(object);
+    }
+    buffer_append(objects, '\0');
+    char link[4096];
+    sprintf(link, "ld -o a.exe %slibsgcllc/libsgcllc.a libsgcll/libsgcll.a %s -lkernel32", objects->data, options->fdlibm_path);
+    tracef(TRACE_DRIVER, TRACE_INFO, "linker command: %s\n", link);
+    report_switch(PHASE_LINK);
     system(link);
-    free(assembly);
-    free(object);
+    report_switch(PHASE_OTHER);
+    buffer_delete(objects);
     options_file = fopen("options", "wb");
     write_options(options, options_file);
     fclose(options_file);
+    report_finish();
+    free(paths);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+    // sgcllc --server [socket] stays up and keeps everything below warm between compiles
+    if (argc >= 2 && !strcmp(argv[1], "--server"))
+        return server_run(argc >= 3 ? argv[2] : SERVER_SOCKET);
+    // sgcllc --client files... does the same thing as sgcllc files... but through a server when one is up
+    if (argc >= 2 && !strcmp(argv[1], "--client"))
+    {
+        char* socket_path = getenv("SGCLLC_SOCKET");
+        return client_run(socket_path ? socket_path : SERVER_SOCKET, argc - 2, argv + 2);
+    }
+    set_up_keywords();
+    set_up_builtins();
+    return compile(argc - 1, argv + 1);
 }
\ No newline at end of file
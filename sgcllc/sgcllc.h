@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <setjmp.h>
 
 /* Typedefs */
 
@@ -33,6 +34,8 @@ typedef int token_type, ast_node_type, datatype_type, visibility_type, register_
 #define DTT_STRING 9
 #define DTT_ARRAY 10
 #define DTT_OBJECT 11
+#define DTT_SLICE 12
+#define DTT_SIMD 13
 
 /* Visibility Type */
 
@@ -40,9 +43,34 @@ typedef int token_type, ast_node_type, datatype_type, visibility_type, register_
 #define VT_PUBLIC 1
 #define VT_PROTECTED 2
 
-/* Debug Flag */
+/* Constant Kind */
 
-#define SGCLLC_DEBUG
+#define CONSTANT_F32 0
+#define CONSTANT_F64 1
+#define CONSTANT_XMM 2
+#define CONSTANT_STRING 3
+
+/* Tracing */
+
+// categories, each one gets its own level so checking a trace site is one compare
+#define TRACE_LEXER 0
+#define TRACE_PARSER 1
+#define TRACE_OVERLOADS 2
+#define TRACE_EMITTER 3
+#define TRACE_DRIVER 4
+#define TRACE_COUNT 5
+
+#define TRACE_INFO 1
+#define TRACE_VERBOSE 2
+
+// release builds don't have any trace sites left in them
+#ifdef SGCLLC_RELEASE
+#define tracing(category, level) false
+#else
+#define tracing(category, level) __builtin_expect(trace_levels[category] >= (level), 0)
+#endif
+
+#define tracef(category, level, ...) do { if (tracing(category, level)) printf(__VA_ARGS__); } while (0)
 
 /* vector_t Helpful Macros */
 
@@ -162,6 +190,7 @@ typedef struct
     int offset;
     int peek;
     vector_t* output;
+    int released; // tokens dropped from the front of output, so indices keep counting from the start of the file
 } lexer_t;
 
 typedef struct
@@ -194,6 +223,8 @@ typedef struct
 } buffer_t;
 
 typedef struct ast_node_t ast_node_t;
+typedef struct vector_loop_t vector_loop_t;
+typedef struct parallel_loop_t parallel_loop_t;
 
 typedef struct datatype_t
 {
@@ -201,11 +232,13 @@ typedef struct datatype_t
     datatype_type type;
     int size;
     bool usign;
+    bool value; // DTT_OBJECT of a value blueprint, stored inline and copied instead of pointed to
+    bool soa; // DTT_ARRAY of blueprints stored as a column per instance variable
     union
     {
         // DTT_OBJECT
         char* name;
-        // DTT_ARRAY
+        // DTT_ARRAY/DTT_SLICE, and DTT_SIMD with its lane type in array_type
         struct
         {
             int depth;
@@ -252,9 +285,15 @@ typedef struct ast_node_t
         {
             struct ast_node_t* lhs;
             struct ast_node_t* rhs;
+            struct ast_node_t* subscript_guard; // OP_SUBSCRIPT, the for loop range.c proved it in bounds for
+            struct ast_node_t* simd_spill; // simd operators, the frame slot a called lhs waits in while the rhs is worked out
         };
         // AST_UNARY_OP
-        struct ast_node_t* operand;
+        struct
+        {
+            struct ast_node_t* operand;
+            struct ast_node_t* spawn_block; // OP_SPAWN, the frame slot the call's arguments are gathered in for the new thread
+        };
         // AST_FUNC_DEFINITION
         struct
         {
@@ -269,12 +308,15 @@ typedef struct ast_node_t
             int operator;
             char* end_label;
             int unsafe;
+            bool this_stays; // constructors, set once this is known not to get out of the body
         };
         // AST_FUNC_CALL
         struct
         {
             struct ast_node_t* func;
             vector_t* args;
+            struct ast_node_t* call_result; // frame slot a value blueprint gets returned into
+            struct ast_node_t* call_storage; // frame slot a constructor builds its object in when it doesn't escape
         };
         // AST_IF
         struct
@@ -302,6 +344,10 @@ typedef struct ast_node_t
             struct ast_node_t* for_cond;
             struct ast_node_t* for_post;
             struct ast_node_t* for_then;
+            vector_t* for_guards; // arrays the bound is checked against before the loop, null if it isn't checked
+            bool for_fast; // set while emitting the copy of the loop whose guarded subscripts skip their checks
+            vector_loop_t* for_vector; // null unless vectorize.c can run several iterations at once
+            parallel_loop_t* for_parallel; // null unless it's a parallel for
         };
         // AST_IMPORT
         char* path;
@@ -317,6 +363,12 @@ typedef struct ast_node_t
         vector_t* statements;
         // AST_CAST
         struct ast_node_t* castval;
+        // AST_MAKE
+        struct
+        {
+            struct ast_node_t* make_storage; // frame slot for the array when it doesn't escape
+            struct ast_node_t* make_soa_blueprint; // element blueprint of a soa array, its size is read when emitting
+        };
         // AST_BLUEPRINT
         struct
         {
@@ -325,6 +377,7 @@ typedef struct ast_node_t
             char* bp_name;
             datatype_t* bp_datatype;
             int bp_size;
+            vector_t* bp_sized; // value datatypes made before bp_size was known, they get it once the blueprint ends
         };
         // AST_NAMESPACE
         char* ns_name;
@@ -348,9 +401,43 @@ typedef struct ast_node_t
             struct ast_node_t* case_then;
             char* case_label;
         };
+        // OP_SLICE
+        struct
+        {
+            struct ast_node_t* slice_base;
+            struct ast_node_t* slice_lo;
+            struct ast_node_t* slice_hi; // null to go to the end
+        };
     };
 } ast_node_t;
 
+// one statement of a vectorized loop, either an element store or a reduction into a variable
+typedef struct vector_stmt_t
+{
+    int kind; // OP_ASSIGN stores into target[i], OP_ADD, OP_LESS and OP_GREATER fold into target as a sum, min or max
+    ast_node_t* target;
+    ast_node_t* value;
+} vector_stmt_t;
+
+typedef struct vector_loop_t
+{
+    datatype_t* element; // every element, variable and operation in the loop is of this type
+    vector_t* arrays; // the elements of the nth one are addressed off the nth of r8-r11
+    vector_t* invariants; // variables and literals spread across every lane, the first ones get a register for the loop
+    vector_t* stmts;
+    int depth; // registers the deepest value takes to work out
+} vector_loop_t;
+
+// what a parallel for keeps on top of its loop, the condition compares against bound instead of limit
+typedef struct parallel_loop_t
+{
+    ast_node_t* limit; // the end of the whole range, worked out once before the tasks start
+    bool inclusive; // limit was compared with <=
+    ast_node_t* bound; // frame slot a task gets the end of its chunk in
+    ast_node_t* row; // frame slot a task gets its worker's partials in
+    vector_t* reductions; // variables from outside the loop it only adds to
+} parallel_loop_t;
+
 typedef struct gc_node_t
 {
     ast_node_t* ast_equiv;
@@ -367,6 +454,23 @@ typedef struct map_t
     struct map_t* parent;
 } map_t;
 
+typedef struct header_t header_t;
+
+typedef struct constant_t
+{
+    int kind;
+    char* key;
+    char* label;
+    char* text; // the literal as it was written
+    unsigned long long bits[2]; // low quad first, only for the non-string kinds
+} constant_t;
+
+typedef struct pool_t
+{
+    map_t* index; // key -> constant_t
+    vector_t* constants; // in the order they were first added
+} pool_t;
+
 typedef struct parser_t
 {
     lexer_t* lex;
@@ -374,11 +478,16 @@ typedef struct parser_t
     map_t* genv;
     map_t* lenv;
     map_t* labels;
+    pool_t* constants;
     map_t* funcs;
     int oindex; // current index in the token stream
     vector_t* userexterns;
     vector_t* cexterns;
     vector_t* links;
+    vector_t* imports; // header_t's of every import
+    map_t* resolved; // names already looked up in the imports
+    vector_t* operators; // operator overloads in genv, in the order they were declared
+    vector_t* body_nodes; // nodes made inside function bodies since the last release, NULL unless streaming
     ast_node_t* current_func;
     ast_node_t* current_blueprint;
     ast_node_t* current_block;
@@ -395,13 +504,27 @@ typedef struct emitter_t
     int itmp;
     int ftmp;
     bool control;
-    char* fp_negate_label;
+    buffer_t* code; // functions are emitted into their own buffer instead of out
+    int func_index;
+    int labels;
+    pool_t* constants;
+    int functions; // handed out so far, the next one gets this as its func_index
+    bool checked; // --bounds-check, unless the function being emitted is unsafe
+    vector_t* bounds_fails; // label, index register and length operand of every failed check, written after ret
+    bool ymm; // a 32 byte simd value went through the ymm registers, their upper halves get cleared before returning
+    int frame_size; // what the function being emitted subtracts from rsp, a parallel for's tasks copy that much of it
 } emitter_t;
 
 typedef struct options_t
 {
     vector_t* import_search_paths;
     char* fdlibm_path;
+    int time_report; // from the command line, not saved
+    int jobs; // same
+    bool stream; // same
+    bool bounds_check; // same
+    bool avx2; // same, vectorized loops use ymm registers and the sse4.1 integer instructions, and the 32 byte simd types exist
+    bool fast_math; // same, lets float sums, mins and maxes be vectorized even though that reorders them
 } options_t;
 
 /* sgcllc.c */
@@ -410,7 +533,10 @@ extern map_t* keywords;
 extern map_t* builtins;
 extern options_t* options;
 
+void set_up_keywords(void);
+void build_abort(void);
 vector_t* build(char* path);
+int compile(int argc, char** argv);
 
 /* lex.c */
 
@@ -419,6 +545,7 @@ bool lex_eof(lexer_t* lex);
 void lex_read_token(lexer_t* lex);
 void lex_delete(lexer_t* lex);
 token_t* lex_get(lexer_t* lex, int index);
+void lex_release(lexer_t* lex, int index);
 
 /* buffer.c */
 
@@ -438,6 +565,8 @@ bool token_has_content(token_t* token);
 char* unwrap_string_literal(char* slit);
 void indprintf(int indent, const char* fmt, ...);
 bool isfloattype(datatype_type dtt);
+bool isintegraltype(datatype_type dtt);
+bool isvaluetype(datatype_t* dt);
 int itos(int n, char* buffer);
 void systemf(const char* fmt, ...);
 char* isolate_filename(char* path);
@@ -472,12 +601,16 @@ void vector_concat(vector_t* vec, vector_t* other);
 
 /* log.c */
 
+extern int trace_levels[TRACE_COUNT];
+
+void trace_setup(char* spec);
+jmp_buf* error_recover(jmp_buf* env);
+void error_exit(void);
 void errorl(lexer_t* lex, char* fmt, ...);
 void errorp(int row, int col, char* fmt, ...);
 void errore(int row, int col, char* fmt, ...);
 void errorc(char* fmt, ...);
 void warnf(int row, int col, char* fmt, ...);
-void debugf(char* fmt, ...);
 
 /* map.c */
 
@@ -491,6 +624,11 @@ void map_delete(map_t* map);
 
 /* ast.c */
 
+extern unsigned long long ast_node_count;
+
+
+vector_t* ast_track(vector_t* nodes);
+void ast_release(vector_t* nodes);
 ast_node_t* ast_file_init(location_t* loc);
 ast_node_t* ast_import_init(location_t* loc, char* path);
 ast_node_t* ast_func_definition_init(datatype_t* dt, location_t* loc, char func_type, char* func_name, char* residing);
@@ -513,6 +651,7 @@ ast_node_t* ast_unary_op_init(ast_node_type type, datatype_t* dt, location_t* lo
 ast_node_t* ast_blueprint_init(location_t* loc, char* bp_name, datatype_t* dt);
 ast_node_t* ast_namespace_init(location_t* loc, char* ns_name);
 ast_node_t* ast_ternary_init(datatype_t* dt, location_t* loc, ast_node_t* cond, ast_node_t* then, ast_node_t* els);
+ast_node_t* ast_slice_init(datatype_t* dt, location_t* loc, ast_node_t* base, ast_node_t* lo, ast_node_t* hi);
 ast_node_t* ast_switch_init(location_t* loc, ast_node_t* cmp);
 ast_node_t* ast_case_init(location_t* loc);
 void ast_print(ast_node_t* node);
@@ -527,23 +666,96 @@ parser_t* parser_init(lexer_t* lex);
 void parser_make_header(parser_t* p, FILE* out);
 bool parser_eof(parser_t* p);
 void parser_read(parser_t* p);
+void parser_release(parser_t* p);
 void parser_delete(parser_t* p);
 void set_up_builtins(void);
 void parser_ensure_cextern(parser_t* p, char* name, datatype_t* dt, vector_t* args);
 char* make_label(parser_t* p, void* content);
 char* make_func_label(char* filename, ast_node_t* func, ast_node_t* current_blueprint);
 datatype_t* arith_conv(datatype_t* t1, datatype_t* t2);
+datatype_t* simd_datatype(datatype_type lane, int size);
 
 /* emitter.c */
 
 emitter_t* emitter_init(parser_t* p, FILE* out, bool control);
 void emitter_emit(emitter_t* e);
+void emitter_stream(emitter_t* e);
+void emitter_stream_end(emitter_t* e);
 emitter_t* emitter_delete(emitter_t* e);
 
+/* escape.c */
+
+void escape_analyze(parser_t* p, ast_node_t* func);
+
+/* range.c */
+
+bool range_modifies(ast_node_t* node, ast_node_t* lvar, bool stmt);
+bool range_uses(ast_node_t* node, ast_node_t* lvar);
+ast_node_t* range_induction(ast_node_t* loop, ast_node_t** start);
+bool range_invariant(ast_node_t* bound, ast_node_t* body);
+bool range_needs_sign_guard(ast_node_t* loop);
+bool range_needs_width_guard(ast_node_t* loop);
+void range_analyze(parser_t* p, ast_node_t* func);
+
+/* vectorize.c */
+
+#define VECTOR_REGISTERS 6 // xmm0-xmm5, the rest belong to the caller
+int vector_lanes(datatype_t* element);
+char* vector_mnemonic(datatype_type type, int op);
+bool vector_same(ast_node_t* a, ast_node_t* b);
+void vectorize_analyze(parser_t* p, ast_node_t* func);
+
+/* pool.c */
+
+pool_t* pool_init(void);
+constant_t* constant_init(int kind, char* text, unsigned long long low, unsigned long long high);
+constant_t* constant_float_init(datatype_t* dt, char* text);
+constant_t* pool_put(pool_t* pool, constant_t* constant);
+void constant_delete(constant_t* constant);
+void pool_delete(pool_t* pool);
+
+/* cache.c */
+
+header_t* import_cache_get(char* name, char** object_path);
+void import_cache_invalidate(char* header_path);
+void import_cache_reset(void);
+
+/* server.c */
+
+#define SERVER_SOCKET "sgcllc.sock"
+
+int server_run(char* socket_path);
+int client_run(char* socket_path, int count, char** paths);
+
 /* header.c */
 
 void write_header(FILE* out, map_t* genv);
-vector_t* read_header(FILE* in, char* filename);
+header_t* open_header(char* path, char* filename);
+void close_header(header_t* h);
+bool header_has_lowlvl(header_t* h);
+void header_find(header_t* h, char* name, vector_t* found);
+void header_find_eager(header_t* h, vector_t* found);
+
+/* report.c */
+
+#define REPORT_NONE 0
+#define REPORT_TEXT 1
+#define REPORT_JSON 2
+
+#define PHASE_OTHER 0
+#define PHASE_LEX 1
+#define PHASE_PARSE 2
+#define PHASE_IMPORT 3
+#define PHASE_HEADER 4
+#define PHASE_EMIT 5
+#define PHASE_ASSEMBLE 6
+#define PHASE_LINK 7
+#define PHASE_COUNT 8
+
+void report_start(int report_mode);
+int report_switch(int phase);
+void report_count(int file_tokens, int file_labels);
+void report_finish(void);
 
 /* options.c */
 
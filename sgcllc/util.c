@@ -16,6 +16,16 @@ bool isfloattype(datatype_type dtt)
     return dtt == DTT_F32 || dtt == DTT_F64;
 }
 
+bool isintegraltype(datatype_type dtt)
+{
+    return dtt >= DTT_I8 && dtt <= DTT_I64;
+}
+
+bool isvaluetype(datatype_t* dt)
+{
+    return dt->type == DTT_OBJECT && dt->value;
+}
+
 bool token_has_content(token_t* token)
 {
     return token != NULL && (token->type == TT_IDENTIFIER || token->type == TT_STRING_LITERAL || token->type == TT_NUMBER_LITERAL);
@@ -164,7 +174,9 @@ char* impl_readstr(FILE* in)
 bool fexists(char* path)
 {
     FILE* exists = fopen(path, "rb");
-    if (!exists || feof(exists) || ferror(exists))
+    if (!exists)
+        return false;
+    if (feof(exists) || ferror(exists))
     {
         fclose(exists);
         return false;
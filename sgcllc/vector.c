@@ -38,6 +38,8 @@ void* vector_push(vector_t* vec, void* element)
 
 void* vector_pop(vector_t* vec)
 {
+    if (!vec->size)
+        return NULL;
     void* element = vec->data[--vec->size];
     if (vec->size < vec->capacity / 2)
         vec->data = realloc(vec->data, sizeof(void*) * (vec->capacity /= 2));
@@ -0,0 +1,345 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sgcllc.h"
+
+// a for loop counting i up by one to a bound that doesn't change, whose statements only store into a[i] or fold into a
+// variable, can do several iterations at once in sse registers (or avx ones with --avx2). every subscript has to be
+// [i] exactly, so an iteration only ever touches its own elements and arrays being the same one doesn't matter.
+// whatever iterations don't fill a register are left to the loop as it's normally emitted, which carries on from i
+
+typedef struct
+{
+    parser_t* p;
+    ast_node_t* func;
+    ast_node_t* loop;
+    ast_node_t* var;
+    vector_loop_t* vl;
+} vectorize_t;
+
+int vector_lanes(datatype_t* element)
+{
+    return (options->avx2 ? 32 : 16) / element->size;
+}
+
+// packed instructions for op on lanes of type, null if there isn't one. the avx versions put a v in front
+char* vector_mnemonic(datatype_type type, int op)
+{
+    bool f64 = type == DTT_F64, f32 = type == DTT_F32, i32 = type == DTT_I32;
+    switch (op)
+    {
+        case OP_ASSIGN:
+            return f64 ? "movupd" : f32 ? "movups" : "movdqu";
+        case OP_ADD:
+            return f64 ? "addpd" : f32 ? "addps" : i32 ? "paddd" : "paddq";
+        case OP_SUB:
+            return f64 ? "subpd" : f32 ? "subps" : i32 ? "psubd" : "psubq";
+        // sse2 has no 32-bit multiply, min or max, those came with sse4.1
+        case OP_MUL:
+            return f64 ? "mulpd" : f32 ? "mulps" : i32 && options->avx2 ? "pmulld" : NULL;
+        case OP_DIV:
+            return f64 ? "divpd" : f32 ? "divps" : NULL;
+        case OP_LESS:
+            return f64 ? "minpd" : f32 ? "minps" : i32 && options->avx2 ? "pminsd" : NULL;
+        case OP_GREATER:
+            return f64 ? "maxpd" : f32 ? "maxps" : i32 && options->avx2 ? "pmaxsd" : NULL;
+    }
+    return NULL;
+}
+
+// whether a and b are the same value, made out of the same leaves the same way
+bool vector_same(ast_node_t* a, ast_node_t* b)
+{
+    if (a == b)
+        return true;
+    if (a->type != b->type)
+        return false;
+    switch (a->type)
+    {
+        case AST_ILITERAL:
+            return a->ivalue == b->ivalue;
+        case AST_FLITERAL:
+            return a->fvalue == b->fvalue;
+        case OP_SUBSCRIPT:
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+            return vector_same(a->lhs, b->lhs) && vector_same(a->rhs, b->rhs);
+    }
+    return false;
+}
+
+static bool vectorize_reduced(vectorize_t* vs, ast_node_t* lvar)
+{
+    for (int i = 0; i < vs->vl->stmts->size; i++)
+    {
+        vector_stmt_t* stmt = vector_get(vs->vl->stmts, i);
+        if (stmt->kind != OP_ASSIGN && stmt->target == lvar)
+            return true;
+    }
+    return false;
+}
+
+static void vectorize_invariant(vectorize_t* vs, ast_node_t* leaf)
+{
+    for (int i = 0; i < vs->vl->invariants->size; i++)
+    {
+        if (vector_same(vector_get(vs->vl->invariants, i), leaf))
+            return;
+    }
+    vector_push(vs->vl->invariants, leaf);
+}
+
+// an element of an array indexed by the loop's own variable
+static bool vectorize_subscript(vectorize_t* vs, ast_node_t* node)
+{
+    if (node->type != OP_SUBSCRIPT || node->rhs != vs->var || node->lhs->type != AST_LVAR)
+        return false;
+    datatype_t* dt = node->lhs->datatype;
+    if (dt->type != DTT_ARRAY || dt->soa || dt->array_type->type != vs->vl->element->type)
+        return false;
+    // with --bounds-check, range.c has to have proven every subscript for the copy of the loop that skips the checks
+    if (options->bounds_check && vs->func->unsafe == -2 && node->subscript_guard != vs->loop)
+        return false;
+    bool listed = false;
+    for (int i = 0; i < vs->vl->arrays->size && !listed; i++)
+        listed = vector_get(vs->vl->arrays, i) == node->lhs;
+    if (!listed)
+        vector_push(vs->vl->arrays, node->lhs);
+    return vs->vl->arrays->size <= 4;
+}
+
+// registers value takes to work out, 0 if it can't be done lane by lane
+static int vectorize_value(vectorize_t* vs, ast_node_t* value)
+{
+    datatype_type element = vs->vl->element->type;
+    switch (value->type)
+    {
+        case OP_SUBSCRIPT:
+            return vectorize_subscript(vs, value);
+        case AST_LVAR:
+        {
+            if (value == vs->var || value->datatype->type != element || vectorize_reduced(vs, value))
+                return 0;
+            vectorize_invariant(vs, value);
+            return 1;
+        }
+        // turned into the element type when it's spread
+        case AST_ILITERAL:
+        {
+            vectorize_invariant(vs, value);
+            return 1;
+        }
+        case AST_FLITERAL:
+        {
+            if (value->datatype->type != element)
+                return 0;
+            vectorize_invariant(vs, value);
+            return 1;
+        }
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        {
+            if (value->datatype->type != element || !vector_mnemonic(element, value->type))
+                return 0;
+            int lhs = vectorize_value(vs, value->lhs), rhs = vectorize_value(vs, value->rhs);
+            if (!lhs || !rhs)
+                return 0;
+            return max(lhs, rhs + 1);
+        }
+    }
+    return 0;
+}
+
+static bool vectorize_push(vectorize_t* vs, int kind, ast_node_t* target, ast_node_t* value)
+{
+    vector_loop_t* vl = vs->vl;
+    if (!vl->element)
+        vl->element = target->datatype;
+    if (target->datatype->type != vl->element->type)
+        return false;
+    // lanes are only ever 32 or 64 bits, narrower ones would need their own adds and broadcasts
+    datatype_type element = vl->element->type;
+    if (element != DTT_I32 && element != DTT_I64 && element != DTT_F32 && element != DTT_F64)
+        return false;
+    // floats come out differently added up in another order, or with a nan somewhere
+    if (kind != OP_ASSIGN && isfloattype(vl->element->type) && !options->fast_math)
+        return false;
+    if (kind != OP_ASSIGN && !vector_mnemonic(vl->element->type, kind))
+        return false;
+    vector_stmt_t* stmt = calloc(1, sizeof(vector_stmt_t));
+    stmt->kind = kind;
+    stmt->target = target;
+    stmt->value = value;
+    vector_push(vl->stmts, stmt);
+    return true;
+}
+
+// s = x < s ? x : s and the like, OP_LESS for a min and OP_GREATER for a max
+static int vectorize_min_max(ast_node_t* cond, ast_node_t* lvar, ast_node_t** x)
+{
+    int op = cond->type == OP_LESS_EQUAL ? OP_LESS : cond->type == OP_GREATER_EQUAL ? OP_GREATER : cond->type;
+    if (op != OP_LESS && op != OP_GREATER)
+        return 0;
+    // x < s picks x for a min, s < x picks x for a max
+    if (cond->rhs == lvar)
+    {
+        *x = cond->lhs;
+        return op;
+    }
+    if (cond->lhs == lvar)
+    {
+        *x = cond->rhs;
+        return op == OP_LESS ? OP_GREATER : OP_LESS;
+    }
+    return 0;
+}
+
+static bool vectorize_stmt(vectorize_t* vs, ast_node_t* stmt)
+{
+    switch (stmt->type)
+    {
+        case OP_ASSIGN:
+        {
+            if (stmt->lhs->type == OP_SUBSCRIPT)
+                return vectorize_push(vs, OP_ASSIGN, stmt->lhs, stmt->rhs);
+            if (stmt->lhs->type != AST_LVAR)
+                return false;
+            ast_node_t* lvar = stmt->lhs, * rhs = stmt->rhs;
+            // s = s + x
+            if (rhs->type == OP_ADD && (rhs->lhs == lvar || rhs->rhs == lvar))
+                return vectorize_push(vs, OP_ADD, lvar, rhs->lhs == lvar ? rhs->rhs : rhs->lhs);
+            // s = x < s ? x : s
+            ast_node_t* x;
+            int op;
+            if (rhs->type != AST_TERNARY || !(op = vectorize_min_max(rhs->tern_cond, lvar, &x)))
+                return false;
+            if (vector_same(rhs->tern_then, x) && rhs->tern_els == lvar)
+                return vectorize_push(vs, op, lvar, x);
+            if (vector_same(rhs->tern_els, x) && rhs->tern_then == lvar)
+                return vectorize_push(vs, op == OP_LESS ? OP_GREATER : OP_LESS, lvar, x);
+            return false;
+        }
+        case OP_ASSIGN_ADD:
+        case OP_ASSIGN_SUB:
+        case OP_ASSIGN_MUL:
+        case OP_ASSIGN_DIV:
+        {
+            int op = stmt->type == OP_ASSIGN_ADD ? OP_ADD : stmt->type == OP_ASSIGN_SUB ? OP_SUB : stmt->type == OP_ASSIGN_MUL ? OP_MUL : OP_DIV;
+            if (stmt->lhs->type == OP_SUBSCRIPT)
+                return vectorize_push(vs, OP_ASSIGN, stmt->lhs, ast_binary_op_init(op, stmt->lhs->datatype, stmt->loc, stmt->lhs, stmt->rhs));
+            if (stmt->lhs->type == AST_LVAR && op == OP_ADD)
+                return vectorize_push(vs, OP_ADD, stmt->lhs, stmt->rhs);
+            return false;
+        }
+        // if (x < s) s = x;
+        case AST_IF:
+        {
+            if (stmt->if_els->statements->size || stmt->if_then->statements->size != 1)
+                return false;
+            ast_node_t* assign = vector_get(stmt->if_then->statements, 0);
+            if (assign->type != OP_ASSIGN || assign->lhs->type != AST_LVAR)
+                return false;
+            ast_node_t* x;
+            int op = vectorize_min_max(stmt->if_cond, assign->lhs, &x);
+            return op && vector_same(assign->rhs, x) && vectorize_push(vs, op, assign->lhs, x);
+        }
+    }
+    return false;
+}
+
+static void vectorize_loop(vectorize_t* vs, ast_node_t* loop)
+{
+    ast_node_t* start;
+    ast_node_t* var = range_induction(loop, &start);
+    if (!var || !range_invariant(loop->for_cond->rhs, loop->for_then))
+        return;
+    vector_loop_t* vl = calloc(1, sizeof(vector_loop_t));
+    vl->arrays = vector_init(4, 4);
+    vl->invariants = vector_init(4, 4);
+    vl->stmts = vector_init(4, 4);
+    vs->loop = loop;
+    vs->var = var;
+    vs->vl = vl;
+    vector_t* statements = loop->for_then->statements;
+    bool vectorizable = statements->size > 0;
+    for (int i = 0; i < statements->size && vectorizable; i++)
+        vectorizable = vectorize_stmt(vs, vector_get(statements, i));
+    // the statements are all in, so a variable read before it's folded into is caught too
+    int reductions = 0;
+    for (int i = 0; i < vl->stmts->size && vectorizable; i++)
+    {
+        vector_stmt_t* stmt = vector_get(vl->stmts, i);
+        reductions += stmt->kind != OP_ASSIGN;
+        int depth = vectorize_value(vs, stmt->value);
+        if (stmt->kind == OP_ASSIGN)
+            vectorizable = vectorize_subscript(vs, stmt->target);
+        // the variable is folded into by one statement only, the bound being invariant means it isn't that
+        else
+        {
+            for (int j = 0; j < vl->stmts->size && vectorizable; j++)
+                vectorizable = j == i || ((vector_stmt_t*) vector_get(vl->stmts, j))->target != stmt->target;
+            vectorizable = vectorizable && stmt->target != var;
+        }
+        vectorizable = vectorizable && depth;
+        vl->depth = max(vl->depth, depth);
+    }
+    if (!vectorizable || reductions + vl->depth > VECTOR_REGISTERS)
+    {
+        // a loop that can't be vectorized as a whole leaves every statement as it was
+        vector_delete(vl->arrays);
+        vector_delete(vl->invariants);
+        vector_delete(vl->stmts);
+        free(vl);
+        return;
+    }
+    loop->for_vector = vl;
+    tracef(TRACE_PARSER, TRACE_INFO, "%s: loop at %i:%i does %i iterations at once\n", vs->func->func_label, loop->loc->row, loop->loc->col, vector_lanes(vl->element));
+}
+
+static void vectorize_stmts(vectorize_t* vs, ast_node_t* stmt)
+{
+    if (!stmt)
+        return;
+    switch (stmt->type)
+    {
+        case AST_BLOCK:
+        {
+            for (int i = 0; i < stmt->statements->size; i++)
+                vectorize_stmts(vs, vector_get(stmt->statements, i));
+            break;
+        }
+        case AST_IF:
+        {
+            vectorize_stmts(vs, stmt->if_then);
+            vectorize_stmts(vs, stmt->if_els);
+            break;
+        }
+        case AST_WHILE:
+        {
+            vectorize_stmts(vs, stmt->while_then);
+            break;
+        }
+        case AST_FOR:
+        {
+            vectorize_loop(vs, stmt);
+            vectorize_stmts(vs, stmt->for_then);
+            break;
+        }
+        case AST_SWITCH:
+        {
+            for (int i = 0; i < stmt->cases->size; i++)
+                vectorize_stmts(vs, ((ast_node_t*) vector_get(stmt->cases, i))->case_then);
+            break;
+        }
+    }
+}
+
+void vectorize_analyze(parser_t* p, ast_node_t* func)
+{
+    vectorize_t vs = { p, func };
+    vectorize_stmts(&vs, func->body);
+}
\ No newline at end of file